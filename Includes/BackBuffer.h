@@ -4,7 +4,9 @@
 #ifndef BACKBUFFER_H
 #define BACKBUFFER_H
 #include <string>
+#include <vector>
 #include "main.h"
+#include "ResizeEngine.h"
 
 class BackBuffer
 {
@@ -15,12 +17,31 @@ public:
 	void present();
 	void reset();
 
+	// New window size; the render scale is kept.
+	void resize(int width, int height);
+
 	HDC getDC() const { return mhDC; }
 	HWND getHWND() const { return mhWnd; }
 
 	int width() const { return mWidth; }
 	int height() const { return mHeight; }
 
+	// The surface actually rendered into. It is smaller than width() x height()
+	// when the render scale is below 1, but drawing still uses window
+	// coordinates: the DC maps them onto the surface.
+	int surfaceWidth() const { return mSurfaceWidth; }
+	int surfaceHeight() const { return mSurfaceHeight; }
+	DWORD* getBits() const { return mpBits; }
+
+	void setRenderScale(float scale);
+	float getRenderScale() const { return mRenderScale; }
+
+	// Dynamic resolution lowers the render scale while the measured frame
+	// time is over budget, and raises it again once there is headroom.
+	void setDynamicResolution(bool enable, float frameBudget = 1.0f / 60.0f, float minScale = 0.5f);
+	bool isDynamicResolution() const { return mDynamicResolution; }
+	void adaptResolution(float frameTime);
+
 	bool WriteScore(int aScore);
 
 private:
@@ -34,12 +55,29 @@ private:
 	BackBuffer(const BackBuffer& rhs);
 	BackBuffer& operator=(const BackBuffer& rhs);
 
+	void createSurface(int width, int height);
+	void releaseSurface();
+
 private:
 	HWND mhWnd;
 	HDC mhDC;
 	HBITMAP mhSurface;
 	HBITMAP mhOldObject;
+	DWORD *mpBits;
 	int mWidth;
 	int mHeight;
+	int mSurfaceWidth;
+	int mSurfaceHeight;
+
+	float mRenderScale;
+	bool mDynamicResolution;
+	float mFrameBudget;
+	float mMinScale;
+	float mAvgFrameTime;
+	int mFramesSinceChange;
+
+	// Upscaled copy of a reduced surface, sent to the window in present()
+	std::vector<DWORD> mPresentBits;
+	CFastResampler mResampler;
 };
-#endif // BACKBUFFER_H
\ No newline at end of file
+#endif // BACKBUFFER_H
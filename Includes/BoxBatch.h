@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+// File: BoxBatch.h
+//
+// Desc: Batched box overlap tests. One box is tested against a whole array
+//	   of boxes stored as separate min/max arrays, 8 at a time with AVX2 or
+//	   4 at a time with SSE2, falling back to plain C++ elsewhere. The path
+//	   is picked once from what the CPU reports.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _BOXBATCH_H_
+#define _BOXBATCH_H_
+
+//-----------------------------------------------------------------------------
+// BoxBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Mask words needed for n boxes, one bit per box.
+#define BOXBATCH_MASK_WORDS(n)	(((n) + 31) / 32)
+
+enum BoxBatchPath
+{
+	BOXBATCH_SCALAR = 0,
+	BOXBATCH_SSE2	= 1,
+	BOXBATCH_AVX2	= 2
+};
+
+//-----------------------------------------------------------------------------
+// Name : BoxF (Struct)
+// Desc : Axis aligned box by its edges. Overlap is strict, boxes that only
+//		touch do not hit, the same as CSimWorld's centre and size test.
+//-----------------------------------------------------------------------------
+struct BoxF
+{
+	float	fMinX, fMinY;
+	float	fMaxX, fMaxY;
+};
+
+//-----------------------------------------------------------------------------
+// Global Functions
+//-----------------------------------------------------------------------------
+// Sets bit i of pMask for every box i overlapping box. pMask needs
+// BOXBATCH_MASK_WORDS(n) words; unused bits of the last word are cleared.
+// Returns the number of hits.
+size_t			BoxBatchOverlap		( const BoxF& box, const float *pMinX, const float *pMinY,
+									  const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask );
+
+// The same for boxes of one size given by their centres, like bullets.
+size_t			BoxBatchOverlapCentred( const BoxF& box, const float *pX, const float *pY,
+									  float fWidth, float fHeight, size_t n, uint32_t *pMask );
+
+// Turns a mask into the indices of its set bits, in ascending order.
+// Returns how many were written.
+size_t			BoxBatchCompact		( const uint32_t *pMask, size_t n, unsigned int *pIndices );
+
+// The path in use. Setting asks for one; it falls back to the best one the
+// CPU supports, which is what gets returned.
+BoxBatchPath	BoxBatchGetPath		( );
+BoxBatchPath	BoxBatchSetPath		( BoxBatchPath path );
+const char*		BoxBatchPathName	( BoxBatchPath path );
+
+#endif // _BOXBATCH_H_
@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// File: BulletEmitter.h
+//
+// Desc: Bullet patterns from small descriptors. A pattern is one or more
+//	   bursts; each burst is a fan, a ring or an aimed volley of bullets,
+//	   and the whole pattern may turn from one burst to the next, which
+//	   makes spirals. Running patterns are stepped by CBulletEmitter.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _BULLETEMITTER_H_
+#define _BULLETEMITTER_H_
+
+//-----------------------------------------------------------------------------
+// CBulletEmitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "BulletPool.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+enum BULLET_PATTERN_TYPE
+{
+	PATTERN_SPREAD,						// Fan over fArc around fDirection
+	PATTERN_RING,						// Evenly round the full circle
+	PATTERN_SPIRAL,						// A ring that turns fTurn per burst
+	PATTERN_AIMED,						// Fan around the target's direction
+};
+
+//-----------------------------------------------------------------------------
+// Name : BulletPattern (Struct)
+// Desc : Angles are degrees, 0 straight down and 90 to the right. Speeds
+//		are pixels per second, acceleration pixels per second squared
+//		along each bullet's own direction.
+//-----------------------------------------------------------------------------
+struct BulletPattern
+{
+	BULLET_PATTERN_TYPE	Type;
+	int					nBullets;		// Per burst
+	int					nBursts;
+	float				fInterval;		// Seconds between bursts
+	float				fSpeed;
+	float				fAccel;
+	float				fDirection;		// Offset from the target's direction when aimed
+	float				fArc;			// Spreads and aimed fans
+	float				fTurn;			// Added to the direction every burst
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBulletEmitter (Class)
+// Desc : Start() fires a pattern's first burst at once and keeps the rest
+//		for Update(). Patterns stay where they were started, and aimed ones
+//		keep the aim they started with.
+//-----------------------------------------------------------------------------
+class CBulletEmitter
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CBulletEmitter();
+	virtual ~CBulletEmitter();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// pPattern must outlive the emitter. fAim is the target's direction.
+	// Returns the bullets spawned by the first burst.
+	size_t				Start		( const BulletPattern *pPattern, float x, float y, float fAim, int iOwner,
+									  double dTime, CBulletPool& bullets );
+
+	// Fires every burst due by dTime. Returns the bullets spawned.
+	size_t				Update		( double dTime, CBulletPool& bullets );
+
+	void				Clear		( ) { m_Emitters.clear(); }
+	size_t				GetActiveCount( ) const { return m_Emitters.size(); }
+
+	// One burst of a pattern, as Start() and Update() fire them. Bullets
+	// that do not fit in the pool are dropped.
+	static size_t		Burst		( const BulletPattern& pattern, int iBurst, float x, float y, float fAim,
+									  int iOwner, CBulletPool& bullets );
+
+	// Direction from one point to another, in pattern degrees.
+	static float		AimAt		( float fromX, float fromY, float toX, float toY );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Emitter
+	{
+		const BulletPattern*	pPattern;
+		float					x, y;
+		float					fAim;
+		int						iOwner;
+		int						iBurst;		// Next burst to fire
+		double					dNext;		// When it is due
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<Emitter>		m_Emitters;
+};
+
+#endif // _BULLETEMITTER_H_
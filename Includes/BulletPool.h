@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// File: BulletPool.h
+//
+// Desc: Fixed capacity bullet storage. All memory is allocated up front,
+//	   live bullets are packed at the front of each component array, and
+//	   spawning or despawning is O(1) without touching the heap. Moving
+//	   and culling run over the arrays with the SIMD path BoxBatch picked.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _BULLETPOOL_H_
+#define _BULLETPOOL_H_
+
+//-----------------------------------------------------------------------------
+// CBulletPool Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int BULLET_OWNER_ENEMY = -1;			// Otherwise the owner is a player index
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBulletPool (Class)
+// Desc : Bullets 0..Count()-1 are live. Handles go through a slot table with
+//		generations, slots are recycled through a free list.
+//-----------------------------------------------------------------------------
+class CBulletPool
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CBulletPool();
+	virtual ~CBulletPool();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Create		( size_t nCapacity );
+	void			Clear		( );
+
+	// INVALID_ENTITY when the pool is full.
+	EntityHandle	Spawn		( float x, float y, float vx, float vy, int iOwner, float ax = 0, float ay = 0 );
+	bool			Despawn		( EntityHandle handle );
+	void			DespawnAt	( size_t iIndex );
+
+	bool			IsAlive		( EntityHandle handle ) const;
+	int				IndexOf		( EntityHandle handle ) const;	// -1 if stale
+
+	// Bullets whose box of the given size is fully outside are recycled.
+	void			SetBounds	( float fLeft, float fTop, float fRight, float fBottom );
+
+	// Speeds every bullet up by its acceleration, then moves it by its
+	// velocity, keeping the old position. All SIMD paths give the same
+	// result to the bit.
+	void			Integrate	( float dt );
+
+	// Recycles bullets that left the bounds. Returns how many went.
+	size_t			Cull		( float fWidth, float fHeight );
+
+	size_t			Count		( ) const { return m_nCount; }
+	size_t			Capacity	( ) const { return m_X.size(); }
+
+	//-------------------------------------------------------------------------
+	// Component access, Count() live entries each
+	//-------------------------------------------------------------------------
+	const float*	X			( ) const { return m_X.data(); }
+	const float*	Y			( ) const { return m_Y.data(); }
+	const float*	PrevX		( ) const { return m_PrevX.data(); }
+	const float*	PrevY		( ) const { return m_PrevY.data(); }
+	const float*	VelX		( ) const { return m_VelX.data(); }
+	const float*	VelY		( ) const { return m_VelY.data(); }
+	const float*	AccX		( ) const { return m_AccX.data(); }
+	const float*	AccY		( ) const { return m_AccY.data(); }
+	const int*		Owner		( ) const { return m_Owner.data(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<float>			m_X, m_Y;
+	std::vector<float>			m_PrevX, m_PrevY;
+	std::vector<float>			m_VelX, m_VelY;
+	std::vector<float>			m_AccX, m_AccY;
+	std::vector<int>			m_Owner;
+	size_t						m_nCount;
+
+	std::vector<unsigned int>	m_SlotToDense;
+	std::vector<unsigned int>	m_SlotGeneration;
+	std::vector<unsigned int>	m_DenseToSlot;
+	std::vector<unsigned int>	m_FreeSlots;		// Stack, capacity reserved
+	std::vector<uint32_t>		m_InsideMask;		// Cull() scratch, one bit per bullet
+
+	float						m_fLeft, m_fTop, m_fRight, m_fBottom;
+};
+
+#endif // _BULLETPOOL_H_
@@ -13,12 +13,18 @@
 //-----------------------------------------------------------------------------
 #include "Main.h"
 #include "CTimer.h"
-#include "CPlayer.h"
 #include "BackBuffer.h"
 #include "ImageFile.h"
-#include "Bullet.h"
-#include "Enemy.h"
-#include <list>
+#include "ParallaxBackground.h"
+#include "Sprite.h"
+#include "SpriteSheet.h"
+#include "RotationCache.h"
+#include "SimWorld.h"
+#include "InputRecording.h"
+#include "FixedStepLoop.h"
+#include "JobSystem.h"
+#include "ParticleSystem.h"
+#include "Camera.h"
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -44,35 +50,18 @@ public:
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class
 	//-------------------------------------------------------------------------
-	enum DIRECTION
-	{
-		DIR_FORWARD = 1,
-		DIR_BACKWARD = 2,
-		DIR_LEFT = 4,
-		DIR_RIGHT = 8,
-	};
-
 	LRESULT	 DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam );
 	bool		InitInstance( LPCTSTR lpCmdLine, int iCmdShow );
 	int		 BeginGame( );
 	bool		ShutDown( );
-	int noEnemies;
-	DIRECTION direction;
 	USHORT					Width;
 	USHORT					Height;
 	BackBuffer*				m_pBBuffer;
-	std::list<Bullet>	   bulletsOnScreen;
-	std::list<Bullet>	   bulletsOnScreen1;
-	std::list<Enemy>	   enemyOnScreen;
 	HWND					m_hWnd;			 // Main window HWND
 private:
 	//-------------------------------------------------------------------------
 	// Private Functions for This Class
 	//-------------------------------------------------------------------------
-
-	std::list<CPlayer*>		m_enemies;
-	void		addEnemies(int noEnemies);
-	void		removeDead();
 	bool		BuildObjects	  ( );
 	void		ReleaseObjects	( );
 	void		FrameAdvance	  ( );
@@ -81,10 +70,14 @@ private:
 	void		AnimateObjects	( );
 	void		DrawObjects	   ( );
 	void		ProcessInput	  ( );
+	void		ProcessEvents	 ( );
 	void		DrawBackground();
+	void		DrawView		  ( const CCamera& camera, double dAlpha );
+	void		DrawSprite		  ( Sprite *pSprite, const CCamera& camera, const Vec2& position );
+	void		DrawParticles	 ( const CCamera& camera );
+	void		LayoutViews		  ( );
 	void		saveGame();
 	void		loadGame();
-	short int Sprite_Collide(Sprite * object1, Sprite * object2);
 
 	
 	//-------------------------------------------------------------------------
@@ -113,11 +106,26 @@ private:
 	POINT				   m_OldCursorPos;	 // Old cursor position for tracking
 	HINSTANCE				m_hInstance;
 
-	CImageFile				m_imgBackground;
+	CParallaxBackground		m_Background;
+	CJobSystem				m_Jobs;				// Worker threads for resampling and large updates
 
-	
-	CPlayer*				m_pPlayer;
-	CPlayer*				m_pPlayer1;
+	CSimWorld				m_World;			// Game state and rules
+	SimInput				m_Input;			// Commands for the next step
+	CFixedStepLoop			m_StepLoop;			// Steps due per frame, render blend factor
+	CInputRecording			m_Recording;		// Every step's input, saved on exit for replays
+	CParticleSystem			m_Particles;		// Explosion effects, started by the world's events
+
+	// One view of the whole play area, or one per player following them
+	CCamera					m_Cameras[SIM_PLAYER_COUNT];
+	bool					m_bSplitView;
+
+	// One sprite per kind, positioned from the world before each draw
+	Sprite*					m_pPlayerSprite;
+	Sprite*					m_pEnemySprite;
+	Sprite*					m_pBulletSprite;
+	CRotationCache*			m_pPlayerRotations;
+
+	float					m_fExplosionTime;	// Seconds, from the explosion sheet
 };
 
 #endif // _CGAMEAPP_H_
\ No newline at end of file
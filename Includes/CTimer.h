@@ -45,6 +45,7 @@ public:
 	void			Tick( float fLockFPS = 0.0f );
 	unsigned long	GetFrameRate( LPTSTR lpszString = NULL, size_t size = 0 ) const;
 	float			GetTimeElapsed() const;
+	float			GetRawTimeElapsed() const;	// Unsmoothed, for accumulating real time
 
 private:
 	//------------------------------------------------------------
@@ -53,6 +54,7 @@ private:
 	bool			m_PerfHardware;			 // Has Performance Counter
 	float			m_TimeScale;				// Amount to scale counter
 	float			m_TimeElapsed;			  // Time elapsed since previous frame
+	float			m_RawTimeElapsed;		  // Same, before averaging
 	__int64			m_CurrentTime;			  // Current Performance Counter
 	__int64			m_LastTime;				 // Performance Counter last frame
 	__int64			m_PerfFreq;				 // Performance Frequency
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// File: Camera.h
+//
+// Desc: 2D camera onto the play area. Maps world positions into a viewport
+//	   rectangle of the window at a zoom, and keeps the part of the world
+//	   it shows so drawing can skip whatever is out of view before doing
+//	   any work on it.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _CAMERA_H_
+#define _CAMERA_H_
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCamera (Class)
+// Desc : Screen = (world - view corner) * zoom + viewport corner. Everything
+//		the transform and the visibility test need is worked out when the
+//		camera changes, not per call.
+//-----------------------------------------------------------------------------
+class CCamera
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCamera();
+	virtual ~CCamera();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Window rectangle drawn into, in window pixels.
+	void			SetViewport		( int x, int y, int iWidth, int iHeight );
+
+	// The play area, [0, fWidth] x [0, fHeight]. LookAt() keeps the view
+	// inside it, or centred on it when the view is the bigger.
+	void			SetWorldBounds	( float fWidth, float fHeight );
+
+	void			SetZoom			( float fZoom );
+	void			LookAt			( float x, float y );
+
+	// Zooms to show the whole play area, centred in the viewport.
+	void			Fit				( );
+
+	void			WorldToScreen	( float x, float y, float& fScreenX, float& fScreenY ) const
+	{
+		fScreenX = x * m_fZoom + m_fOffsetX;
+		fScreenY = y * m_fZoom + m_fOffsetY;
+	}
+
+	void			ScreenToWorld	( float x, float y, float& fWorldX, float& fWorldY ) const
+	{
+		fWorldX = (x - m_fOffsetX) / m_fZoom;
+		fWorldY = (y - m_fOffsetY) / m_fZoom;
+	}
+
+	// Whether a box of the given half size centred on (x, y) shows at all.
+	bool			IsVisible		( float x, float y, float fHalfWidth, float fHalfHeight ) const
+	{
+		return x + fHalfWidth > m_fViewLeft && x - fHalfWidth < m_fViewRight
+			&& y + fHalfHeight > m_fViewTop && y - fHalfHeight < m_fViewBottom;
+	}
+
+	int				GetViewportX		( ) const { return m_iViewportX; }
+	int				GetViewportY		( ) const { return m_iViewportY; }
+	int				GetViewportWidth	( ) const { return m_iViewportWidth; }
+	int				GetViewportHeight	( ) const { return m_iViewportHeight; }
+	float			GetZoom				( ) const { return m_fZoom; }
+	float			GetCentreX			( ) const { return m_fCentreX; }
+	float			GetCentreY			( ) const { return m_fCentreY; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Update			( );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	int				m_iViewportX, m_iViewportY;
+	int				m_iViewportWidth, m_iViewportHeight;
+	float			m_fWorldWidth, m_fWorldHeight;
+	float			m_fZoom;
+	float			m_fCentreX, m_fCentreY;		// World point asked for with LookAt()
+
+	// Worked out by Update()
+	float			m_fOffsetX, m_fOffsetY;		// Screen position of the world origin
+	float			m_fViewLeft, m_fViewTop;	// Part of the world in the viewport
+	float			m_fViewRight, m_fViewBottom;
+};
+
+#endif // _CAMERA_H_
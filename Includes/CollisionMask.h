@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.h
+//
+// Desc: One bit per pixel opacity masks for pixel accurate collisions. Rows
+//	   are packed into 64 bit words, so two masks are compared a word of
+//	   pixels at a time over the rows where their boxes overlap.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _COLLISIONMASK_H_
+#define _COLLISIONMASK_H_
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask (Class)
+// Desc : Bit x of a row is pixel x, least significant bit first. An empty
+//		mask (never created) stands for "no mask", callers fall back to the
+//		bounding box.
+//-----------------------------------------------------------------------------
+class CCollisionMask
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCollisionMask();
+	virtual ~CCollisionMask();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// pPixels are top-down rows; a pixel is solid if any bit of uSolidMask
+	// is set in it.
+	bool			Create		( const uint32_t *pPixels, int iWidth, int iHeight, uint32_t uSolidMask );
+	void			Release		( );
+
+	bool			IsEmpty		( ) const { return m_Bits.empty(); }
+	int				Width		( ) const { return m_iWidth; }
+	int				Height		( ) const { return m_iHeight; }
+	bool			IsSolid		( int x, int y ) const;
+	size_t			GetSolidCount( ) const;
+
+	// True if any solid pixels coincide with the masks' top-left corners
+	// at (ax, ay) and (bx, by).
+	static bool		Overlap		( const CCollisionMask& a, int ax, int ay, const CCollisionMask& b, int bx, int by );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	uint64_t		GetBits		( int y, int x ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	int						m_iWidth;
+	int						m_iHeight;
+	int						m_iRowWords;		// 64 bit words per row
+	std::vector<uint64_t>	m_Bits;
+};
+
+#endif // _COLLISIONMASK_H_
@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// File: CollisionSystem.h
+//
+// Desc: Layered collision detection. Everything that can collide is added
+//	   each step as a proxy on a layer; a rule table says which layers meet.
+//	   One Detect() runs the broadphase and the swept narrowphase for every
+//	   rule and leaves a single list of hits, earliest first, for the owner
+//	   to hand to its response code. Layer pairs without a rule are never
+//	   looked at.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _COLLISIONSYSTEM_H_
+#define _COLLISIONSYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// CCollisionSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "Vec2.h"
+#include "CollisionMask.h"
+#include "SpatialGrid.h"
+#include "BoxBatch.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int COLLISION_MAX_LAYERS		= 16;
+const int COLLISION_BATCH_LIMIT		= 16;	// A rule with a layer this small skips the grid
+
+//-----------------------------------------------------------------------------
+// Name : CollisionProxy (Struct)
+// Desc : One collidable for one step: a box of the given size whose centre
+//		moves from From to To, with an optional pixel mask drawn around the
+//		centre. uId is the owner's own index for the object.
+//-----------------------------------------------------------------------------
+struct CollisionProxy
+{
+	unsigned int			uId;
+	Vec2					From;
+	Vec2					To;
+	double					dWidth;
+	double					dHeight;
+	const CCollisionMask*	pMask;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CollisionHit (Struct)
+// Desc : Proxy uA on the rule's first layer met proxy uB on its second, at
+//		dTime through the step (0 start, 1 end). Indices are into the
+//		layers' proxy lists.
+//-----------------------------------------------------------------------------
+struct CollisionHit
+{
+	double			dTime;
+	int				iRule;
+	unsigned int	uA;
+	unsigned int	uB;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCollisionSystem (Class)
+// Desc : Rules are added once; then each step Clear(), Add() the proxies,
+//		Detect() and walk GetHits(). Claim() lets the owner resolve every
+//		object at most once per step.
+//-----------------------------------------------------------------------------
+class CCollisionSystem
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCollisionSystem();
+	virtual ~CCollisionSystem();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Layer iLayerA is tested against iLayerB, which may be the same layer.
+	// Returns the rule's index, which hits report.
+	int						AddRule		( int iLayerA, int iLayerB );
+	bool					IsLayerUsed	( int iLayer ) const { return m_bLayerUsed[iLayer]; }
+
+	// Cell size for layers that go through the grid, about the common size.
+	void					SetCellSize	( float fCellSize ) { m_Grid.Reset(fCellSize); m_iGridLayer = -1; }
+
+	void					Clear		( );
+	void					Add			( int iLayer, const CollisionProxy& proxy );
+	void					Detect		( );
+
+	// Sorted by time, then rule, then proxy.
+	const std::vector<CollisionHit>& GetHits( ) const { return m_Hits; }
+	const CollisionProxy&	GetProxy	( int iLayer, unsigned int uIndex ) const { return m_Layers[iLayer].Proxies[uIndex]; }
+	size_t					GetCount	( int iLayer ) const { return m_Layers[iLayer].Proxies.size(); }
+
+	// Marks both proxies of a hit as used. False, and nothing marked, if
+	// either already was.
+	bool					Claim		( const CollisionHit& hit );
+	bool					IsClaimed	( int iLayer, unsigned int uIndex ) const { return m_Layers[iLayer].Claimed[uIndex] != 0; }
+
+	// Box of size a moving a0 to a1 against box b moving b0 to b1. dEnter
+	// and dExit are the fractions of the step the boxes overlap for.
+	static bool				Sweep		( const Vec2& a0, const Vec2& a1, double aw, double ah,
+										  const Vec2& b0, const Vec2& b1, double bw, double bh, double& dEnter, double& dExit );
+
+	// Masks centred on a and b, snapped to whole pixels. A missing mask
+	// leaves the decision to the boxes.
+	static bool				PixelsOverlap( const CCollisionMask *pA, const Vec2& a, const CCollisionMask *pB, const Vec2& b );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Rule
+	{
+		int		iLayerA;
+		int		iLayerB;
+	};
+
+	struct Layer
+	{
+		std::vector<CollisionProxy>	Proxies;
+		std::vector<float>			MinX, MinY, MaxX, MaxY;		// Swept bounds
+		std::vector<unsigned char>	Claimed;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void		DetectBatched	( int iRule );
+	void		DetectGrid		( int iRule );
+	void		TestPair		( int iRule, unsigned int uA, unsigned int uB );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<Rule>			m_Rules;
+	bool						m_bLayerUsed[COLLISION_MAX_LAYERS];	// In at least one rule
+	Layer						m_Layers[COLLISION_MAX_LAYERS];
+
+	CSpatialGrid				m_Grid;
+	int							m_iGridLayer;		// Layer in the grid, -1 if stale
+	std::vector<unsigned int>	m_Candidates;
+	std::vector<uint32_t>		m_HitMask;
+
+	std::vector<CollisionHit>	m_Hits;
+};
+
+#endif // _COLLISIONSYSTEM_H_
@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.h
+//
+// Desc: Struct-of-arrays entity storage. Live entities are packed at the
+//	   front of one array per component, so a system that only needs
+//	   positions streams through positions and nothing else. Handles stay
+//	   valid while other entities come and go, and go stale (rather than
+//	   pointing at someone else) once their entity is destroyed.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _ENTITYSTORE_H_
+#define _ENTITYSTORE_H_
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int ENTITY_TIMER_COUNT = 3;			// General purpose timers per entity
+
+//-----------------------------------------------------------------------------
+// Name : EntityHandle (Struct)
+// Desc : Slot plus the generation the slot had when the entity was made.
+//-----------------------------------------------------------------------------
+struct EntityHandle
+{
+	unsigned int	uSlot;
+	unsigned int	uGeneration;
+
+	bool operator==( const EntityHandle& h ) const { return uSlot == h.uSlot && uGeneration == h.uGeneration; }
+	bool operator!=( const EntityHandle& h ) const { return !(*this == h); }
+};
+
+const EntityHandle INVALID_ENTITY = { 0xFFFFFFFF, 0 };
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CEntityStore (Class)
+// Desc : Dense component arrays indexed 0..Size()-1, with handles mapped to
+//		the dense index through a slot table. Removing swaps the last
+//		entity into the hole, so dense indices are not stable; handles are.
+//		RemoveFlagged() removes many at once and keeps the rest in order.
+//-----------------------------------------------------------------------------
+class CEntityStore
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CEntityStore();
+	virtual ~CEntityStore();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	EntityHandle	Create		( );
+	bool			Destroy		( EntityHandle handle );
+	void			RemoveAt	( size_t iIndex );
+	size_t			RemoveFlagged( unsigned int uFlags );		// Returns the number removed
+	void			Clear		( );
+	void			Reserve		( size_t nCount );
+
+	bool			IsAlive		( EntityHandle handle ) const;
+	int				IndexOf		( EntityHandle handle ) const;	// -1 if stale
+	EntityHandle	HandleAt	( size_t iIndex ) const;
+	size_t			Size		( ) const { return m_DenseToSlot.size(); }
+
+	//-------------------------------------------------------------------------
+	// Public Variables for This Class (components, Size() entries each)
+	//-------------------------------------------------------------------------
+	std::vector<float>			X, Y;			// Position
+	std::vector<float>			PrevX, PrevY;	// Position at the start of the last step
+	std::vector<float>			VelX, VelY;		// Pixels per second
+	std::vector<float>			Speed;			// Pixels per second, for steering
+	std::vector<unsigned short>	SpriteId;
+	std::vector<unsigned int>	Flags;
+	std::vector<float>			Timer[ENTITY_TIMER_COUNT];
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void			ResizeComponents( size_t nCount );
+	void			MoveComponents	( size_t iFrom, size_t iTo );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<unsigned int>	m_SlotToDense;		// Dense index of each slot
+	std::vector<unsigned int>	m_SlotGeneration;	// Bumped whenever a slot is freed
+	std::vector<unsigned int>	m_FreeSlots;
+	std::vector<unsigned int>	m_DenseToSlot;
+};
+
+#endif // _ENTITYSTORE_H_
@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// File: FixedStepLoop.h
+//
+// Desc: Fixed timestep accumulator. Real frame time goes in, a whole number
+//	   of simulation steps comes out, plus how far the next step has got so
+//	   rendering can blend between the last two simulation states.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FIXEDSTEPLOOP_H_
+#define _FIXEDSTEPLOOP_H_
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFixedStepLoop (Class)
+// Desc : Decides how many fixed steps each rendered frame has to run.
+//-----------------------------------------------------------------------------
+class CFixedStepLoop
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFixedStepLoop( double dStepRate = 120.0, int iMaxSteps = 8 );
+	virtual ~CFixedStepLoop();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			SetStepRate		( double dStepsPerSecond );
+	void			SetMaxSteps		( int iMaxSteps );
+	void			Reset			( );
+
+	// Adds a frame's worth of real time and returns the steps now due. More
+	// than the maximum is never returned; the time behind that is dropped so
+	// a slow frame cannot snowball into ever longer ones.
+	int				Advance			( double dFrameTime );
+
+	double			GetStepTime		( ) const { return m_dStepTime; }
+	double			GetStepRate		( ) const { return 1.0 / m_dStepTime; }
+
+	// Fraction of a step left over, 0..1, for blending previous and current state.
+	double			GetAlpha		( ) const { return m_dAccumulator / m_dStepTime; }
+
+	// Steps thrown away by the catch-up clamp since Reset().
+	unsigned long	GetDroppedSteps	( ) const { return m_ulDropped; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	double			m_dStepTime;		// Seconds per step
+	double			m_dAccumulator;		// Real time not yet simulated
+	int				m_iMaxSteps;		// Catch-up limit per frame
+	unsigned long	m_ulDropped;
+};
+
+#endif // _FIXEDSTEPLOOP_H_
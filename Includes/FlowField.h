@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// File: FlowField.h
+//
+// Desc: Grid flow field for steering crowds. One Build() works out, for
+//	   every cell of the play area, which way leads to the nearest goal;
+//	   after that any number of movers find their heading with one table
+//	   lookup each, instead of each working out its own pursuit.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FLOWFIELD_H_
+#define _FLOWFIELD_H_
+
+//-----------------------------------------------------------------------------
+// CFlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFlowField (Class)
+// Desc : Distances are 3-4 chamfer distances in cells, good to a few per
+//		cent of the true ones; directions are down their slope. Positions
+//		outside the area use the nearest edge cell.
+//-----------------------------------------------------------------------------
+class CFlowField
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFlowField();
+	virtual ~CFlowField();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Covers [0, fWidth] x [0, fHeight]. Only allocates when the grid size
+	// changes; the field is empty, every direction zero, until Build().
+	void			Create		( float fWidth, float fHeight, float fCellSize );
+	void			Clear		( );
+
+	// Points every cell at the nearest of nGoals positions.
+	void			Build		( const float *pX, const float *pY, int nGoals );
+
+	// Unit direction of the cell at (x, y); zero in a goal's own cell.
+	void			Sample		( float x, float y, float& fDirX, float& fDirY ) const
+	{
+		int iCell = CellOf(x, y);
+		fDirX = m_DirX[iCell];
+		fDirY = m_DirY[iCell];
+	}
+
+	int				GetColumns	( ) const { return m_iColumns; }
+	int				GetRows		( ) const { return m_iRows; }
+	float			GetCellSize	( ) const { return m_fCellSize; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	int				CellOf		( float x, float y ) const
+	{
+		float fX = x * m_fInvCellSize, fY = y * m_fInvCellSize;
+		fX = fX < 0 ? 0 : (fX > m_fMaxColumn ? m_fMaxColumn : fX);
+		fY = fY < 0 ? 0 : (fY > m_fMaxRow ? m_fMaxRow : fY);
+		return (int)fY * m_iColumns + (int)fX;
+	}
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	int						m_iColumns, m_iRows;
+	float					m_fCellSize, m_fInvCellSize;
+	float					m_fMaxColumn, m_fMaxRow;	// Last cell, as floats for clamping
+	std::vector<uint16_t>	m_Distance;
+	std::vector<float>		m_DirX, m_DirY;
+};
+
+#endif // _FLOWFIELD_H_
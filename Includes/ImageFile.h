@@ -37,14 +37,21 @@ public:
 	virtual ~CImageFile(void);
 
 	bool LoadBitmapFromFile(const char* szFileName, HDC hdc);
+	void CreateFromPixels(const RGBQUAD *pPixels, LONG lWidth, LONG lHeight);
 	virtual void Paint(HDC hdc, int x, int y);
 
 	LONG Height() const { return height; }
 	LONG Width() const { return width; }
 
+	// Raw 32 bit pixels, bottom-up rows as returned by GetDIBits
+	const RGBQUAD* Pixels() const { return m_pRGB; }
+
 	void Clear() { ZeroMemory(m_pRGB, sizeof(RGBQUAD) * width * height); }
 	void Reload(HDC hdc);
 
 	BYTE* CopyMonoImage(EColorChannel chn, const RECT* rc = NULL);
 	void PasteMonoImage(const BYTE *img, EColorChannel chn, const RECT* rc = NULL);
-};
\ No newline at end of file
+};
+
+// Creates a 32 bit top-down DIB section and returns a pointer to its bits.
+HBITMAP CreateTopDownDIB(HDC hdc, int iWidth, int iHeight, void **ppBits);
@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// File: InputRecording.h
+//
+// Desc: Per step input recording. Together with the SimConfig (which holds
+//	   the seed) and the step rate, the inputs are all a replay needs to
+//	   play a session out again step for step. The collision masks the
+//	   world was given go with them, so a game session replayed headless
+//	   collides pixel for pixel as it did in the game.
+//
+//	   Each player's input packs into one byte, movement in the low four
+//	   bits and actions in the high four. Runs of identical steps, which
+//	   is most of them, are stored once with a repeat count.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _INPUTRECORDING_H_
+#define _INPUTRECORDING_H_
+
+//-----------------------------------------------------------------------------
+// CInputRecording Specific Includes
+//-----------------------------------------------------------------------------
+#include "SimWorld.h"
+#include "CollisionMask.h"
+#include <stdint.h>
+#include <iosfwd>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CInputRecording (Class)
+// Desc : Begin(), then Add() the input of every step as it is run; Stop()
+//		when the steps no longer follow on from the config, e.g. after a
+//		saved game is loaded, and the recording stays as it was. To play
+//		back, Rewind() and Next() once per step.
+//-----------------------------------------------------------------------------
+class CInputRecording
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CInputRecording();
+	virtual ~CInputRecording();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Begin		( const SimConfig& config, double dStepRate );
+	void				Stop		( ) { m_bRecording = false; }
+	void				Clear		( );
+	void				Add			( const SimInput& input );
+
+	// Only from Begin() to Stop(); a loaded recording is not being made.
+	bool				IsRecording	( ) const { return m_bRecording; }
+
+	// The masks given to CSimWorld::SetCollisionMasks, if any. They are
+	// kept from one Begin() to the next, as the world keeps them.
+	void				SetCollisionMasks( const std::vector<CCollisionMask>& playerMasks,
+										   const CCollisionMask& enemyMask, const CCollisionMask& bulletMask );
+	const std::vector<CCollisionMask>&	GetPlayerMasks	( ) const { return m_PlayerMasks; }
+	const CCollisionMask&				GetEnemyMask	( ) const { return m_EnemyMask; }
+	const CCollisionMask&				GetBulletMask	( ) const { return m_BulletMask; }
+
+	void				Rewind		( );
+	bool				Next		( SimInput& input );		// False past the last step
+
+	bool				Save		( std::ostream& out ) const;
+	bool				Load		( std::istream& in );
+	bool				SaveFile	( const char *szFileName ) const;
+	bool				LoadFile	( const char *szFileName );
+
+	const SimConfig&	GetConfig	( ) const { return m_Config; }
+	double				GetStepRate	( ) const { return m_dStepRate; }
+	unsigned long		GetStepCount( ) const { return m_ulSteps; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Run
+	{
+		uint32_t		uSteps;
+		uint8_t			Players[SIM_PLAYER_COUNT];
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	SimConfig			m_Config;
+	double				m_dStepRate;
+	unsigned long		m_ulSteps;
+	std::vector<Run>	m_Runs;
+	bool				m_bRecording;
+
+	std::vector<CCollisionMask>	m_PlayerMasks;
+	CCollisionMask				m_EnemyMask;
+	CCollisionMask				m_BulletMask;
+
+	size_t				m_iRun;				// Playback position
+	uint32_t			m_uRunStep;
+};
+
+#endif // _INPUTRECORDING_H_
@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+// File: JobSystem.h
+//
+// Desc: Work stealing job system. Each worker thread, and the thread that
+//	   created the system, has its own deque: it runs the newest job it
+//	   pushed, and when it runs dry it takes the oldest job from another
+//	   worker. Completion is tracked with counters, which can also hold a
+//	   job back until other work has finished.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// CJobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// A job works on items [iBegin, iEnd) of whatever pData points to.
+typedef void (*JOB_FUNC)( void *pData, size_t iBegin, size_t iEnd );
+
+class CJobCounter;
+
+//-----------------------------------------------------------------------------
+// Name : Job (Struct)
+//-----------------------------------------------------------------------------
+struct Job
+{
+	JOB_FUNC		pFunc;
+	void*			pData;
+	size_t			iBegin;
+	size_t			iEnd;
+	CJobCounter*	pCounter;		// Counted down when the job is done, may be NULL
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CJobCounter (Class)
+// Desc : Jobs still to finish. Each Run() with the counter adds one, each
+//		finished job takes one off. Jobs made to depend on the counter are
+//		parked here and released when it reaches zero.
+//-----------------------------------------------------------------------------
+class CJobCounter
+{
+	friend class CJobSystem;
+
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CJobCounter() : m_nPending(0) {}
+	virtual ~CJobCounter() {}
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool					IsDone		( ) const { return m_nPending.load(std::memory_order_acquire) == 0; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::atomic<int>		m_nPending;
+	std::mutex				m_Lock;			// Guards m_Waiting against the last job finishing
+	std::vector<Job>		m_Waiting;		// Jobs held back until the count reaches zero
+};
+
+//-----------------------------------------------------------------------------
+// Name : CJobSystem (Class)
+// Desc : Create() starts the workers; jobs can be handed in from any thread.
+//		A thread that waits on a counter runs jobs itself until it is done,
+//		so a job may wait on jobs of its own.
+//
+//		Deterministic mode runs every job on the thread that hands it in, at
+//		once and in order, which makes any side effects reproducible.
+//		ParallelFor() splits work by its grain size alone, never by the
+//		number of workers, so chunk results are the same in both modes.
+//-----------------------------------------------------------------------------
+class CJobSystem
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CJobSystem();
+	virtual ~CJobSystem();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Starts iWorkers threads besides the calling one, -1 for one less than
+	// the hardware threads. With none, jobs run when they are waited on.
+	bool				Create			( int iWorkers = -1 );
+	void				Release			( );
+
+	int					GetWorkerCount	( ) const { return m_nQueues - 1; }
+
+	void				SetDeterministic( bool bDeterministic ) { m_bDeterministic = bDeterministic; }
+	bool				IsDeterministic	( ) const { return m_bDeterministic; }
+
+	// Queues pFunc over [iBegin, iEnd). It starts once pDependency, if
+	// given, has no jobs left.
+	void				Run				( JOB_FUNC pFunc, void *pData, size_t iBegin, size_t iEnd,
+										  CJobCounter *pCounter, CJobCounter *pDependency = NULL );
+
+	// Runs queued jobs on this thread until the counter reaches zero.
+	void				Wait			( CJobCounter& counter );
+
+	// Calls func(iBegin, iEnd) over [0, n) in chunks of nGrain items and
+	// returns when all of them are done. n up to nGrain runs inline.
+	template <class FUNC>
+	void				ParallelFor		( size_t n, size_t nGrain, FUNC& func );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	// Padded apart so workers do not share a cache line
+	struct alignas(64) WorkerQueue
+	{
+		std::mutex			Lock;
+		std::deque<Job>		Jobs;			// Owner takes the back, thieves the front
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	int					GetWorkerIndex	( ) const;
+	void				Push			( const Job& job );
+	bool				RunOne			( int iWorker );
+	void				Execute			( const Job& job );
+	void				WorkerMain		( int iWorker );
+
+	template <class FUNC>
+	static void			CallRange		( void *pData, size_t iBegin, size_t iEnd ) { (*(FUNC*)pData)(iBegin, iEnd); }
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	WorkerQueue*				m_pQueues;		// Index 0 is the creating thread
+	int							m_nQueues;
+	std::vector<std::thread>	m_Threads;
+
+	std::atomic<int>			m_nQueued;		// Jobs sitting in any deque
+	std::mutex					m_SleepLock;
+	std::condition_variable		m_Wake;
+	bool						m_bQuit;
+	bool						m_bDeterministic;
+};
+
+//-----------------------------------------------------------------------------
+// Name : ParallelFor ()
+//-----------------------------------------------------------------------------
+template <class FUNC>
+void CJobSystem::ParallelFor( size_t n, size_t nGrain, FUNC& func )
+{
+	if (nGrain == 0)
+		nGrain = 1;
+
+	if (n <= nGrain)
+	{
+		if (n > 0)
+			func((size_t)0, n);
+		return;
+	}
+
+	CJobCounter counter;
+	for (size_t i = 0; i < n; i += nGrain)
+		Run(CallRange<FUNC>, &func, i, i + nGrain < n ? i + nGrain : n, &counter);
+
+	Wait(counter);
+}
+
+#endif // _JOBSYSTEM_H_
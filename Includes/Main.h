@@ -41,10 +41,7 @@
 #define C1_TRANSPARENT	1
 
 
-#define EPS 1e-3 // epsilon (the smallest float value used)
-#define PI 3.14159265358979323846
-#define DEG2RAD(deg) (PI * (deg) / 180.0)
-#define RAD2DEG(rad) ((rad) * 180.0 / PI)
+#include "MathDefs.h"
 
 
 
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// File: MaskedImage.h
+//
+// Desc: Image and monochrome mask pair built from 32 bit pixels, drawn with
+//	   the same SRCAND / SRCPAINT technique as Sprite::drawMask.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _MASKEDIMAGE_H_
+#define _MASKEDIMAGE_H_
+
+//-----------------------------------------------------------------------------
+// CMaskedImage Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const DWORD PIXEL_ALPHA_MASK	= 0xFF000000;	// Set on opaque pixels, clear on see-through ones
+const DWORD PIXEL_COLOR_MASK	= 0x00FFFFFF;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMaskedImage (Class)
+// Desc : Owns an image DIB (transparent pixels black) and its 1 bpp mask
+//		(transparent pixels white), ready for a two blit masked draw.
+//-----------------------------------------------------------------------------
+class CMaskedImage
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CMaskedImage();
+	virtual ~CMaskedImage();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// pPixels are top-down rows; pixels without PIXEL_ALPHA_MASK are see-through.
+	bool		Create		( HDC hdc, const DWORD *pPixels, int iWidth, int iHeight );
+	void		Release		( );
+
+	// Draws with the upper-left corner at (x, y). hdcMem is a scratch memory DC.
+	void		Draw		( HDC hdcDest, HDC hdcMem, int x, int y ) const;
+
+	// Stretched to iWidth x iHeight, nearest pixel, so image and mask pick
+	// the same pixels. For odd sizes only; a resampled copy looks better.
+	void		DrawScaled	( HDC hdcDest, HDC hdcMem, int x, int y, int iWidth, int iHeight ) const;
+
+	int			Width		( ) const { return m_iWidth; }
+	int			Height		( ) const { return m_iHeight; }
+	size_t		GetMemorySize( ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	HBITMAP		m_hImage;
+	HBITMAP		m_hMask;
+	int			m_iWidth;
+	int			m_iHeight;
+};
+
+#endif // _MASKEDIMAGE_H_
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// File: ParallaxBackground.h
+//
+// Desc: Multi-layer scrolling background. Every layer is converted once into
+//	   a strip the width of the viewport, so scrolling a layer only moves a
+//	   row offset into its strip. Layers hidden under an opaque layer are
+//	   dropped, and when a layer moves only it and the layers in front of
+//	   it are composited again, over a cached copy of the ones behind.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _PARALLAXBACKGROUND_H_
+#define _PARALLAXBACKGROUND_H_
+
+//-----------------------------------------------------------------------------
+// CParallaxBackground Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "ImageFile.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CParallaxBackground (Class)
+// Desc : Scrolls N layers vertically, each at its own speed, back to front.
+//-----------------------------------------------------------------------------
+class CParallaxBackground
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CParallaxBackground();
+	virtual ~CParallaxBackground();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Layers are added back to front. Speed is in pixels per second.
+	bool		AddLayer( const char *szFileName, HDC hdc, float fSpeed );
+	bool		AddLayer( const char *szFileName, HDC hdc, float fSpeed, COLORREF crColorKey );
+
+	// (Re)build the strip caches for a viewport of the given size.
+	bool		Build	( HDC hdc, int iWidth, int iHeight );
+	void		Release	( );
+
+	void		Update	( float dt );
+	void		Paint	( HDC hdc );
+
+	int			GetLayerCount() const { return (int)m_Layers.size(); }
+	int			GetVisibleLayerCount() const { return (int)m_Strips.size(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Layer
+	{
+		std::vector<DWORD>	Pixels;			// Source image, top-down rows
+		int					iWidth;
+		int					iHeight;
+		float				fSpeed;			// Pixels per second
+		bool				bColorKey;
+		DWORD				dwKey;			// Colour key in DIB pixel order
+	};
+
+	struct Span
+	{
+		int					iStart;			// First opaque pixel of the run
+		int					iCount;			// Length of the run
+	};
+
+	struct Strip
+	{
+		HBITMAP				hBitmap;		// View-wide DIB section, iHeight rows,
+											// alpha byte set on opaque pixels
+		DWORD				*pBits;
+		int					iHeight;		// Wrap period in rows
+		float				fSpeed;
+		float				fOffset;		// Scroll position in rows
+		int					iRow;			// Strip row shown at the top of the view
+		bool				bOpaque;
+		std::vector<Span>	Spans;			// Opaque runs, keyed strips only
+		std::vector<int>	RowSpans;		// Index of first span per row, iHeight + 1 entries
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	bool		BuildStrip		( HDC hdc, const Layer& layer, Strip& strip );
+	void		BuildSpans		( Strip& strip );
+	void		MergeStrip		( Strip& dst, const Strip& src );
+	void		Composite		( );
+	void		CompositeStrip	( const Strip& strip );
+	void		BlitStrip		( HDC hdc, const Strip& strip );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<Layer>		m_Layers;
+	std::vector<Strip>		m_Strips;		// Visible, merged strips, back to front
+	std::vector<std::vector<DWORD> > m_Behind;	// [i] is strips 0..i composited, for all but the front one
+
+	HDC						m_hMemDC;
+	HBITMAP					m_hOldBitmap;
+	HBITMAP					m_hComposite;
+	DWORD					*m_pComposite;
+	int						m_iWidth;
+	int						m_iHeight;
+	size_t					m_iDirtyFrom;	// Back-most strip moved since Composite(), strip count if none
+};
+
+#endif // _PARALLAXBACKGROUND_H_
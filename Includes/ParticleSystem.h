@@ -0,0 +1,134 @@
+//-----------------------------------------------------------------------------
+// File: ParticleSystem.h
+//
+// Desc: Pooled particles for explosions and other effects. Particles live
+//	   in fixed capacity component arrays, move and fade with the SIMD path
+//	   BoxBatch picked, and are drawn straight into a 32 bit surface, so a
+//	   hundred explosions cost a few thousand small blits instead of a
+//	   hundred sprite frames.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _PARTICLESYSTEM_H_
+#define _PARTICLESYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// CParticleSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "Random.h"
+#include "Camera.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+enum PARTICLE_BLEND
+{
+	PARTICLE_BLEND_ADD,						// Colour added, fading to nothing
+	PARTICLE_BLEND_KEY,						// Colour written, thinning out as it fades
+};
+
+enum PARTICLE_PRESET
+{
+	PARTICLE_EXPLOSION,
+	PARTICLE_SMOKE,
+	PARTICLE_SPARKS,
+
+	PARTICLE_PRESET_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Name : ParticlePreset (Struct)
+// Desc : How one Emit() call starts its particles. They fly out in random
+//		directions; speeds are pixels per second, drag the fraction of
+//		speed lost per second.
+//-----------------------------------------------------------------------------
+struct ParticlePreset
+{
+	int				nCount;
+	float			fSpeedMin, fSpeedMax;
+	float			fLifeMin, fLifeMax;		// Seconds
+	float			fDrag;
+	float			fGravity;				// Pixels per second squared, down
+	float			fRadius;				// Start spread around the emit point
+	uint32_t		uColour;				// 0x00RRGGBB, as the surface stores it
+	int				iSize;					// Square side in window pixels
+	PARTICLE_BLEND	Blend;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CParticleSystem (Class)
+// Desc : Particles 0..Count()-1 are live; dead ones are swapped out by the
+//		last, so their order means nothing. Emitting into a full pool drops
+//		the particles that do not fit.
+//-----------------------------------------------------------------------------
+class CParticleSystem
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CParticleSystem();
+	virtual ~CParticleSystem();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Create		( size_t nCapacity );
+	void				Clear		( ) { m_nCount = 0; }
+
+	// Returns the particles started.
+	size_t				Emit		( const ParticlePreset& preset, float x, float y );
+	size_t				Emit		( PARTICLE_PRESET Preset, float x, float y ) { return Emit(m_Presets[Preset], x, y); }
+
+	// Moves and fades every particle, then drops the ones that died.
+	void				Update		( float dt );
+
+	// Draws into a top down surface of 0x00RRGGBB pixels, keyed particles
+	// first so the additive ones glow over them. fScale takes window
+	// coordinates to surface ones.
+	void				Draw		( uint32_t *pBits, int iWidth, int iHeight, float fScale ) const;
+
+	// The same through a camera: moved and zoomed into its viewport and
+	// clipped to it, so each of several views can have its own.
+	void				Draw		( uint32_t *pBits, int iWidth, int iHeight, const CCamera& camera, float fScale ) const;
+
+	size_t				Count		( ) const { return m_nCount; }
+	size_t				Capacity	( ) const { return m_X.size(); }
+
+	static const ParticlePreset& GetPreset( PARTICLE_PRESET Preset ) { return m_Presets[Preset]; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void				RemoveAt	( size_t iIndex );
+
+	//-------------------------------------------------------------------------
+	// Private Static Variables for This Class
+	//-------------------------------------------------------------------------
+	static const ParticlePreset	m_Presets[PARTICLE_PRESET_COUNT];
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	size_t					m_nCount;
+	std::vector<float>		m_X, m_Y;
+	std::vector<float>		m_VelX, m_VelY;
+	std::vector<float>		m_Life;				// Seconds left
+	std::vector<float>		m_InvLifetime;
+	std::vector<float>		m_Fade;				// Life left as a fraction, set by Update()
+	std::vector<float>		m_Drag;
+	std::vector<float>		m_Gravity;
+	std::vector<uint32_t>	m_Colour;
+	std::vector<uint8_t>	m_Size;
+	std::vector<uint8_t>	m_Blend;
+	CRandom					m_Random;			// Looks only, never the game's streams
+};
+
+#endif // _PARTICLESYSTEM_H_
@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// File: Random.h
+//
+// Desc: Seedable random number streams (xoshiro256**). A stream is a plain
+//	   value with no shared state: whoever owns one may draw from it on any
+//	   thread, and two streams never affect each other. The same seed and
+//	   stream number give the same numbers on every platform.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+//-----------------------------------------------------------------------------
+// CRandom Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// Main Structure Declarations
+//-----------------------------------------------------------------------------
+// Everything needed to continue a stream exactly where it was.
+struct RandomState
+{
+	uint64_t	s[4];
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRandom (Class)
+// Desc : One stream. Seed(seed, n) gives stream n of a seed; streams are
+//		2^128 draws apart, so they cannot overlap in practice. Single
+//		draws are inline; FillFloat() does a whole array at once.
+//-----------------------------------------------------------------------------
+class CRandom
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	explicit CRandom( uint64_t uSeed = 1, uint64_t uStream = 0 ) { Seed(uSeed, uStream); }
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Seed		( uint64_t uSeed, uint64_t uStream = 0 );
+	void				Jump		( );		// Skips 2^128 draws
+
+	uint64_t			Next		( );
+	uint32_t			NextU32		( ) { return (uint32_t)(Next() >> 32); }
+	float				NextFloat	( ) { return (Next() >> 40) * (1.0f / 16777216.0f); }	// [0, 1)
+	double				NextDouble	( ) { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+	float				Range		( float fMin, float fMax ) { return fMin + (fMax - fMin) * NextFloat(); }
+
+	// [0, uBound) by multiply and shift; the bias is below uBound / 2^32.
+	uint32_t			Below		( uint32_t uBound ) { return (uint32_t)(((uint64_t)NextU32() * uBound) >> 32); }
+
+	void				FillFloat	( float *pOut, size_t n, float fMin, float fMax );
+
+	const RandomState&	GetState	( ) const { return m_State; }
+	void				SetState	( const RandomState& state ) { m_State = state; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	RandomState			m_State;
+};
+
+//-----------------------------------------------------------------------------
+// Name : Next ()
+//-----------------------------------------------------------------------------
+inline uint64_t CRandom::Next( )
+{
+	uint64_t *s = m_State.s;
+	uint64_t uResult = s[1] * 5;
+	uResult = ((uResult << 7) | (uResult >> 57)) * 9;
+
+	uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> 19);
+
+	return uResult;
+}
+
+#endif // _RANDOM_H_
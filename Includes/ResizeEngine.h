@@ -1,6 +1,8 @@
 #pragma once
 #include "Filters.h"
 #include "ImageFile.h"
+#include "JobSystem.h"
+#include <vector>
 
 class CWeightsTable
 {
@@ -52,6 +54,10 @@ public:
 
 	void SetFilter(CGenericFilter *pFilter) { m_pFilter = pFilter; }
 
+	// Rows and columns are filtered in chunks on this job system, shared by
+	// every image; NULL filters on the calling thread
+	static void SetJobSystem(CJobSystem *pJobs) { s_pJobs = pJobs; }
+
 	// Scale an image to the desired dimensions
 	void Resample(unsigned dst_width, unsigned dst_height);
 
@@ -64,5 +70,32 @@ private:
 
 	// Performs vertical image filtering
 	void VerticalFilter(unsigned int dst_width, unsigned int dst_height);
+
+	static CJobSystem *s_pJobs;
 };
 
+
+// Fast path for per-frame scaling of 32 bit top-down pixels: bilinear only,
+// 8 bit fixed point weights, tables kept while the sizes stay the same.
+class CFastResampler
+{
+	// Source index and weight of the right/bottom neighbour (0..256)
+	std::vector<int> m_XIndex, m_XWeight;
+	std::vector<int> m_YIndex, m_YWeight;
+
+	// Horizontally scaled source rows, reused across destination rows
+	std::vector<DWORD> m_Rows[2];
+	int m_RowSrc[2];
+
+	int m_SrcWidth, m_SrcHeight;
+	int m_DstWidth, m_DstHeight;
+
+public:
+	CFastResampler() : m_SrcWidth(0), m_SrcHeight(0), m_DstWidth(0), m_DstHeight(0) {}
+
+	void Resample(const DWORD *pSrc, int src_width, int src_height, DWORD *pDst, int dst_width, int dst_height);
+
+private:
+	static void BuildAxis(std::vector<int>& index, std::vector<int>& weight, int src_size, int dst_size);
+	void ScaleRow(const DWORD *pSrcRow, DWORD *pDstRow);
+};
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// File: RotationCache.h
+//
+// Desc: Rotated copies of a sprite generated once at load time, so turning
+//	   at run time is only a change of index into the cache.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _ROTATIONCACHE_H_
+#define _ROTATIONCACHE_H_
+
+//-----------------------------------------------------------------------------
+// CRotationCache Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "MaskedImage.h"
+#include "CollisionMask.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class Sprite;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRotationCache (Class)
+// Desc : Holds N evenly spaced rotations of an image together with their
+//		masks and collision masks. Step 0 is the source image, steps run
+//		clockwise on screen.
+//-----------------------------------------------------------------------------
+class CRotationCache
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CRotationCache();
+	virtual ~CRotationCache();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool				Build		( HDC hdc, Sprite *pSprite, int iSteps );
+	bool				Build		( HDC hdc, const DWORD *pPixels, int iWidth, int iHeight, int iSteps );
+	void				Release		( );
+
+	int					GetStepCount( ) const { return (int)m_Images.size(); }
+	const CMaskedImage*	GetImage	( int iStep ) const;
+
+	// One per step, matching the drawn pixels exactly.
+	const std::vector<CCollisionMask>& GetCollisionMasks( ) const { return m_Masks; }
+
+	// Wraps any step index, including negative ones, into the cache.
+	int					WrapStep	( int iStep ) const;
+	int					StepFromAngle( double dRadians ) const;
+	double				AngleFromStep( int iStep ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<CMaskedImage*>	m_Images;
+	std::vector<CCollisionMask>	m_Masks;
+};
+
+#endif // _ROTATIONCACHE_H_
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// File: ScriptRunner.h
+//
+// Desc: Behaviour scripts as C++20 coroutines. A script is a function
+//	   returning ScriptTask that co_awaits the runner's clock, e.g.
+//
+//		ScriptTask Patrol( CScriptRunner& runner, CSimWorld *pWorld, ... )
+//		{
+//			for (;;)
+//			{
+//				...turn round...
+//				co_await runner.WaitUntil(ulTick += 500);
+//			}
+//		}
+//
+//	   A waiting script is one timer on a CTimerWheel, so only scripts
+//	   falling due cost anything; nothing polls the others. Coroutine
+//	   frames come from the runner's pool, which only allocates while it
+//	   grows to the busiest moment. The frame's operator new is declared
+//	   for the parameter list scripts use, the enemy scripts' (runner,
+//	   world, enemy, pattern); a script taking other parameters needs an
+//	   overload of its own here.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SCRIPTRUNNER_H_
+#define _SCRIPTRUNNER_H_
+
+//-----------------------------------------------------------------------------
+// CScriptRunner Specific Includes
+//-----------------------------------------------------------------------------
+#include "TimerWheel.h"
+#include "EntityStore.h"
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+class CScriptRunner;
+class CSimWorld;
+struct BulletPattern;
+
+//-----------------------------------------------------------------------------
+// Name : ScriptHandle (Struct)
+// Desc : Script slot plus its generation, stale once the script is over.
+//-----------------------------------------------------------------------------
+struct ScriptHandle
+{
+	unsigned int	uIndex;
+	unsigned int	uGeneration;
+};
+
+const ScriptHandle INVALID_SCRIPT = { 0xFFFFFFFF, 0 };
+
+//-----------------------------------------------------------------------------
+// Name : ScriptTask (Class)
+// Desc : What a script function returns; hand it to CScriptRunner::Start().
+//		A script's first parameter must be the runner, whose pool its frame
+//		is allocated from. Scripts do not run until started.
+//-----------------------------------------------------------------------------
+class ScriptTask
+{
+public:
+	struct promise_type
+	{
+		CScriptRunner*	pRunner;
+		unsigned int	uIndex;				// Slot in the runner
+
+		ScriptTask				get_return_object	( ) { return ScriptTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always		initial_suspend		( ) noexcept { return std::suspend_always(); }
+		std::suspend_always		final_suspend		( ) noexcept { return std::suspend_always(); }
+		void					return_void			( ) { }
+		void					unhandled_exception	( ) { std::terminate(); }
+
+		// Called with the script's arguments. Not a template: GCC then
+		// takes a template new and the delete for a mismatched pair.
+		static void*	operator new	( size_t nSize, CScriptRunner& runner, CSimWorld *pWorld, EntityHandle hEntity,
+										  const BulletPattern *pPattern );
+		static void		operator delete	( void *pFrame, size_t nSize );
+	};
+
+	ScriptTask( ScriptTask&& task ) noexcept : m_Handle(task.m_Handle) { task.m_Handle = nullptr; }
+	~ScriptTask( ) { if (m_Handle) m_Handle.destroy(); }
+
+private:
+	friend class CScriptRunner;
+
+	explicit ScriptTask( std::coroutine_handle<promise_type> handle ) : m_Handle(handle) { }
+	ScriptTask( const ScriptTask& );
+	ScriptTask& operator=( const ScriptTask& );
+
+	std::coroutine_handle<promise_type>	m_Handle;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CScriptRunner (Class)
+// Desc : Owns running scripts and resumes them from the timing wheel given
+//		to Create(). Scripts resume inside the wheel's Advance(), in the
+//		order their waits fall due, and may start or stop scripts.
+//-----------------------------------------------------------------------------
+class CScriptRunner
+{
+public:
+	//-------------------------------------------------------------------------
+	// Awaitable returned by WaitUntil()
+	//-------------------------------------------------------------------------
+	struct Wait
+	{
+		CScriptRunner*	pRunner;
+		uint64_t		ulTick;
+
+		bool	await_ready		( ) const noexcept { return false; }
+		void	await_suspend	( std::coroutine_handle<ScriptTask::promise_type> handle ) { pRunner->Suspend(handle.promise().uIndex, ulTick); }
+		void	await_resume	( ) const noexcept { }
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CScriptRunner();
+	virtual ~CScriptRunner();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Create		( CTimerWheel *pTimers ) { m_pTimers = pTimers; }
+
+	// Runs the script up to its first wait.
+	ScriptHandle		Start		( ScriptTask task );
+	bool				Stop		( ScriptHandle handle );
+	bool				IsRunning	( ScriptHandle handle ) const;
+	void				Clear		( );
+
+	// Resumes in the wheel's tick ulTick, or the next one if that has come.
+	Wait				WaitUntil	( uint64_t ulTick ) { Wait wait = { this, ulTick }; return wait; }
+
+	size_t				GetActiveCount( ) const { return m_nActive; }
+
+	// Coroutine frames, for ScriptTask's promise.
+	void*				AllocateFrame( size_t nSize );
+	static void			FreeFrame	( void *pFrame, size_t nSize );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Script
+	{
+		std::coroutine_handle<ScriptTask::promise_type>	Handle;		// Null while free
+		TimerHandle		hTimer;
+		unsigned int	uGeneration;
+		unsigned int	uNextFree;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Suspend		( unsigned int uIndex, uint64_t ulTick );
+	void				Resume		( unsigned int uIndex );
+	void				Release		( unsigned int uIndex );
+	static void			OnTimer		( void *pRunner, uint64_t uData );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	CTimerWheel*				m_pTimers;
+	std::vector<Script>			m_Scripts;
+	unsigned int				m_uFree;			// Free slot list, ~0u at the end
+	unsigned int				m_uRunning;			// Script being resumed, ~0u outside
+	size_t						m_nActive;
+	std::vector<void*>			m_FreeFrames[32];	// By size in 64 byte steps
+	std::vector<void*>			m_Frames;			// Every frame made, for the destructor
+};
+
+//-----------------------------------------------------------------------------
+// Name : operator new () (ScriptTask::promise_type)
+// Desc : Only the runner is used of the script's arguments.
+//-----------------------------------------------------------------------------
+inline void* ScriptTask::promise_type::operator new( size_t nSize, CScriptRunner& runner, CSimWorld * /*pWorld*/,
+													 EntityHandle /*hEntity*/, const BulletPattern * /*pPattern*/ )
+{
+	return runner.AllocateFrame(nSize);
+}
+
+//-----------------------------------------------------------------------------
+// Name : operator delete () (ScriptTask::promise_type)
+//-----------------------------------------------------------------------------
+inline void ScriptTask::promise_type::operator delete( void *pFrame, size_t nSize )
+{
+	CScriptRunner::FreeFrame(pFrame, nSize);
+}
+
+#endif // _SCRIPTRUNNER_H_
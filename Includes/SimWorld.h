@@ -0,0 +1,477 @@
+//-----------------------------------------------------------------------------
+// File: SimWorld.h
+//
+// Desc: Platform independent game simulation. Owns the world state (players,
+//	   enemies, bullets), takes one input command per step and reports what
+//	   happened through events. Nothing in here touches Win32, so the same
+//	   rules run under the game window and under the headless driver.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMWORLD_H_
+#define _SIMWORLD_H_
+
+//-----------------------------------------------------------------------------
+// CSimWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include "Vec2.h"
+#include "EntityStore.h"
+#include "FlowField.h"
+#include "BulletPool.h"
+#include "BulletEmitter.h"
+#include "ScriptRunner.h"
+#include "CollisionSystem.h"
+#include "JobSystem.h"
+#include "SystemScheduler.h"
+#include "Random.h"
+#include "TimerWheel.h"
+#include "WaveSpawner.h"
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int SIM_PLAYER_COUNT			= 2;
+const int SIM_PLAYER_ROTATION_STEPS	= 32;	// Headings per turn, multiple of 4
+const double SIM_DEFAULT_STEP_RATE	= 120.0;	// Steps per second
+
+//-----------------------------------------------------------------------------
+// Name : SimPlayerInput (Struct)
+// Desc : One player's commands for a single step. Movement is held state,
+//		actions are edge triggered and only applied on the step they arrive.
+//-----------------------------------------------------------------------------
+struct SimPlayerInput
+{
+	enum MOVE
+	{
+		MOVE_FORWARD	= 1,
+		MOVE_BACKWARD	= 2,
+		MOVE_LEFT		= 4,
+		MOVE_RIGHT		= 8,
+	};
+
+	enum ACTION
+	{
+		ACTION_FIRE			= 1,
+		ACTION_ROTATE_LEFT	= 2,
+		ACTION_ROTATE_RIGHT	= 4,
+		ACTION_SELF_DESTRUCT= 8,
+	};
+
+	unsigned int	uMove;
+	unsigned int	uActions;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimInput (Struct)
+// Desc : Everything the simulation is told for one step.
+//-----------------------------------------------------------------------------
+struct SimInput
+{
+	SimPlayerInput	Players[SIM_PLAYER_COUNT];
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimEvent (Struct)
+// Desc : Something a frontend may want to present (play, show, end).
+//-----------------------------------------------------------------------------
+struct SimEvent
+{
+	enum TYPE
+	{
+		EVENT_EXPLOSION,		// iSubject exploded at Position
+		EVENT_SOUND,			// iSound started for iSubject
+		EVENT_SHOT,				// iSubject fired from Position
+		EVENT_GAME_OVER,		// iSubject is the winning player
+	};
+
+	enum SOUND
+	{
+		SOUND_JET_START,
+		SOUND_JET_STOP,
+		SOUND_JET_CABIN,
+		SOUND_EXPLOSION,
+	};
+
+	TYPE			Type;
+	int				iSound;
+	int				iSubject;		// Player index, or enemy index for enemies
+	bool			bEnemy;
+	Vec2			Position;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimConfig (Struct)
+// Desc : Play area, sizes and rules. The defaults match the shipped assets
+//		so the headless driver needs no images.
+//-----------------------------------------------------------------------------
+struct SimConfig
+{
+	SimConfig();
+
+	double			dWidth;					// Play area, players are clamped to it
+	double			dHeight;
+
+	double			dPlayerWidth;			// Unrotated collision boxes
+	double			dPlayerHeight;
+	double			dEnemyWidth;
+	double			dEnemyHeight;
+	double			dBulletWidth;
+	double			dBulletHeight;
+
+	int				iEnemyCount;
+	int				iPlayerLives;
+	int				iMaxBullets;			// Bullet pool capacity
+	int				iEnemyPattern;			// SIM_ENEMY_PATTERN every enemy fires
+	int				iEnemyScript;			// SIM_ENEMY_SCRIPT every enemy runs
+
+	// Wave file text (see WaveSpawner.h). Empty, or without a wave, for
+	// iEnemyCount enemies in rows, firing iEnemyPattern and running
+	// iEnemyScript. Archetypes name their own, falling back to those two.
+	std::string		Waves;
+
+	float			fExplosionTime;			// Seconds a player or enemy takes to explode
+
+	unsigned int	uSeed;					// Random numbers from Reset() on
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimPlayer (Struct)
+//-----------------------------------------------------------------------------
+struct SimPlayer
+{
+	Vec2			Position;
+	Vec2			PrevPosition;			// At the start of the last step
+	Vec2			Velocity;
+	Vec2			Spawn;					// Where the player comes back after a hit
+	int				iHeading;				// Rotation step, clockwise from forward
+	int				iLives;
+	int				iScore;
+	double			dFireReady;				// Game time a shot is allowed from
+	bool			bEngineOn;				// Jet sound state
+	float			fSoundTimer;
+	bool			bExploding;
+	TimerHandle		hExplosionTimer;		// Explosion over
+	Vec2			ExplosionPosition;
+};
+
+//-----------------------------------------------------------------------------
+// Enemies live in a CEntityStore; these name their flags and timers.
+//-----------------------------------------------------------------------------
+enum SIM_SPRITE
+{
+	SIM_SPRITE_ENEMY,
+};
+
+enum SIM_ENEMY_FLAGS
+{
+	ENEMY_EXPLODING		= 1,			// Holds still, no longer collides, removed when done
+	ENEMY_GONE			= 2,			// Removed at the end of the timers
+	ENEMY_HOMING		= 4,			// Steers down the flow field at its Speed
+};
+
+// Enemy timers hold game times (see CSimWorld::GetTime()); the timing wheel
+// acts on them, nothing counts them down.
+enum SIM_ENEMY_TIMERS
+{
+	ENEMY_TIMER_FIRE,					// Next fire attempt, or script start
+	ENEMY_TIMER_COOLDOWN,				// A shot is allowed from
+	ENEMY_TIMER_EXPLOSION,				// It was hit
+};
+
+//-----------------------------------------------------------------------------
+// World data the step systems declare they read or write. Systems that
+// write the same data, or read what another writes, keep their order.
+//-----------------------------------------------------------------------------
+enum SIM_DATA
+{
+	SIM_DATA_PLAYERS		= 1 << 0,
+	SIM_DATA_ENEMY_MOTION	= 1 << 1,		// Positions and velocities
+	SIM_DATA_ENEMY_STATE	= 1 << 2,		// Flags and timers
+	SIM_DATA_BULLETS		= 1 << 3,		// And the patterns firing them
+	SIM_DATA_EVENTS			= 1 << 4,
+	SIM_DATA_COLLISION		= 1 << 5,
+	SIM_DATA_GAME			= 1 << 6,		// Game over flag
+	SIM_DATA_TIMERS			= 1 << 7,		// The timing wheel
+	SIM_DATA_FLOW			= 1 << 8,		// The flow field to the players
+};
+
+//-----------------------------------------------------------------------------
+// Random number streams, one per user, all seeded from SimConfig::uSeed.
+// A stream belongs to a single system, so drawing needs no SIM_DATA bit,
+// and a new user of random numbers does not shift anyone else's.
+//-----------------------------------------------------------------------------
+enum SIM_RANDOM_STREAM
+{
+	SIM_RANDOM_SPAWN,					// Enemy head starts, as they spawn
+	SIM_RANDOM_FIRE,					// Enemy fire timing
+
+	SIM_RANDOM_STREAM_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Enemy fire patterns, see the pattern table in SimWorld.cpp. The single
+// shot is the original game; the storm is there to load the bullet code.
+//-----------------------------------------------------------------------------
+enum SIM_ENEMY_PATTERN
+{
+	SIM_PATTERN_SINGLE,
+	SIM_PATTERN_SPREAD,
+	SIM_PATTERN_RING,
+	SIM_PATTERN_SPIRAL,
+	SIM_PATTERN_AIMED,
+	SIM_PATTERN_STORM,
+
+	SIM_PATTERN_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Enemy behaviour scripts, see the script table in SimWorld.cpp. Drifting
+// down and firing now and then is the original game.
+//-----------------------------------------------------------------------------
+enum SIM_ENEMY_SCRIPT
+{
+	SIM_SCRIPT_DRIFT,
+	SIM_SCRIPT_STRAFE,					// Fly in, strafe, hold, fire, retreat
+	SIM_SCRIPT_CHASE,					// Home in on the nearer player, firing like drift
+
+	SIM_SCRIPT_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Collision layers. Which of them meet, and what happens when they do, is
+// the rule table in SimWorld.cpp.
+//-----------------------------------------------------------------------------
+enum SIM_COLLISION_LAYER
+{
+	SIM_LAYER_PLAYER,
+	SIM_LAYER_ENEMY,
+	SIM_LAYER_PLAYER_SHOT,
+	SIM_LAYER_ENEMY_SHOT,
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSimWorld (Class)
+// Desc : The game rules. Step() advances the world by one input command.
+//-----------------------------------------------------------------------------
+class CSimWorld
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSimWorld();
+	virtual ~CSimWorld();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Reset		( const SimConfig& config );
+	void				Step		( const SimInput& input, float dt );
+
+	bool				Save		( std::ostream& out ) const;
+	bool				Load		( std::istream& in );
+
+	// Events raised since the last ClearEvents().
+	const std::vector<SimEvent>&	GetEvents() const { return m_Events; }
+	void				ClearEvents	( ) { m_Events.clear(); }
+
+	const SimConfig&	GetConfig	( ) const { return m_Config; }
+	void				SetPlayArea	( double dWidth, double dHeight );
+
+	const SimPlayer&	GetPlayer	( int iIndex ) const { return m_Players[iIndex]; }
+	const CEntityStore&	GetEnemies	( ) const { return m_Enemies; }
+	const CBulletPool&	GetBullets	( ) const { return m_Bullets; }
+
+	bool				IsGameOver	( ) const { return m_bGameOver; }
+	unsigned long		GetStepCount( ) const { return m_ulStep; }
+	double				GetTime		( ) const { return m_dTime; }	// Seconds played, to the end of the last step
+
+	// Hash of everything the rules carry from step to step; two runs that
+	// agree on it are playing the same game.
+	uint64_t			GetStateHash( ) const;
+
+	// Collision box of a player at its current heading.
+	void				GetPlayerSize( int iIndex, double& dWidth, double& dHeight ) const;
+
+	// Pixel masks checked after the boxes overlap: one per player heading,
+	// plus the enemy and the bullet. Hits involving a missing or empty mask
+	// are decided by the boxes alone, which is all the headless driver has.
+	void				SetCollisionMasks( const std::vector<CCollisionMask>& playerMasks,
+										   const CCollisionMask& enemyMask, const CCollisionMask& bulletMask );
+
+	// Large enemy counts are updated in chunks on the given job system, NULL
+	// for this thread only. Chunks touch their own enemies alone, so the
+	// results are the same either way.
+	void				SetJobSystem( CJobSystem *pJobs ) { m_pJobs = pJobs; }
+
+	// The step's systems, for their per-system timings once turned on.
+	const CSystemScheduler&	GetSystems	( ) const { return m_Systems; }
+	void				SetSystemTiming( bool bTiming ) { m_Systems.SetTiming(bTiming); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Types for This Class
+	//-------------------------------------------------------------------------
+	// Enemy behaviour, run once per enemy from when it spawns; pPattern is
+	// what it fires.
+	typedef ScriptTask (*ENEMY_SCRIPT)( CScriptRunner& scripts, CSimWorld *pWorld, EntityHandle hEnemy,
+										const BulletPattern *pPattern );
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void		SpawnEnemies	( );
+	void		SpawnFormation	( size_t nCount, float fSpeed, ENEMY_SCRIPT pScript, const BulletPattern *pPattern );
+	void		ScheduleWaves	( );
+	// Step systems, see the system table in SimWorld.cpp
+	void		SavePositions	( );
+	void		ApplyInput		( );
+	void		MoveEnemies		( );
+	void		Integrate		( );
+	void		UpdateFlowField	( );
+	void		UpdateSounds	( );
+	void		RunTimers		( );
+	void		RemoveGone		( );
+	void		UpdateEmitters	( );
+	void		MoveBullets		( );
+	void		Collide			( );
+	void		AddProxies		( );
+	void		RemoveHitBullets( );
+	void		CheckGameOver	( );
+
+	// Timer callbacks, uData is an enemy handle, a player index or a wave
+	void		OnEnemyExplosionTimer	( uint64_t uData );
+	void		OnPlayerExplosionTimer	( uint64_t uData );
+	void		OnWaveTimer				( uint64_t uData );
+	TimerHandle	ScheduleTimer	( double dTime, TIMER_FUNC pFunc, uint64_t uData );
+	uint64_t	TimeToTick		( double dTime ) const;
+
+	void		PlayerFire		( int iIndex );
+	void		EnemyFire		( size_t iIndex, const BulletPattern *pPattern );
+	void		ExplodePlayer	( int iIndex );
+	void		ExplodeEnemy	( size_t iIndex );
+	void		Respawn			( int iIndex );
+	void		RaiseEvent		( SimEvent::TYPE type, int iSubject, bool bEnemy, const Vec2& position, int iSound = 0 );
+
+	const CCollisionMask* GetPlayerMask( int iIndex ) const;
+	const CCollisionMask* GetEnemyMask ( ) const;
+	const CCollisionMask* GetBulletMask( ) const;
+
+	// Hit responses, called with the owner ids of the rule's two proxies
+	void		OnEnemyHitsPlayer		( unsigned int uEnemy, unsigned int uPlayer );
+	void		OnPlayersCrash			( unsigned int uPlayerA, unsigned int uPlayerB );
+	void		OnEnemyShotHitsPlayer	( unsigned int uBullet, unsigned int uPlayer );
+	void		OnPlayerShotHitsPlayer	( unsigned int uBullet, unsigned int uPlayer );
+	void		OnPlayerShotHitsEnemy	( unsigned int uBullet, unsigned int uEnemy );
+
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	typedef void (CSimWorld::*HIT_HANDLER)( unsigned int uA, unsigned int uB );
+
+	struct CollisionRule
+	{
+		SIM_COLLISION_LAYER	LayerA;
+		SIM_COLLISION_LAYER	LayerB;
+		HIT_HANDLER			pHandler;
+	};
+
+	static const CollisionRule	m_CollisionRules[];
+
+	struct StepSystem
+	{
+		const char*			szName;
+		SYSTEM_FUNC			pFunc;
+		uint32_t			uReads;
+		uint32_t			uWrites;
+	};
+
+	static const StepSystem		m_StepSystems[];
+	static const BulletPattern	m_EnemyPatterns[SIM_PATTERN_COUNT];
+
+	// Enemy scripts wait for a game time; co_await gives back the enemy's
+	// index then, or -1 once it is gone, or going, and the script should end.
+	struct EnemyWait
+	{
+		CScriptRunner::Wait	Wait;
+		const CEntityStore*	pEnemies;
+		EntityHandle		hEnemy;
+
+		bool	await_ready		( ) const noexcept { return false; }
+		void	await_suspend	( std::coroutine_handle<ScriptTask::promise_type> handle ) { Wait.await_suspend(handle); }
+		int		await_resume	( ) const noexcept
+		{
+			int iIndex = pEnemies->IndexOf(hEnemy);
+			return iIndex >= 0 && !(pEnemies->Flags[iIndex] & ENEMY_GONE) ? iIndex : -1;
+		}
+	};
+
+	static const ENEMY_SCRIPT	m_EnemyScripts[SIM_SCRIPT_COUNT];
+
+	// A wave file archetype with its names looked up
+	struct WaveArchetype
+	{
+		ENEMY_SCRIPT			pScript;
+		const BulletPattern*	pPattern;		// NULL holds fire
+		float					fSpeed;
+	};
+
+	EnemyWait	WaitEnemy		( EntityHandle hEnemy, double dTime );
+	static ScriptTask DriftScript	( CScriptRunner& scripts, CSimWorld *pWorld, EntityHandle hEnemy, const BulletPattern *pPattern );
+	static ScriptTask StrafeScript	( CScriptRunner& scripts, CSimWorld *pWorld, EntityHandle hEnemy, const BulletPattern *pPattern );
+	static ScriptTask ChaseScript	( CScriptRunner& scripts, CSimWorld *pWorld, EntityHandle hEnemy, const BulletPattern *pPattern );
+
+	template <void (CSimWorld::*SYSTEM)( )>
+	static void	RunSystem		( void *pWorld ) { (((CSimWorld*)pWorld)->*SYSTEM)(); }
+
+	template <void (CSimWorld::*HANDLER)( uint64_t )>
+	static void	RunTimer		( void *pWorld, uint64_t uData ) { (((CSimWorld*)pWorld)->*HANDLER)(uData); }
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	SimConfig				m_Config;
+	SimPlayer				m_Players[SIM_PLAYER_COUNT];
+	CEntityStore			m_Enemies;
+	CBulletPool				m_Bullets;
+	CBulletEmitter			m_Emitters;			// Patterns with bursts still to fire
+	CCollisionSystem		m_Collision;
+	CJobSystem*				m_pJobs;
+	CRandom					m_Random[SIM_RANDOM_STREAM_COUNT];
+	CTimerWheel				m_Timers;			// In milliseconds of game time
+	CScriptRunner			m_Scripts;			// Enemy behaviour, resumed by m_Timers
+	CWaveSpawner			m_Waves;			// Parsed from m_Config.Waves
+	std::vector<WaveArchetype>	m_WaveArchetypes;	// By CWaveSpawner archetype
+	std::vector<float>		m_SpawnX, m_SpawnY;	// Where SpawnFormation() puts enemies
+	CFlowField				m_FlowField;		// Toward the players, for homing enemies
+	bool					m_bFlowField;		// Kept up to date once anything homes
+	double					m_dFlowDue;			// Game time of the next rebuild
+	double					m_dTime;
+	CSystemScheduler		m_Systems;			// What Step() runs
+	SimInput				m_StepInput;		// Input and length of the step running
+	float					m_fStepTime;
+	std::vector<unsigned int>	m_HitBullets;	// Bullets to despawn after the hits
+	std::vector<CCollisionMask>	m_PlayerMasks;	// By heading
+	CCollisionMask			m_EnemyMask;
+	CCollisionMask			m_BulletMask;
+	std::vector<SimEvent>	m_Events;
+	unsigned long			m_ulStep;
+	bool					m_bGameOver;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimLerp ()
+// Desc : Render position between the previous and current step, alpha 0..1.
+//-----------------------------------------------------------------------------
+inline Vec2 SimLerp( const Vec2& prev, const Vec2& cur, double dAlpha )
+{
+	return Vec2(prev.x + (cur.x - prev.x) * dAlpha, prev.y + (cur.y - prev.y) * dAlpha);
+}
+
+#endif // _SIMWORLD_H_
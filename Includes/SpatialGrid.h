@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.h
+//
+// Desc: Uniform grid broadphase. Boxes are bucketed into fixed size cells
+//	   once per step; a query only looks at the cells its box touches, so
+//	   collision cost grows with the number of nearby boxes, not with the
+//	   total count. The cell table wraps around instead of clamping, so the
+//	   grid has no edges and boxes far off screen never pile up in one cell.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SPATIALGRID_H_
+#define _SPATIALGRID_H_
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpatialGrid (Class)
+// Desc : Insert() boxes, Build(), then Query(). Buffers are kept between
+//		steps; after warm up nothing allocates.
+//-----------------------------------------------------------------------------
+class CSpatialGrid
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpatialGrid();
+	virtual ~CSpatialGrid();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void		Reset		( float fCellSize );
+	void		Clear		( );
+
+	void		Insert		( unsigned int uId, float fMinX, float fMinY, float fMaxX, float fMaxY );
+	void		Build		( );
+
+	// Ids of inserted boxes overlapping the box, each reported once.
+	void		Query		( float fMinX, float fMinY, float fMaxX, float fMaxY, std::vector<unsigned int>& ids ) const;
+
+	size_t		GetCount	( ) const { return m_Boxes.size(); }
+	float		GetCellSize	( ) const { return 1.0f / m_fInvCellSize; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Box
+	{
+		float			fMinX, fMinY, fMaxX, fMaxY;
+		unsigned int	uId;
+		int				iCellX0, iCellY0;	// Cell range, worked out on insert
+		int				iCellX1, iCellY1;
+	};
+
+	struct Entry
+	{
+		unsigned int	uBox;			// Index into m_Boxes
+		int				iCellX;			// Cell it was filed under; other cells
+		int				iCellY;			// may wrap onto the same bucket
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	int			Cell		( float f ) const;
+	unsigned int Bucket		( int x, int y ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	float						m_fInvCellSize;
+	unsigned int				m_uBucketMask;		// Bucket count - 1, a power of two
+	unsigned int				m_uRowPitch;		// Buckets per grid row, a power of two
+	int							m_iMinCellX;		// Column range of the inserted boxes
+	int							m_iMaxCellX;
+
+	std::vector<Box>			m_Boxes;			// In insertion order
+	std::vector<unsigned int>	m_BucketStart;		// Bucket count + 1 offsets into m_Entries
+	std::vector<Entry>			m_Entries;			// Grouped by bucket
+	std::vector<unsigned int>	m_EntryBucket;		// Build scratch, bucket of each entry in box order
+	size_t						m_nEntries;			// Cells covered by all inserted boxes
+};
+
+#endif // _SPATIALGRID_H_
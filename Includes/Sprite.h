@@ -7,6 +7,11 @@
 #include "main.h"
 #include "Vec2.h"
 #include "BackBuffer.h"
+#include "RotationCache.h"
+#include "CollisionMask.h"
+#include <vector>
+
+class CSpritePyramid;
 
 class Sprite
 {
@@ -17,13 +22,29 @@ public:
 
 	virtual ~Sprite();
 
-	int width(){ return mImageBM.bmWidth; }
-	int height(){ return mImageBM.bmHeight; }
+	// Size of the image currently drawn, which depends on the rotation.
+	int width(){ return mpRotations ? mpRotations->GetImage(miRotation)->Width() : mImageBM.bmWidth; }
+	int height(){ return mpRotations ? mpRotations->GetImage(miRotation)->Height() : mImageBM.bmHeight; }
 	void update(float dt);
 
 	void setBackBuffer(const BackBuffer *pBackBuffer);
 	virtual void draw();
 
+	// Draws at dScale times the size: the pre-scaled copy nearest to it,
+	// built on first use, stretched the rest of the way unless it is
+	// within a few percent. Rotated sprites use their cached heading.
+	void drawScaled(double dScale);
+
+	// Top-down 32 bit pixels; the alpha byte is set on opaque pixels.
+	bool getPixels(std::vector<DWORD>& pixels);
+
+	// One bit per opaque pixel of the loaded image, for the simulation.
+	bool getCollisionMask(CCollisionMask& mask);
+
+	// Draw a pre-rotated copy instead of the image. The cache is not owned.
+	void setRotation(const CRotationCache *pRotations, int iStep);
+	int getRotation() const { return miRotation; }
+
 
 public:
 	// Keep these public because they need to be
@@ -56,33 +77,11 @@ public:
 
 	COLORREF mcTransparentColor;
 
-};
+	CSpritePyramid *mpPyramid;
 
-// AnimatedSprite
-// by Mihai Popescu
-// April 5, 2008
-class AnimatedSprite : public Sprite
-{
-public:
-	//NOTE: The animation is on a single row.
-	AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount);
-	virtual ~AnimatedSprite() { }
-
-public:
-	void SetFrame(int iIndex);
-	int GetFrameCount() { return miFrameCount; }
-
-	virtual void draw();
-	
-protected:
-	POINT mptFrameStartCrop;// first point of the frame (upper-left corner)
-	POINT mptFrameCrop;		// crop point of frame
-	int miFrameWidth;		// width
-	int miFrameHeight;		// height
-	int miFrameCount;		// number of frames
+	const CRotationCache *mpRotations;
+	int miRotation;
 };
 
-
-
 #endif // SPRITE_H
 
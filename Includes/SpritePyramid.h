@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// File: SpritePyramid.h
+//
+// Desc: Lazily built set of pre-scaled copies of a sprite, made with the
+//	   resize engine. Drawing at a scale then costs a masked blit of the
+//	   nearest level instead of a resample. All pyramids share one memory
+//	   budget and the least recently drawn levels are evicted first.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SPRITEPYRAMID_H_
+#define _SPRITEPYRAMID_H_
+
+//-----------------------------------------------------------------------------
+// CSpritePyramid Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "MaskedImage.h"
+#include <vector>
+#include <list>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class Sprite;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpritePyramid (Class)
+// Desc : Levels are spaced half an octave apart, from 1/8 to 4 times the
+//		native size. Minified levels use Lanczos3, magnified ones bicubic.
+//-----------------------------------------------------------------------------
+class CSpritePyramid
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum
+	{
+		LEVELS_PER_OCTAVE	= 2,
+		LEVEL_NATIVE		= 6,	// 2^(-6/2) = 1/8 is level 0
+		LEVEL_COUNT			= 11	// 2^(4/2) = 4 is the last level
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpritePyramid(Sprite *pSprite);
+	virtual ~CSpritePyramid();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Returns the level nearest to dScale, building it on first use.
+	const CMaskedImage*	GetLevel	( HDC hdc, double dScale );
+
+	static int			LevelFromScale	( double dScale );
+	static double		ScaleFromLevel	( int iLevel );
+
+	// Budget shared by every pyramid, in bytes.
+	static void			SetMemoryBudget	( size_t uBytes );
+	static size_t		GetMemoryBudget	( ) { return s_uMemoryBudget; }
+	static size_t		GetMemoryUsed	( ) { return s_uMemoryUsed; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct LevelRef
+	{
+		CSpritePyramid	*pPyramid;
+		int				iLevel;
+	};
+
+	typedef std::list<LevelRef> LevelList;
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	bool				BuildLevel		( HDC hdc, int iLevel );
+	void				ReleaseLevel	( int iLevel );
+	static void			Trim			( );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<DWORD>	m_Source;				// Native pixels, top-down, alpha = coverage
+	int					m_iWidth;
+	int					m_iHeight;
+	CMaskedImage		*m_pLevels[LEVEL_COUNT];
+	LevelList::iterator	m_LruPos[LEVEL_COUNT];
+
+	static LevelList	s_Lru;					// Most recently drawn first
+	static size_t		s_uMemoryUsed;
+	static size_t		s_uMemoryBudget;
+};
+
+#endif // _SPRITEPYRAMID_H_
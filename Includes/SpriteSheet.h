@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// File: SpriteSheet.h
+//
+// Desc: Sprite sheet metadata. A sheet file lists one frame per line:
+//
+//		frame <left> <top> <width> <height> <duration ms> [<offset x> <offset y> <frame width> <frame height>]
+//
+//	   Lines starting with '#' are comments. Only the frame timing is kept.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SPRITESHEET_H_
+#define _SPRITESHEET_H_
+
+//-----------------------------------------------------------------------------
+// CSpriteSheet Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpriteSheet (Class)
+//-----------------------------------------------------------------------------
+class CSpriteSheet
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpriteSheet();
+	virtual ~CSpriteSheet();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Lines that do not parse are skipped. False if the file can not be
+	// read or has no frame.
+	bool				Load			( const char *szFileName );
+
+	int					GetFrameCount	( ) const { return (int)m_Durations.size(); }
+	int					GetFrameDuration( int iIndex ) const { return m_Durations[iIndex]; }	// Milliseconds
+	int					GetDuration		( ) const;										// All frames, milliseconds
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<int>	m_Durations;
+};
+
+#endif // _SPRITESHEET_H_
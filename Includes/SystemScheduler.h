@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// File: SystemScheduler.h
+//
+// Desc: Runs a frame as a list of systems. Each system says which data it
+//	   reads and which it writes, as bits the owner assigns. Two systems
+//	   conflict if either writes what the other touches; conflicting ones
+//	   keep the order they were added in, the rest may run side by side on
+//	   a job system.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SYSTEMSCHEDULER_H_
+#define _SYSTEMSCHEDULER_H_
+
+//-----------------------------------------------------------------------------
+// CSystemScheduler Specific Includes
+//-----------------------------------------------------------------------------
+#include "JobSystem.h"
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+typedef void (*SYSTEM_FUNC)( void *pContext );
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSystemScheduler (Class)
+// Desc : Systems are added once, which builds the dependency graph as it
+//		goes; Run() then executes every system once. Without a job system
+//		they run one after another in the order added, which is always a
+//		valid order for the graph.
+//-----------------------------------------------------------------------------
+class CSystemScheduler
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSystemScheduler();
+	virtual ~CSystemScheduler();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Returns the system's index. szName must outlive the scheduler.
+	int					AddSystem		( const char *szName, SYSTEM_FUNC pFunc, void *pContext,
+										  uint32_t uReads, uint32_t uWrites );
+	void				Clear			( );
+
+	void				Run				( CJobSystem *pJobs );
+
+	// Timing costs two clock reads per system and run, so it is off unless
+	// asked for.
+	void				SetTiming		( bool bTiming ) { m_bTiming = bTiming; }
+	void				ResetTimings	( );
+
+	int					GetSystemCount	( ) const { return (int)m_Systems.size(); }
+	const char*			GetName			( int iSystem ) const { return m_Systems[iSystem].szName; }
+	double				GetSeconds		( int iSystem ) const { return m_Systems[iSystem].dSeconds; }
+	unsigned long		GetRuns			( int iSystem ) const { return m_Systems[iSystem].ulRuns; }
+
+	// Earlier systems this one has to wait for.
+	int					GetDependencyCount( int iSystem ) const { return m_Systems[iSystem].nDependencies; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct System
+	{
+		const char*			szName;
+		SYSTEM_FUNC			pFunc;
+		void*				pContext;
+		uint32_t			uReads;
+		uint32_t			uWrites;
+		int					nDependencies;
+		std::vector<int>	Dependents;		// Later systems waiting on this one
+		double				dSeconds;
+		unsigned long		ulRuns;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Execute			( int iSystem );
+	static void			SystemJob		( void *pData, size_t iBegin, size_t iEnd );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<System>		m_Systems;
+	std::atomic<int>*		m_pWaiting;		// Dependencies left per system this run
+	size_t					m_nWaiting;
+	bool					m_bTiming;
+
+	CJobSystem*				m_pJobs;		// Only set during a parallel Run()
+	CJobCounter*			m_pRunCounter;
+};
+
+#endif // _SYSTEMSCHEDULER_H_
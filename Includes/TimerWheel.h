@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// File: TimerWheel.h
+//
+// Desc: Hierarchical timing wheel. Timers wait in slots by due tick; the
+//	   first level has one slot per tick, each level above one slot per
+//	   whole turn of the level below. A tick only looks at the slot that
+//	   is due, and a higher slot is emptied into the lower levels once per
+//	   turn, so the cost follows the timers expiring, not the ones waiting.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+//-----------------------------------------------------------------------------
+// CTimerWheel Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+typedef void (*TIMER_FUNC)( void *pContext, uint64_t uData );
+
+const int TIMER_WHEEL_BITS		= 6;						// 64 slots per level
+const int TIMER_WHEEL_LEVELS	= 5;						// 2^30 ticks ahead
+
+//-----------------------------------------------------------------------------
+// Name : TimerHandle (Struct)
+// Desc : Timer slot plus the generation it had when the timer was set, so
+//		a handle kept past its timer's expiry goes stale harmlessly.
+//-----------------------------------------------------------------------------
+struct TimerHandle
+{
+	unsigned int	uIndex;
+	unsigned int	uGeneration;
+};
+
+const TimerHandle INVALID_TIMER = { 0xFFFFFFFF, 0 };
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTimerWheel (Class)
+// Desc : Time is a tick count that only the owner moves on. Callbacks run
+//		inside Advance(), in the order their timers fall due, and may set
+//		or cancel timers themselves. A timer is always due at least one
+//		tick after it was set.
+//-----------------------------------------------------------------------------
+class CTimerWheel
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CTimerWheel();
+	virtual ~CTimerWheel();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	TimerHandle			Schedule	( uint64_t ulDelay, TIMER_FUNC pFunc, void *pContext, uint64_t uData );
+	TimerHandle			ScheduleAt	( uint64_t ulTick, TIMER_FUNC pFunc, void *pContext, uint64_t uData );
+	bool				Cancel		( TimerHandle handle );
+	bool				IsPending	( TimerHandle handle ) const;
+
+	void				Advance		( uint64_t ulTicks ) { AdvanceTo(m_ulNow + ulTicks); }
+	void				AdvanceTo	( uint64_t ulTick );
+
+	// Drops every timer and starts the clock again at ulTick.
+	void				Clear		( uint64_t ulTick = 0 );
+
+	uint64_t			GetTime		( ) const { return m_ulNow; }
+	size_t				GetPendingCount( ) const { return m_nPending; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+	struct Timer
+	{
+		uint64_t		ulDue;
+		TIMER_FUNC		pFunc;
+		void*			pContext;
+		uint64_t		uData;
+		int				iPrev;			// Slot list links, or free list in iNext
+		int				iNext;
+		int				iSlot;			// -1 while free
+		unsigned int	uGeneration;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	void				Insert		( int iTimer );
+	void				Append		( int iTimer, int iSlot );
+	void				Unlink		( int iTimer );
+	void				Release		( int iTimer );
+	void				Cascade		( int iLevel, int iIndex );
+	void				Tick		( );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<Timer>	m_Timers;
+	int					m_iFree;
+	int					m_Head[(TIMER_WHEEL_LEVELS << TIMER_WHEEL_BITS) + 1];	// Slots, then the due list
+	int					m_Tail[(TIMER_WHEEL_LEVELS << TIMER_WHEEL_BITS) + 1];
+	uint64_t			m_ulNow;
+	size_t				m_nPending;
+};
+
+#endif // _TIMERWHEEL_H_
@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------
+// File: WaveSpawner.h
+//
+// Desc: Enemy waves from text. A wave file names enemy archetypes and
+//	   formations, then lists the waves, one per line:
+//
+//		archetype <name> <script> <pattern> <speed>
+//		formation <name> <line|column|grid|vee|ring> <spacing> [<columns>]
+//		wave <time> <formation> <archetype> <count> <x> <y> [<every> <times> [<more>]]
+//
+//	   Times are seconds of game time and distances pixels. A wave with
+//	   <every> and <times> comes <times> times, <every> seconds apart, with
+//	   <more> enemies each time than the last. Script and pattern are the
+//	   names CSimWorld knows them by. Lines starting with '#' are comments.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _WAVESPAWNER_H_
+#define _WAVESPAWNER_H_
+
+//-----------------------------------------------------------------------------
+// CWaveSpawner Specific Includes
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+enum WAVE_FORMATION_SHAPE
+{
+	FORMATION_LINE,						// A row centred on the wave's point
+	FORMATION_COLUMN,					// Single file, trailing upwards
+	FORMATION_GRID,						// Rows of iColumns, trailing upwards
+	FORMATION_VEE,						// Led from the point, arms trailing upwards
+	FORMATION_RING,						// Round the point, spacing apart
+};
+
+//-----------------------------------------------------------------------------
+// Name : EnemyArchetype (Struct)
+//-----------------------------------------------------------------------------
+struct EnemyArchetype
+{
+	std::string				Name;
+	std::string				Script;
+	std::string				Pattern;
+	float					fSpeed;			// Pixels per second, down
+};
+
+//-----------------------------------------------------------------------------
+// Name : WaveFormation (Struct)
+//-----------------------------------------------------------------------------
+struct WaveFormation
+{
+	std::string				Name;
+	WAVE_FORMATION_SHAPE	Shape;
+	float					fSpacing;
+	int						iColumns;		// Grids only
+};
+
+//-----------------------------------------------------------------------------
+// Name : Wave (Struct)
+//-----------------------------------------------------------------------------
+struct Wave
+{
+	double					dTime;
+	int						iFormation;
+	int						iArchetype;
+	int						nCount;
+	float					x, y;
+	double					dEvery;
+	int						nTimes;			// 1 for a wave that comes once
+	int						nMore;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CWaveSpawner (Class)
+// Desc : Holds one parsed wave file and lays out its formations. When the
+//		waves come is up to the owner.
+//-----------------------------------------------------------------------------
+class CWaveSpawner
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CWaveSpawner();
+	virtual ~CWaveSpawner();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Lines that do not parse, or name something not defined above them,
+	// are skipped. False if no wave is left.
+	bool					Parse		( const std::string& text );
+	void					Clear		( );
+
+	const std::vector<EnemyArchetype>&	GetArchetypes( ) const { return m_Archetypes; }
+	const std::vector<WaveFormation>&	GetFormations( ) const { return m_Formations; }
+	const std::vector<Wave>&			GetWaves	( ) const { return m_Waves; }
+
+	// Enemies in the given coming of a wave, counting from 0.
+	int						GetCount	( const Wave& wave, int iTime ) const;
+
+	// Positions for nCount enemies of a wave, appended to x and y.
+	void					Place		( const Wave& wave, int nCount, std::vector<float>& x, std::vector<float>& y ) const;
+
+	// Whole file into text; false if it can not be read.
+	static bool				ReadFile	( const char *szFileName, std::string& text );
+
+	// Built in stress scenarios, by name, NULL for an unknown one.
+	static const char*		GetPreset	( const char *szName );
+	static const char*		GetPresetName( int iIndex );	// NULL past the last
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	int						FindArchetype( const std::string& name ) const;
+	int						FindFormation( const std::string& name ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<EnemyArchetype>	m_Archetypes;
+	std::vector<WaveFormation>	m_Formations;
+	std::vector<Wave>			m_Waves;
+};
+
+#endif // _WAVESPAWNER_H_
@@ -5,6 +5,17 @@
 
 extern HINSTANCE g_hInst;
 
+// Render scale moves in steps of 1/16 so frame time jitter does not keep
+// reallocating the surface.
+const float RESOLUTION_STEP = 1.0f / 16.0f;
+
+// Frames to wait after a change before lowering or raising the scale again.
+const int RESOLUTION_DROP_DELAY = 15;
+const int RESOLUTION_RAISE_DELAY = 60;
+
+// Only climb back once the frame time is comfortably under budget.
+const float RESOLUTION_HEADROOM = 0.75f;
+
 
 BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 {
@@ -23,14 +34,24 @@ BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 	// with the window one.
 	mhDC = CreateCompatibleDC(hWndDC);
 
-	// Create the backbuffer surface bitmap that is compatible
-	// with the window device context bitmap format. That is
-	// the surface we will render onto.
-	mhSurface = CreateCompatibleBitmap(hWndDC, width, height);
-
 	// Done with window DC.
 	ReleaseDC(hWnd, hWndDC);
 
+	mhSurface = 0;
+	mhOldObject = 0;
+	mpBits = NULL;
+
+	mRenderScale = 1.0f;
+	mDynamicResolution = false;
+	mFrameBudget = 1.0f / 60.0f;
+	mMinScale = 0.5f;
+	mAvgFrameTime = 0.0f;
+	mFramesSinceChange = 0;
+
+	// Create the backbuffer surface. It is a DIB section so its
+	// pixels can be read back for upscaling.
+	createSurface(width, height);
+
 	// At this point, the back buffer surface is uninitialized,
 	// so lets clear it to some non-zero value. Note that it
 	// needs to be non-zero. If it is zero then it will mess
@@ -38,11 +59,120 @@ BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 	reset();
 }
 
-void BackBuffer::reset()
+void BackBuffer::createSurface(int width, int height)
 {
-	// Select the backbuffer bitmap into the DC.
-	mhOldObject = (HBITMAP)SelectObject(mhDC, mhSurface);
+	mSurfaceWidth = width;
+	mSurfaceHeight = height;
+
+	mhSurface = CreateTopDownDIB(mhDC, width, height, (void**)&mpBits);
+
+	// Select the backbuffer bitmap into the DC, remembering
+	// the DC's original bitmap the first time round.
+	HBITMAP hOld = (HBITMAP)SelectObject(mhDC, mhSurface);
+	if (mhOldObject == 0)
+		mhOldObject = hOld;
+
+	if (width == mWidth && height == mHeight)
+	{
+		SetMapMode(mhDC, MM_TEXT);
+	}
+	else
+	{
+		// Keep window coordinates for all drawing; GDI scales
+		// every blit down onto the smaller surface.
+		SetMapMode(mhDC, MM_ANISOTROPIC);
+		SetWindowExtEx(mhDC, mWidth, mHeight, NULL);
+		SetViewportExtEx(mhDC, width, height, NULL);
+		SetStretchBltMode(mhDC, COLORONCOLOR);
+	}
+}
 
+void BackBuffer::releaseSurface()
+{
+	SelectObject(mhDC, mhOldObject);
+	DeleteObject(mhSurface);
+	mhSurface = 0;
+	mpBits = NULL;
+}
+
+void BackBuffer::setRenderScale(float scale)
+{
+	scale = max(RESOLUTION_STEP, min(1.0f, scale));
+
+	int width = max(1, (int)(mWidth * scale + 0.5f));
+	int height = max(1, (int)(mHeight * scale + 0.5f));
+
+	mRenderScale = scale;
+
+	if (width == mSurfaceWidth && height == mSurfaceHeight)
+		return;
+
+	releaseSurface();
+	createSurface(width, height);
+	reset();
+}
+
+void BackBuffer::resize(int width, int height)
+{
+	width = max(1, width);
+	height = max(1, height);
+	if (width == mWidth && height == mHeight)
+		return;
+
+	mWidth = width;
+	mHeight = height;
+
+	releaseSurface();
+	createSurface(max(1, (int)(mWidth * mRenderScale + 0.5f)), max(1, (int)(mHeight * mRenderScale + 0.5f)));
+	reset();
+}
+
+void BackBuffer::setDynamicResolution(bool enable, float frameBudget, float minScale)
+{
+	mDynamicResolution = enable;
+	mFrameBudget = frameBudget;
+	mMinScale = minScale;
+	mAvgFrameTime = frameBudget;
+	mFramesSinceChange = 0;
+
+	if (!enable)
+		setRenderScale(1.0f);
+}
+
+void BackBuffer::adaptResolution(float frameTime)
+{
+	if (!mDynamicResolution || frameTime <= 0.0f)
+		return;
+
+	// Smooth out single slow frames.
+	mAvgFrameTime += (frameTime - mAvgFrameTime) * 0.1f;
+	mFramesSinceChange++;
+
+	float scale = mRenderScale;
+
+	if (mAvgFrameTime > mFrameBudget && mFramesSinceChange >= RESOLUTION_DROP_DELAY)
+	{
+		// Fill cost follows the pixel count, so shrink each side
+		// by the square root of the overshoot.
+		scale = mRenderScale * sqrtf(mFrameBudget / mAvgFrameTime);
+		scale = floorf(scale / RESOLUTION_STEP) * RESOLUTION_STEP;
+	}
+	else if (mAvgFrameTime < mFrameBudget * RESOLUTION_HEADROOM && mFramesSinceChange >= RESOLUTION_RAISE_DELAY)
+	{
+		scale = mRenderScale + RESOLUTION_STEP;
+	}
+
+	scale = max(mMinScale, min(1.0f, scale));
+
+	if (scale != mRenderScale)
+	{
+		setRenderScale(scale);
+		mFramesSinceChange = 0;
+	}
+}
+
+void BackBuffer::reset()
+{
 	// Select a white brush.
 	HBRUSH white = (HBRUSH)GetStockObject(WHITE_BRUSH);
 	HBRUSH oldBrush = (HBRUSH)SelectObject(mhDC, white);
@@ -73,8 +203,7 @@ bool BackBuffer::WriteScore(int aScore)
 
 BackBuffer::~BackBuffer()
 {
-	SelectObject(mhDC, mhOldObject);
-	DeleteObject(mhSurface);
+	releaseSurface();
 	DeleteDC(mhDC);
 }
 
@@ -84,10 +213,32 @@ void BackBuffer::present()
 	// the window.
 	HDC hWndDC = GetDC(mhWnd);
 
-	// Copy the backbuffer contents over to the
-	// window client area.
-	BitBlt(hWndDC, 0, 0, mWidth, mHeight, mhDC, 0, 0, SRCCOPY);
+	if (mSurfaceWidth == mWidth && mSurfaceHeight == mHeight)
+	{
+		// Copy the backbuffer contents over to the
+		// window client area.
+		BitBlt(hWndDC, 0, 0, mWidth, mHeight, mhDC, 0, 0, SRCCOPY);
+	}
+	else
+	{
+		// Make sure GDI has finished drawing into the surface,
+		// then upscale it with the resize engine's fast path.
+		GdiFlush();
+		mPresentBits.resize(mWidth * mHeight);
+		mResampler.Resample(mpBits, mSurfaceWidth, mSurfaceHeight, &mPresentBits[0], mWidth, mHeight);
+
+		BITMAPINFO bi;
+		ZeroMemory(&bi, sizeof(BITMAPINFO));
+		bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bi.bmiHeader.biWidth = mWidth;
+		bi.bmiHeader.biHeight = -mHeight;
+		bi.bmiHeader.biPlanes = 1;
+		bi.bmiHeader.biBitCount = 32;
+		bi.bmiHeader.biCompression = BI_RGB;
+
+		SetDIBitsToDevice(hWndDC, 0, 0, mWidth, mHeight, 0, 0, 0, mHeight, &mPresentBits[0], &bi, DIB_RGB_COLORS);
+	}
 
 	// Always free window DC when done.
 	ReleaseDC(mhWnd, hWndDC);
-}
\ No newline at end of file
+}
@@ -0,0 +1,290 @@
+//-----------------------------------------------------------------------------
+// File: BoxBatch.cpp
+//
+// Desc: Batched box overlap tests with scalar, SSE2 and AVX2 kernels. Each
+//	   kernel compares whole lanes against the query edges and packs the
+//	   results straight into the hit mask, there are no branches per box.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BoxBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include "BoxBatch.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define BOXBATCH_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang only emit vector instructions in functions marked for them;
+// MSVC emits whatever intrinsics it is given.
+#if defined(BOXBATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define BOXBATCH_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define BOXBATCH_TARGET(isa)
+#endif
+
+//-----------------------------------------------------------------------------
+// Static Variables
+//-----------------------------------------------------------------------------
+typedef void (*OVERLAP_KERNEL)( const BoxF& box, const float *pMinX, const float *pMinY,
+								const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask );
+
+static BoxBatchPath		g_Path	 = BOXBATCH_SCALAR;
+static OVERLAP_KERNEL	g_Kernel = NULL;
+
+//-----------------------------------------------------------------------------
+// Kernels
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : OverlapScalar ()
+// Desc : Reference kernel, also used for the tail the vector kernels leave.
+//		Bits are gathered a word at a time; the mask is expected to be
+//		cleared.
+//-----------------------------------------------------------------------------
+static void OverlapScalar( const BoxF& box, const float *pMinX, const float *pMinY,
+						   const float *pMaxX, const float *pMaxY, size_t iStart, size_t n, uint32_t *pMask )
+{
+	for (size_t i = iStart; i < n; )
+	{
+		size_t iEnd = (i | 31) + 1;
+		if (iEnd > n)
+			iEnd = n;
+
+		uint32_t uWord = 0;
+		for (; i < iEnd; i++)
+		{
+			uint32_t uHit = (pMinX[i] < box.fMaxX) & (pMaxX[i] > box.fMinX) &
+							(pMinY[i] < box.fMaxY) & (pMaxY[i] > box.fMinY);
+			uWord |= uHit << (i & 31);
+		}
+
+		pMask[(iEnd - 1) >> 5] |= uWord;
+	}
+}
+
+static void OverlapScalarAll( const BoxF& box, const float *pMinX, const float *pMinY,
+							  const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask )
+{
+	OverlapScalar(box, pMinX, pMinY, pMaxX, pMaxY, 0, n, pMask);
+}
+
+#ifdef BOXBATCH_X86
+//-----------------------------------------------------------------------------
+// Name : OverlapSSE2 ()
+// Desc : Four boxes per compare, a mask word of 32 per outer iteration.
+//		Each compare's four sign bits land at the boxes' own offsets.
+//-----------------------------------------------------------------------------
+BOXBATCH_TARGET("sse2")
+static void OverlapSSE2( const BoxF& box, const float *pMinX, const float *pMinY,
+						 const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask )
+{
+	__m128 qMinX = _mm_set1_ps(box.fMinX), qMinY = _mm_set1_ps(box.fMinY);
+	__m128 qMaxX = _mm_set1_ps(box.fMaxX), qMaxY = _mm_set1_ps(box.fMaxY);
+
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		uint32_t uWord = 0;
+		for (size_t k = 0; k < 32; k += 4)
+		{
+			__m128 hit = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(pMinX + i + k), qMaxX),
+									_mm_cmpgt_ps(_mm_loadu_ps(pMaxX + i + k), qMinX));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(_mm_loadu_ps(pMinY + i + k), qMaxY));
+			hit = _mm_and_ps(hit, _mm_cmpgt_ps(_mm_loadu_ps(pMaxY + i + k), qMinY));
+
+			uWord |= (uint32_t)_mm_movemask_ps(hit) << k;
+		}
+
+		pMask[i >> 5] = uWord;
+	}
+
+	OverlapScalar(box, pMinX, pMinY, pMaxX, pMaxY, i, n, pMask);
+}
+
+//-----------------------------------------------------------------------------
+// Name : OverlapAVX2 ()
+// Desc : Eight boxes per compare, otherwise as OverlapSSE2(). Only AVX
+//		compares are needed, AVX2 is asked for so the path matches the
+//		CPUs it is tuned on.
+//-----------------------------------------------------------------------------
+BOXBATCH_TARGET("avx2")
+static void OverlapAVX2( const BoxF& box, const float *pMinX, const float *pMinY,
+						 const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask )
+{
+	__m256 qMinX = _mm256_set1_ps(box.fMinX), qMinY = _mm256_set1_ps(box.fMinY);
+	__m256 qMaxX = _mm256_set1_ps(box.fMaxX), qMaxY = _mm256_set1_ps(box.fMaxY);
+
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		uint32_t uWord = 0;
+		for (size_t k = 0; k < 32; k += 8)
+		{
+			__m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(pMinX + i + k), qMaxX, _CMP_LT_OQ),
+									   _mm256_cmp_ps(_mm256_loadu_ps(pMaxX + i + k), qMinX, _CMP_GT_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(pMinY + i + k), qMaxY, _CMP_LT_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(pMaxY + i + k), qMinY, _CMP_GT_OQ));
+
+			uWord |= (uint32_t)_mm256_movemask_ps(hit) << k;
+		}
+
+		pMask[i >> 5] = uWord;
+	}
+
+	OverlapScalar(box, pMinX, pMinY, pMaxX, pMaxY, i, n, pMask);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CpuSupports ()
+// Desc : AVX2 also needs the OS to save the wide registers on a switch.
+//-----------------------------------------------------------------------------
+static bool CpuSupports( BoxBatchPath path )
+{
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuid(regs, 1);
+	if (path == BOXBATCH_SSE2)
+		return (regs[3] & (1 << 26)) != 0;
+
+	bool bOSXSave = (regs[2] & (1 << 27)) != 0;
+	bool bAVX	  = (regs[2] & (1 << 28)) != 0;
+	if (!bOSXSave || !bAVX || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	if (path == BOXBATCH_SSE2)
+		return __builtin_cpu_supports("sse2") != 0;
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // BOXBATCH_X86
+
+//-----------------------------------------------------------------------------
+// Name : SelectKernel ()
+//-----------------------------------------------------------------------------
+static void SelectKernel( BoxBatchPath path )
+{
+#ifdef BOXBATCH_X86
+	if (path >= BOXBATCH_AVX2 && CpuSupports(BOXBATCH_AVX2))
+	{
+		g_Path	 = BOXBATCH_AVX2;
+		g_Kernel = OverlapAVX2;
+		return;
+	}
+
+	if (path >= BOXBATCH_SSE2 && CpuSupports(BOXBATCH_SSE2))
+	{
+		g_Path	 = BOXBATCH_SSE2;
+		g_Kernel = OverlapSSE2;
+		return;
+	}
+#endif
+
+	g_Path	 = BOXBATCH_SCALAR;
+	g_Kernel = OverlapScalarAll;
+}
+
+//-----------------------------------------------------------------------------
+// Global Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BoxBatchOverlap ()
+// Desc : Tests/BoxBatchTests.cpp holds every kernel to the scalar one.
+//-----------------------------------------------------------------------------
+size_t BoxBatchOverlap( const BoxF& box, const float *pMinX, const float *pMinY,
+						const float *pMaxX, const float *pMaxY, size_t n, uint32_t *pMask )
+{
+	if (!g_Kernel)
+		SelectKernel(BOXBATCH_AVX2);
+
+	size_t nWords = BOXBATCH_MASK_WORDS(n);
+	memset(pMask, 0, nWords * sizeof(uint32_t));
+	g_Kernel(box, pMinX, pMinY, pMaxX, pMaxY, n, pMask);
+
+	size_t nHits = 0;
+	for (size_t w = 0; w < nWords; w++)
+	{
+		// Bits set in a word, by adding neighbouring bit counts in parallel
+		uint32_t u = pMask[w];
+		u = u - ((u >> 1) & 0x55555555);
+		u = (u & 0x33333333) + ((u >> 2) & 0x33333333);
+		nHits += (((u + (u >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+	}
+
+	return nHits;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BoxBatchOverlapCentred ()
+// Desc : Growing the query box by half the other size turns each box into
+//		a point, which is a box test with min and max the same.
+//-----------------------------------------------------------------------------
+size_t BoxBatchOverlapCentred( const BoxF& box, const float *pX, const float *pY,
+							   float fWidth, float fHeight, size_t n, uint32_t *pMask )
+{
+	BoxF grown = { box.fMinX - fWidth / 2, box.fMinY - fHeight / 2, box.fMaxX + fWidth / 2, box.fMaxY + fHeight / 2 };
+	return BoxBatchOverlap(grown, pX, pY, pX, pY, n, pMask);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BoxBatchCompact ()
+//-----------------------------------------------------------------------------
+size_t BoxBatchCompact( const uint32_t *pMask, size_t n, unsigned int *pIndices )
+{
+	size_t nCount = 0;
+	for (size_t w = 0; w < BOXBATCH_MASK_WORDS(n); w++)
+	{
+		for (uint32_t u = pMask[w]; u; u &= u - 1)
+		{
+			unsigned int uBit = 0;
+			while (!(u & (1u << uBit)))
+				uBit++;
+
+			pIndices[nCount++] = (unsigned int)(w * 32 + uBit);
+		}
+	}
+
+	return nCount;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BoxBatchGetPath ()
+//-----------------------------------------------------------------------------
+BoxBatchPath BoxBatchGetPath( )
+{
+	if (!g_Kernel)
+		SelectKernel(BOXBATCH_AVX2);
+
+	return g_Path;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BoxBatchSetPath ()
+//-----------------------------------------------------------------------------
+BoxBatchPath BoxBatchSetPath( BoxBatchPath path )
+{
+	SelectKernel(path);
+	return g_Path;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BoxBatchPathName ()
+//-----------------------------------------------------------------------------
+const char* BoxBatchPathName( BoxBatchPath path )
+{
+	switch (path)
+	{
+	case BOXBATCH_AVX2:	return "avx2";
+	case BOXBATCH_SSE2:	return "sse2";
+	default:			return "scalar";
+	}
+}
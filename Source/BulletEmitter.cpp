@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// File: BulletEmitter.cpp
+//
+// Desc: Bullet patterns from small descriptors.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBulletEmitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "BulletEmitter.h"
+#include "MathDefs.h"
+
+//-----------------------------------------------------------------------------
+// CBulletEmitter Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBulletEmitter () (Constructor)
+// Desc : CBulletEmitter Class Constructor
+//-----------------------------------------------------------------------------
+CBulletEmitter::CBulletEmitter()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CBulletEmitter () (Destructor)
+// Desc : CBulletEmitter Class Destructor
+//-----------------------------------------------------------------------------
+CBulletEmitter::~CBulletEmitter()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+//-----------------------------------------------------------------------------
+size_t CBulletEmitter::Start( const BulletPattern *pPattern, float x, float y, float fAim, int iOwner,
+							  double dTime, CBulletPool& bullets )
+{
+	size_t nSpawned = Burst(*pPattern, 0, x, y, fAim, iOwner, bullets);
+
+	if (pPattern->nBursts > 1)
+	{
+		Emitter emitter;
+		emitter.pPattern	= pPattern;
+		emitter.x			= x;
+		emitter.y			= y;
+		emitter.fAim		= fAim;
+		emitter.iOwner		= iOwner;
+		emitter.iBurst		= 1;
+		emitter.dNext		= dTime + pPattern->fInterval;
+		m_Emitters.push_back(emitter);
+	}
+
+	return nSpawned;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+// Desc : A finished emitter takes the last one's place, the order is still
+//		the same from run to run.
+//-----------------------------------------------------------------------------
+size_t CBulletEmitter::Update( double dTime, CBulletPool& bullets )
+{
+	size_t nSpawned = 0;
+
+	for (size_t i = 0; i < m_Emitters.size(); )
+	{
+		Emitter& emitter = m_Emitters[i];
+		const BulletPattern& pattern = *emitter.pPattern;
+
+		while (emitter.iBurst < pattern.nBursts && emitter.dNext <= dTime)
+		{
+			nSpawned += Burst(pattern, emitter.iBurst, emitter.x, emitter.y, emitter.fAim, emitter.iOwner, bullets);
+			emitter.iBurst++;
+			emitter.dNext += pattern.fInterval;
+		}
+
+		if (emitter.iBurst >= pattern.nBursts)
+		{
+			m_Emitters[i] = m_Emitters.back();
+			m_Emitters.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	return nSpawned;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Burst () (Static)
+// Desc : Fans put their first and last bullet on the edges of the arc,
+//		rings space theirs a full turn apart.
+//-----------------------------------------------------------------------------
+size_t CBulletEmitter::Burst( const BulletPattern& pattern, int iBurst, float x, float y, float fAim,
+							  int iOwner, CBulletPool& bullets )
+{
+	if (pattern.nBullets <= 0)
+		return 0;
+
+	double dFirst = pattern.fDirection + iBurst * pattern.fTurn;
+	double dStep;
+
+	switch (pattern.Type)
+	{
+	case PATTERN_RING:
+	case PATTERN_SPIRAL:
+		dStep = 360.0 / pattern.nBullets;
+		break;
+
+	case PATTERN_AIMED:
+		dFirst += fAim;
+		[[fallthrough]];	// An aimed volley is a fan
+	default:
+		dStep = 0;
+		if (pattern.nBullets > 1)
+		{
+			dStep	= pattern.fArc / (pattern.nBullets - 1);
+			dFirst	-= pattern.fArc * 0.5;
+		}
+		break;
+	}
+
+	size_t nSpawned = 0;
+	for (int i = 0; i < pattern.nBullets; i++)
+	{
+		double dAngle = DEG2RAD(dFirst + i * dStep);
+		float fDirX = (float)sin(dAngle);
+		float fDirY = (float)cos(dAngle);
+
+		if (bullets.Spawn(x, y, fDirX * pattern.fSpeed, fDirY * pattern.fSpeed, iOwner,
+						  fDirX * pattern.fAccel, fDirY * pattern.fAccel) == INVALID_ENTITY)
+			break;
+		nSpawned++;
+	}
+
+	return nSpawned;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AimAt () (Static)
+//-----------------------------------------------------------------------------
+float CBulletEmitter::AimAt( float fromX, float fromY, float toX, float toY )
+{
+	return (float)RAD2DEG(atan2(toX - fromX, toY - fromY));
+}
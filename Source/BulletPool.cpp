@@ -0,0 +1,325 @@
+//-----------------------------------------------------------------------------
+// File: BulletPool.cpp
+//
+// Desc: Fixed capacity bullet storage with generation checked handles.
+//	   Integrate() has scalar, SSE2 and AVX2 kernels, chosen by the path
+//	   BoxBatch picked for the CPU. None of them fuse multiply and add, so
+//	   all three round the same way and replays agree across machines.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBulletPool Specific Includes
+//-----------------------------------------------------------------------------
+#include "BulletPool.h"
+#include "BoxBatch.h"
+#include <assert.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define BULLETPOOL_X86
+	#include <immintrin.h>
+#endif
+
+#if defined(BULLETPOOL_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define BULLETPOOL_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define BULLETPOOL_TARGET(isa)
+#endif
+
+//-----------------------------------------------------------------------------
+// Integration Kernels
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct BulletArrays
+	{
+		float		*x, *y, *px, *py, *vx, *vy;
+		const float	*ax, *ay;
+	};
+
+	//-------------------------------------------------------------------------
+	// Name : IntegrateScalar ()
+	// Desc : Reference kernel, also used for the tail the vector kernels
+	//		leave.
+	//-------------------------------------------------------------------------
+	void IntegrateScalar( const BulletArrays& b, size_t iStart, size_t n, float dt )
+	{
+		for (size_t i = iStart; i < n; i++)
+		{
+			b.px[i] = b.x[i];
+			b.py[i] = b.y[i];
+			b.vx[i] += b.ax[i] * dt;
+			b.vy[i] += b.ay[i] * dt;
+			b.x[i] += b.vx[i] * dt;
+			b.y[i] += b.vy[i] * dt;
+		}
+	}
+
+#ifdef BULLETPOOL_X86
+	//-------------------------------------------------------------------------
+	// Name : IntegrateSSE2 ()
+	//-------------------------------------------------------------------------
+	BULLETPOOL_TARGET("sse2")
+	void IntegrateSSE2( const BulletArrays& b, size_t n, float dt )
+	{
+		__m128 step = _mm_set1_ps(dt);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(b.x + i), y = _mm_loadu_ps(b.y + i);
+			_mm_storeu_ps(b.px + i, x);
+			_mm_storeu_ps(b.py + i, y);
+
+			__m128 vx = _mm_add_ps(_mm_loadu_ps(b.vx + i), _mm_mul_ps(_mm_loadu_ps(b.ax + i), step));
+			__m128 vy = _mm_add_ps(_mm_loadu_ps(b.vy + i), _mm_mul_ps(_mm_loadu_ps(b.ay + i), step));
+			_mm_storeu_ps(b.vx + i, vx);
+			_mm_storeu_ps(b.vy + i, vy);
+			_mm_storeu_ps(b.x + i, _mm_add_ps(x, _mm_mul_ps(vx, step)));
+			_mm_storeu_ps(b.y + i, _mm_add_ps(y, _mm_mul_ps(vy, step)));
+		}
+
+		IntegrateScalar(b, i, n, dt);
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : IntegrateAVX2 ()
+	//-------------------------------------------------------------------------
+	BULLETPOOL_TARGET("avx2")
+	void IntegrateAVX2( const BulletArrays& b, size_t n, float dt )
+	{
+		__m256 step = _mm256_set1_ps(dt);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(b.x + i), y = _mm256_loadu_ps(b.y + i);
+			_mm256_storeu_ps(b.px + i, x);
+			_mm256_storeu_ps(b.py + i, y);
+
+			__m256 vx = _mm256_add_ps(_mm256_loadu_ps(b.vx + i), _mm256_mul_ps(_mm256_loadu_ps(b.ax + i), step));
+			__m256 vy = _mm256_add_ps(_mm256_loadu_ps(b.vy + i), _mm256_mul_ps(_mm256_loadu_ps(b.ay + i), step));
+			_mm256_storeu_ps(b.vx + i, vx);
+			_mm256_storeu_ps(b.vy + i, vy);
+			_mm256_storeu_ps(b.x + i, _mm256_add_ps(x, _mm256_mul_ps(vx, step)));
+			_mm256_storeu_ps(b.y + i, _mm256_add_ps(y, _mm256_mul_ps(vy, step)));
+		}
+
+		IntegrateScalar(b, i, n, dt);
+	}
+#endif // BULLETPOOL_X86
+}
+
+//-----------------------------------------------------------------------------
+// CBulletPool Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBulletPool () (Constructor)
+// Desc : CBulletPool Class Constructor
+//-----------------------------------------------------------------------------
+CBulletPool::CBulletPool()
+{
+	m_nCount	= 0;
+	m_fLeft		= 0;
+	m_fTop		= 0;
+	m_fRight	= 0;
+	m_fBottom	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CBulletPool () (Destructor)
+// Desc : CBulletPool Class Destructor
+//-----------------------------------------------------------------------------
+CBulletPool::~CBulletPool()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates room for nCapacity bullets. This is the only allocation
+//		the pool makes; existing bullets are dropped.
+//-----------------------------------------------------------------------------
+void CBulletPool::Create( size_t nCapacity )
+{
+	m_X.assign(nCapacity, 0);		m_Y.assign(nCapacity, 0);
+	m_PrevX.assign(nCapacity, 0);	m_PrevY.assign(nCapacity, 0);
+	m_VelX.assign(nCapacity, 0);	m_VelY.assign(nCapacity, 0);
+	m_AccX.assign(nCapacity, 0);	m_AccY.assign(nCapacity, 0);
+	m_Owner.assign(nCapacity, 0);
+	m_InsideMask.assign(BOXBATCH_MASK_WORDS(nCapacity), 0);
+
+	m_SlotToDense.assign(nCapacity, 0);
+	m_SlotGeneration.assign(nCapacity, 0);
+	m_DenseToSlot.assign(nCapacity, 0);
+	m_FreeSlots.reserve(nCapacity);
+
+	m_nCount = 0;
+	m_FreeSlots.clear();
+	for (size_t i = nCapacity; i-- > 0; )
+		m_FreeSlots.push_back((unsigned int)i);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Despawns everything, outstanding handles go stale.
+//-----------------------------------------------------------------------------
+void CBulletPool::Clear( )
+{
+	while (m_nCount > 0)
+		DespawnAt(m_nCount - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Spawn ()
+//-----------------------------------------------------------------------------
+EntityHandle CBulletPool::Spawn( float x, float y, float vx, float vy, int iOwner, float ax, float ay )
+{
+	if (m_FreeSlots.empty())
+		return INVALID_ENTITY;
+
+	unsigned int uSlot = m_FreeSlots.back();
+	m_FreeSlots.pop_back();
+
+	size_t i = m_nCount++;
+	m_X[i]		= m_PrevX[i] = x;
+	m_Y[i]		= m_PrevY[i] = y;
+	m_VelX[i]	= vx;
+	m_VelY[i]	= vy;
+	m_AccX[i]	= ax;
+	m_AccY[i]	= ay;
+	m_Owner[i]	= iOwner;
+
+	m_DenseToSlot[i]		= uSlot;
+	m_SlotToDense[uSlot]	= (unsigned int)i;
+
+	EntityHandle handle = { uSlot, m_SlotGeneration[uSlot] };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Despawn ()
+// Desc : Recycles the bullet if the handle is still current.
+//-----------------------------------------------------------------------------
+bool CBulletPool::Despawn( EntityHandle handle )
+{
+	int iIndex = IndexOf(handle);
+	if (iIndex < 0)
+		return false;
+
+	DespawnAt((size_t)iIndex);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DespawnAt ()
+// Desc : The last live bullet moves into the hole, so loops that despawn as
+//		they go should walk from the back.
+//-----------------------------------------------------------------------------
+void CBulletPool::DespawnAt( size_t iIndex )
+{
+	assert(iIndex < m_nCount);
+
+	size_t iLast = --m_nCount;
+	unsigned int uSlot = m_DenseToSlot[iIndex];
+
+	if (iIndex != iLast)
+	{
+		m_X[iIndex]		= m_X[iLast];		m_Y[iIndex]		= m_Y[iLast];
+		m_PrevX[iIndex]	= m_PrevX[iLast];	m_PrevY[iIndex]	= m_PrevY[iLast];
+		m_VelX[iIndex]	= m_VelX[iLast];	m_VelY[iIndex]	= m_VelY[iLast];
+		m_AccX[iIndex]	= m_AccX[iLast];	m_AccY[iIndex]	= m_AccY[iLast];
+		m_Owner[iIndex]	= m_Owner[iLast];
+
+		m_DenseToSlot[iIndex] = m_DenseToSlot[iLast];
+		m_SlotToDense[m_DenseToSlot[iIndex]] = (unsigned int)iIndex;
+	}
+
+	m_SlotGeneration[uSlot]++;
+	m_FreeSlots.push_back(uSlot);
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsAlive ()
+//-----------------------------------------------------------------------------
+bool CBulletPool::IsAlive( EntityHandle handle ) const
+{
+	return IndexOf(handle) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IndexOf ()
+//-----------------------------------------------------------------------------
+int CBulletPool::IndexOf( EntityHandle handle ) const
+{
+	if (handle.uSlot >= m_SlotGeneration.size() || m_SlotGeneration[handle.uSlot] != handle.uGeneration)
+		return -1;
+
+	// A free slot keeps its bumped generation, so it can not match here
+	return (int)m_SlotToDense[handle.uSlot];
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetBounds ()
+//-----------------------------------------------------------------------------
+void CBulletPool::SetBounds( float fLeft, float fTop, float fRight, float fBottom )
+{
+	m_fLeft		= fLeft;
+	m_fTop		= fTop;
+	m_fRight	= fRight;
+	m_fBottom	= fBottom;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Integrate ()
+//-----------------------------------------------------------------------------
+void CBulletPool::Integrate( float dt )
+{
+	BulletArrays b = { m_X.data(), m_Y.data(), m_PrevX.data(), m_PrevY.data(),
+					   m_VelX.data(), m_VelY.data(), m_AccX.data(), m_AccY.data() };
+
+	switch (BoxBatchGetPath())
+	{
+#ifdef BULLETPOOL_X86
+	case BOXBATCH_AVX2:	IntegrateAVX2(b, m_nCount, dt); break;
+	case BOXBATCH_SSE2:	IntegrateSSE2(b, m_nCount, dt); break;
+#endif
+	default:			IntegrateScalar(b, 0, m_nCount, dt); break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Cull ()
+// Desc : Bullets are boxes of fWidth x fHeight around their position. The
+//		bounds test is one batched box test over all of them; only the
+//		bullets outside are then visited, from the back.
+//-----------------------------------------------------------------------------
+size_t CBulletPool::Cull( float fWidth, float fHeight )
+{
+	if (m_nCount == 0)
+		return 0;
+
+	BoxF bounds = { m_fLeft, m_fTop, m_fRight, m_fBottom };
+	size_t nInside = BoxBatchOverlapCentred(bounds, m_X.data(), m_Y.data(), fWidth, fHeight, m_nCount, m_InsideMask.data());
+	if (nInside == m_nCount)
+		return 0;
+
+	size_t nBefore = m_nCount;
+	for (size_t w = BOXBATCH_MASK_WORDS(nBefore); w-- > 0; )
+	{
+		// Bits past the last bullet count as inside
+		uint32_t uOutside = ~m_InsideMask[w];
+		if (w == (nBefore - 1) >> 5 && (nBefore & 31))
+			uOutside &= (1u << (nBefore & 31)) - 1;
+
+		for (int iBit = 31; uOutside; iBit--)
+		{
+			if (uOutside & (1u << iBit))
+			{
+				DespawnAt(w * 32 + iBit);
+				uOutside &= ~(1u << iBit);
+			}
+		}
+	}
+
+	return nBefore - m_nCount;
+}
@@ -30,9 +30,14 @@ CGameApp::CGameApp()
 	m_hIcon			= NULL;
 	m_hMenu			= NULL;
 	m_pBBuffer		= NULL;
-	m_pPlayer		= NULL;
-	m_pPlayer1		= NULL;
+	m_pPlayerSprite	= NULL;
+	m_pEnemySprite	= NULL;
+	m_pBulletSprite	= NULL;
+	m_pPlayerRotations = NULL;
+	m_fExplosionTime = 0;
 	m_LastFrameRate = 0;
+	m_bSplitView	= false;
+	ZeroMemory( &m_Input, sizeof(m_Input) );
 }
 
 //-----------------------------------------------------------------------------
@@ -157,6 +162,11 @@ int CGameApp::BeginGame()
 //-----------------------------------------------------------------------------
 bool CGameApp::ShutDown()
 {
+	// Keep the session for planes_headless replay
+	if (m_Recording.IsRecording() && m_Recording.GetStepCount() > 0)
+		m_Recording.SaveFile("savegame/replay.rpl");
+	m_Recording.Clear();
+
 	// Release any previously built objects
 	ReleaseObjects ( );
 	
@@ -204,8 +214,6 @@ LRESULT CALLBACK CGameApp::StaticWndProc(HWND hWnd, UINT Message, WPARAM wParam,
 //-----------------------------------------------------------------------------
 LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam )
 {
-	static UINT			fTimer;	
-
 	// Determine message type
 	switch (Message)
 	{
@@ -235,7 +243,17 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 				// Store new viewport sizes
 				m_nViewWidth  = LOWORD( lParam );
 				m_nViewHeight = HIWORD( lParam );
-		
+
+				// Resize what is drawn into and lay the views out again
+				if ( m_pBBuffer && m_nViewWidth > 0 && m_nViewHeight > 0 )
+				{
+					m_pBBuffer->resize( m_nViewWidth, m_nViewHeight );
+
+					HDC hdc = GetDC( m_hWnd );
+					m_Background.Build( hdc, m_nViewWidth, m_nViewHeight );
+					ReleaseDC( m_hWnd, hdc );
+				}
+				LayoutViews();
 			
 			} // End if !Minimized
 
@@ -258,52 +276,46 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			case VK_ESCAPE:
 				PostQuitMessage(0);
 				break;
+			// Actions are queued and handed to the next simulation step
 			case 'Q':
-				fTimer = SetTimer(m_hWnd, 1, 50, NULL);
-				m_pPlayer->Explode();
+				m_Input.Players[0].uActions |= SimPlayerInput::ACTION_SELF_DESTRUCT;
 				break;
 			case 'N':
-				m_pPlayer1->RotateLeft();
+				m_Input.Players[1].uActions |= SimPlayerInput::ACTION_ROTATE_LEFT;
 				break;
 			case 'M':
-				m_pPlayer1->RotateRight();
+				m_Input.Players[1].uActions |= SimPlayerInput::ACTION_ROTATE_RIGHT;
 				break;
 			case 'R':
-				m_pPlayer->RotateLeft();
+				m_Input.Players[0].uActions |= SimPlayerInput::ACTION_ROTATE_LEFT;
 				break;
 			case 'T':
-				m_pPlayer->RotateRight();
+				m_Input.Players[0].uActions |= SimPlayerInput::ACTION_ROTATE_RIGHT;
 				break;
 			case VK_RETURN:
-				fTimer = SetTimer(m_hWnd, 1, 50, NULL);
-				m_pPlayer1->Explode();
+				m_Input.Players[1].uActions |= SimPlayerInput::ACTION_SELF_DESTRUCT;
 				break;
 			case 'F':
-				m_pPlayer->Shoot("player");
+				m_Input.Players[0].uActions |= SimPlayerInput::ACTION_FIRE;
 				break;
 			case 'L':
-				m_pPlayer1->Shoot("player");
+				m_Input.Players[1].uActions |= SimPlayerInput::ACTION_FIRE;
 				break;
 			case '1':
 				saveGame();
+				break;
 			case '2':
 				loadGame();
+				break;
+			case 'V':
+				m_bSplitView = !m_bSplitView;
+				LayoutViews();
+				break;
 			}
 			
 
 			break;
 
-		case WM_TIMER:
-			switch(wParam)
-			{
-			case 1:
-				if(!m_pPlayer->AdvanceExplosion())
-					KillTimer(m_hWnd, 1);
-				if (!m_pPlayer1->AdvanceExplosion())
-					KillTimer(m_hWnd, 1);
-			}
-			break;
-
 		case WM_COMMAND:
 			break;
 
@@ -321,17 +333,49 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildObjects()
 {
+	// One worker per spare core; sprites are resampled with them from here on
+	m_Jobs.Create();
+	CResizableImage::SetJobSystem(&m_Jobs);
+	m_World.SetJobSystem(&m_Jobs);
+
 	m_pBBuffer = new BackBuffer(m_hWnd, m_nViewWidth, m_nViewHeight);
-	m_pPlayer = new CPlayer(m_pBBuffer, 1);
-	m_pPlayer1 = new CPlayer(m_pBBuffer, 1);
-	 noEnemies = 14; 
-	addEnemies(noEnemies);
 
-	//Enemy en(m_pBBuffer);
-	//enemyOnScreen.push_back(en);
+	// Drop the internal resolution (down to half) rather than the frame rate
+	m_pBBuffer->setDynamicResolution(true, 1.0f / 60.0f, 0.5f);
+
+	// Every heading is rotated once here, turning never touches the disk
+	m_pPlayerSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff, 0x00, 0xff));
+	m_pPlayerSprite->setBackBuffer(m_pBBuffer);
+	m_pPlayerRotations = new CRotationCache();
+	if (!m_pPlayerRotations->Build(m_pBBuffer->getDC(), m_pPlayerSprite, SIM_PLAYER_ROTATION_STEPS))
+	{
+		delete m_pPlayerRotations;
+		m_pPlayerRotations = NULL;
+	}
+
+	m_pEnemySprite = new Sprite("data/en.bmp", RGB(0xff, 0x00, 0xff));
+	m_pEnemySprite->setBackBuffer(m_pBBuffer);
+
+	m_pBulletSprite = new Sprite("data/bullet.bmp", RGB(0xff, 0x00, 0xff));
+	m_pBulletSprite->setBackBuffer(m_pBBuffer);
+
+	// Particles draw the explosions; the sheet says how long they last
+	CSpriteSheet explosion;
+	if (!explosion.Load("data/explosion.sheet"))
+		return false;
+	m_fExplosionTime = explosion.GetDuration() / 1000.0f;
+
+	// Hundreds of explosions' worth; more are simply not shown
+	m_Particles.Create(32768);
 
+	// Background layers, back to front. More layers can be stacked on top
+	// with a colour key, e.g. AddLayer("data/clouds.bmp", hdc, 90.0f, RGB(0xff, 0x00, 0xff)).
+	HDC hdc = GetDC(m_hWnd);
+	bool bLoaded = m_Background.AddLayer("data/background.bmp", hdc, 40.0f)
+				&& m_Background.Build(hdc, m_nViewWidth, m_nViewHeight);
+	ReleaseDC(m_hWnd, hdc);
 
-	if(!m_imgBackground.LoadBitmapFromFile("data/background.bmp", GetDC(m_hWnd)))
+	if(!bLoaded)
 		return false;
 
 	// Success!
@@ -344,9 +388,39 @@ bool CGameApp::BuildObjects()
 //-----------------------------------------------------------------------------
 void CGameApp::SetupGameState()
 {
-	m_pPlayer->Position() = Vec2(100, 500);
-	m_pPlayer1->Position() = Vec2(300, 500);
-
+	// Collision sizes come from the sprites, the play area is the screen
+	SimConfig config;
+	config.dWidth				= GetSystemMetrics(SM_CXSCREEN);
+	config.dHeight				= GetSystemMetrics(SM_CYSCREEN);
+	config.dPlayerWidth			= m_pPlayerSprite->width();
+	config.dPlayerHeight		= m_pPlayerSprite->height();
+	config.dEnemyWidth			= m_pEnemySprite->width();
+	config.dEnemyHeight			= m_pEnemySprite->height();
+	config.dBulletWidth			= m_pBulletSprite->width();
+	config.dBulletHeight		= m_pBulletSprite->height();
+	config.fExplosionTime		= m_fExplosionTime;
+
+	// Enemies come in the waves of the data file, or the classic rows without it
+	CWaveSpawner::ReadFile("data/waves.txt", config.Waves);
+
+	// Hits are pixel accurate; any mask that fails to build falls back to
+	// the sprite's rectangle
+	std::vector<CCollisionMask> playerMasks;
+	CCollisionMask enemyMask, bulletMask;
+	if (m_pPlayerRotations)
+		playerMasks = m_pPlayerRotations->GetCollisionMasks();
+	m_pEnemySprite->getCollisionMask(enemyMask);
+	m_pBulletSprite->getCollisionMask(bulletMask);
+	m_World.SetCollisionMasks(playerMasks, enemyMask, bulletMask);
+	m_Recording.SetCollisionMasks(playerMasks, enemyMask, bulletMask);
+
+	config.uSeed = (unsigned int)time(NULL);
+	m_World.Reset(config);
+	m_Recording.Begin(config, SIM_DEFAULT_STEP_RATE);
+	LayoutViews();
+
+	m_StepLoop.SetStepRate(SIM_DEFAULT_STEP_RATE);
+	m_StepLoop.Reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -356,17 +430,24 @@ void CGameApp::SetupGameState()
 //-----------------------------------------------------------------------------
 void CGameApp::ReleaseObjects( )
 {
-	if(m_pPlayer != NULL)
-	{
-		delete m_pPlayer;
-		m_pPlayer = NULL;
-	}
+	delete m_pPlayerSprite;
+	delete m_pEnemySprite;
+	delete m_pBulletSprite;
+	delete m_pPlayerRotations;
+	m_pPlayerSprite		= NULL;
+	m_pEnemySprite		= NULL;
+	m_pBulletSprite		= NULL;
+	m_pPlayerRotations	= NULL;
 
 	if(m_pBBuffer != NULL)
 	{
 		delete m_pBBuffer;
 		m_pBBuffer = NULL;
 	}
+
+	CResizableImage::SetJobSystem(NULL);
+	m_World.SetJobSystem(NULL);
+	m_Jobs.Release();
 }
 
 //-----------------------------------------------------------------------------
@@ -389,33 +470,23 @@ void CGameApp::FrameAdvance()
 	if ( m_LastFrameRate != m_Timer.GetFrameRate() )
 	{
 		m_LastFrameRate = m_Timer.GetFrameRate( FrameRate, 50 );
-		sprintf_s( TitleBuffer, _T("Game : %s	Lives: %d-%d		Score: Player1:%d Player2:%d "), FrameRate, m_pPlayer->GetLives(), m_pPlayer1->GetLives(), m_pPlayer->GetScore(), m_pPlayer1->GetScore());
+		sprintf_s( TitleBuffer, _T("Game : %s (%d%%)	Lives: %d-%d		Score: Player1:%d Player2:%d "), FrameRate, (int)(m_pBBuffer->getRenderScale() * 100.0f), m_World.GetPlayer(0).iLives, m_World.GetPlayer(1).iLives, m_World.GetPlayer(0).iScore, m_World.GetPlayer(1).iScore);
 		SetWindowText( m_hWnd, TitleBuffer );
-		
-		if (!m_pPlayer->GetLives()) {
-			::MessageBox(m_hWnd, "Second  Wins", "Game over", MB_OK);
-			::PostQuitMessage(0);
-		}
-		else if (!m_pPlayer1->GetLives()) {
-			::MessageBox(m_hWnd, "First  Wins", "Game over", MB_OK);
-			::PostQuitMessage(0);
-		}
 
 	} // End if Frame Rate Altered
 
-	
-
-
 	// Poll & Process input devices
 	ProcessInput();
 
-	// Animate the game objects
+	// Step the simulation and present what happened
 	AnimateObjects();
-
-	removeDead();
+	ProcessEvents();
 
 	// Drawing the game objects
 	DrawObjects();
+
+	// Trade resolution for frame time when over budget
+	m_pBBuffer->adaptResolution(m_Timer.GetTimeElapsed());
 }
 
 //-----------------------------------------------------------------------------
@@ -425,33 +496,26 @@ void CGameApp::FrameAdvance()
 void CGameApp::ProcessInput( )
 {
 	static UCHAR pKeyBuffer[ 256 ];
-	ULONG		Direction = 0;
-	ULONG		DirectionP2 = 0;
 	POINT		CursorPos;
-	float		X = 0.0f, Y = 0.0f;
 
 	// Retrieve keyboard state
 	if ( !GetKeyboardState( pKeyBuffer ) ) return;
 
-	// Check the relevant keys
-	if ( pKeyBuffer[ VK_UP	] & 0xF0 ) Direction |= CPlayer::DIR_FORWARD;
-	if ( pKeyBuffer[ VK_DOWN  ] & 0xF0 ) Direction |= CPlayer::DIR_BACKWARD;
-	if ( pKeyBuffer[ VK_LEFT  ] & 0xF0 ) Direction |= CPlayer::DIR_LEFT;
-	if ( pKeyBuffer[ VK_RIGHT ] & 0xF0 ) Direction |= CPlayer::DIR_RIGHT;
+	// Check the relevant keys, arrows steer the second player
+	unsigned int& Direction	= m_Input.Players[1].uMove;
+	unsigned int& DirectionP2	= m_Input.Players[0].uMove;
+	Direction = 0;
+	DirectionP2 = 0;
 
-	if (pKeyBuffer['W'] & 0xF0) DirectionP2 |= CPlayer::DIR_FORWARD;
-	if (pKeyBuffer['S'] & 0xF0) DirectionP2 |= CPlayer::DIR_BACKWARD;
-	if (pKeyBuffer['A'] & 0xF0) DirectionP2 |= CPlayer::DIR_LEFT;
-	if (pKeyBuffer['D'] & 0xF0) DirectionP2 |= CPlayer::DIR_RIGHT;
+	if ( pKeyBuffer[ VK_UP	] & 0xF0 ) Direction |= SimPlayerInput::MOVE_FORWARD;
+	if ( pKeyBuffer[ VK_DOWN  ] & 0xF0 ) Direction |= SimPlayerInput::MOVE_BACKWARD;
+	if ( pKeyBuffer[ VK_LEFT  ] & 0xF0 ) Direction |= SimPlayerInput::MOVE_LEFT;
+	if ( pKeyBuffer[ VK_RIGHT ] & 0xF0 ) Direction |= SimPlayerInput::MOVE_RIGHT;
 
-	
-	// Move the player
-	
-	m_pPlayer1->Move(Direction);
-	m_pPlayer->Move(DirectionP2);
-	for (auto enemy : m_enemies) {
-		enemy->MoveEnemy(CPlayer::DIR_BACKWARD);
-	}
+	if (pKeyBuffer['W'] & 0xF0) DirectionP2 |= SimPlayerInput::MOVE_FORWARD;
+	if (pKeyBuffer['S'] & 0xF0) DirectionP2 |= SimPlayerInput::MOVE_BACKWARD;
+	if (pKeyBuffer['A'] & 0xF0) DirectionP2 |= SimPlayerInput::MOVE_LEFT;
+	if (pKeyBuffer['D'] & 0xF0) DirectionP2 |= SimPlayerInput::MOVE_RIGHT;
 
 
 	// Now process the mouse (if the button is pressed)
@@ -469,42 +533,107 @@ void CGameApp::ProcessInput( )
 	} // End if Captured
 }
 
-short int CGameApp::Sprite_Collide(Sprite * p1, Sprite * p2) {
+//-----------------------------------------------------------------------------
+// Name : AnimateObjects () (Private)
+// Desc : Runs as many fixed simulation steps as the real time since the
+//		last frame covers, with the input gathered since then.
+//-----------------------------------------------------------------------------
+void CGameApp::AnimateObjects()
+{
+	int iSteps = m_StepLoop.Advance(m_Timer.GetRawTimeElapsed());
 
-	RECT r;
-	r.left = p1->mPosition.x - p1->width() / 2;
-	r.right = p1->mPosition.x + p1->width() / 2;
-	r.top = p1->mPosition.y - p1->height() / 2;
-	r.bottom = p1->mPosition.y + p1->height() / 2;
+	for (int i = 0; i < iSteps; i++)
+	{
+		if (m_Recording.IsRecording())
+			m_Recording.Add(m_Input);
+		m_World.Step(m_Input, (float)m_StepLoop.GetStepTime());
 
-	RECT r2;
-	r2.left = p2->mPosition.x - p2->width() / 2;
-	r2.right = p2->mPosition.x + p2->width() / 2;
-	r2.top = p2->mPosition.y - p2->height() / 2;
-	r2.bottom = p2->mPosition.y + p2->height() / 2;
+		// Actions are one-shot, they wait for a step if none ran this frame
+		for (int j = 0; j < SIM_PLAYER_COUNT; j++)
+			m_Input.Players[j].uActions = 0;
+	}
 
+	m_Background.Update(m_Timer.GetTimeElapsed());
+	m_Particles.Update(m_Timer.GetTimeElapsed());
+}
 
-	if (r.right > r2.left && r.left < r2.right && r.bottom>r2.top && r.top < r2.bottom) {
-		return true;
-	}
-	if (r.left > r2.right && r.right < r2.left && r.bottom>r2.top && r.top < r2.bottom) {
-		return true;
-	}
+//-----------------------------------------------------------------------------
+// Name : ProcessEvents () (Private)
+// Desc : Plays sounds, sets off explosions and ends the game as the
+//		simulation reports.
+//-----------------------------------------------------------------------------
+void CGameApp::ProcessEvents()
+{
+	// NOTE: for each async sound played Windows creates a thread for you
+	// but only one, so you cannot play multiple sounds at once.
+	// This creation/destruction of threads also leads to bad performance
+	// so this method is not recommanded to be used in complex projects.
+	static const char *szSounds[] =
+	{
+		"data/jet-start.wav",		// SOUND_JET_START
+		"data/jet-stop.wav",		// SOUND_JET_STOP
+		"data/jet-cabin.wav",		// SOUND_JET_CABIN
+		"data/explosion.wav",		// SOUND_EXPLOSION
+	};
+
+	const std::vector<SimEvent>& events = m_World.GetEvents();
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const SimEvent& event = events[i];
 
-	return false;
+		switch (event.Type)
+		{
+		case SimEvent::EVENT_SOUND:
+			PlaySound(szSounds[event.iSound], NULL, SND_FILENAME | SND_ASYNC);
+			break;
 
-};
+		case SimEvent::EVENT_EXPLOSION:
+			m_Particles.Emit(PARTICLE_SMOKE, (float)event.Position.x, (float)event.Position.y);
+			m_Particles.Emit(PARTICLE_EXPLOSION, (float)event.Position.x, (float)event.Position.y);
+			m_Particles.Emit(PARTICLE_SPARKS, (float)event.Position.x, (float)event.Position.y);
+			break;
+
+		case SimEvent::EVENT_GAME_OVER:
+			::MessageBox(m_hWnd, event.iSubject == 1 ? "Second  Wins" : "First  Wins", "Game over", MB_OK);
+			::PostQuitMessage(0);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	m_World.ClearEvents();
+}
 
 //-----------------------------------------------------------------------------
-// Name : AnimateObjects () (Private)
-// Desc : Animates the objects we currently have loaded.
+// Name : LayoutViews () (Private)
+// Desc : Splits the window between the cameras. The single view zooms to
+//		show the whole play area; split, each player's half is at full
+//		size and follows them.
 //-----------------------------------------------------------------------------
-void CGameApp::AnimateObjects()
+void CGameApp::LayoutViews()
 {
-	m_pPlayer->Update(m_Timer.GetTimeElapsed());
-	m_pPlayer1->Update(m_Timer.GetTimeElapsed());
-	for (auto enem : m_enemies) {
-		enem->Update(m_Timer.GetTimeElapsed());
+	const SimConfig& config = m_World.GetConfig();
+	int iWidth	= (int)m_nViewWidth;
+	int iHeight	= (int)m_nViewHeight;
+
+	if (!m_bSplitView)
+	{
+		m_Cameras[0].SetViewport(0, 0, iWidth, iHeight);
+		m_Cameras[0].SetWorldBounds((float)config.dWidth, (float)config.dHeight);
+		m_Cameras[0].Fit();
+		return;
+	}
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		int iLeft	= iWidth * i / SIM_PLAYER_COUNT;
+		int iRight	= iWidth * (i + 1) / SIM_PLAYER_COUNT;
+
+		m_Cameras[i].SetViewport(iLeft, 0, iRight - iLeft, iHeight);
+		m_Cameras[i].SetWorldBounds((float)config.dWidth, (float)config.dHeight);
+		m_Cameras[i].SetZoom(1.0f);
 	}
 }
 
@@ -514,199 +643,129 @@ void CGameApp::AnimateObjects()
 //-----------------------------------------------------------------------------
 void CGameApp::DrawBackground()
 {
-	static int currentY = m_imgBackground.Height();
-
-	static size_t lastTime = ::GetTickCount();
-	size_t currentTime = ::GetTickCount();
+	m_Background.Paint(m_pBBuffer->getDC());
+}
 
-	if (currentTime - lastTime > 250)
-	{
-		lastTime = currentTime;
-		currentY -= 10;
-		if (currentY < 0)
-			currentY = m_imgBackground.Height();
-	}
+void CGameApp::DrawParticles( const CCamera& camera )
+{
+	// Make sure GDI is done with the DIB before touching its bits
+	GdiFlush();
 
-	m_imgBackground.Paint(m_pBBuffer->getDC(), 0, currentY);
+	m_Particles.Draw((uint32_t*)m_pBBuffer->getBits(), m_pBBuffer->surfaceWidth(), m_pBBuffer->surfaceHeight(),
+					 camera, (float)m_pBBuffer->surfaceWidth() / m_pBBuffer->width());
 }
 
-
-void CGameApp::DrawObjects()
+void CGameApp::DrawSprite( Sprite *pSprite, const CCamera& camera, const Vec2& position )
 {
-	static UINT			fTimer;
-	m_pBBuffer->reset();
+	float x, y;
+	camera.WorldToScreen((float)position.x, (float)position.y, x, y);
+	pSprite->mPosition = Vec2(x, y);
+
+	if (camera.GetZoom() == 1.0f)
+		pSprite->draw();
+	else
+		pSprite->drawScaled(camera.GetZoom());
+}
 
-	DrawBackground();
-		
-	for (auto enem : m_enemies)
+void CGameApp::DrawView( const CCamera& camera, double dAlpha )
+{
+	// Nothing spills over into the other player's view
+	HDC hdc = m_pBBuffer->getDC();
+	SaveDC(hdc);
+	IntersectClipRect(hdc, camera.GetViewportX(), camera.GetViewportY(),
+					  camera.GetViewportX() + camera.GetViewportWidth(), camera.GetViewportY() + camera.GetViewportHeight());
+
+	// Whatever is out of view is dropped before it costs a blit
+	float fEnemyHalfWidth	= m_pEnemySprite->width() * 0.5f;
+	float fEnemyHalfHeight	= m_pEnemySprite->height() * 0.5f;
+	const CEntityStore& enemies = m_World.GetEnemies();
+	for (size_t i = 0; i < enemies.Size(); i++)
 	{
-		enem->Draw();
-		enem->frameCounter()++;
+		if (enemies.Flags[i] & ENEMY_EXPLODING)
+			continue;
+
+		Vec2 position = SimLerp(Vec2(enemies.PrevX[i], enemies.PrevY[i]), Vec2(enemies.X[i], enemies.Y[i]), dAlpha);
+		if (camera.IsVisible((float)position.x, (float)position.y, fEnemyHalfWidth, fEnemyHalfHeight))
+			DrawSprite(m_pEnemySprite, camera, position);
 	}
 
 	//Draw Players
-	m_pPlayer->Draw();
-	
-	m_pPlayer1->Draw();
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		const SimPlayer& player = m_World.GetPlayer(i);
+		if (player.bExploding)
+			continue;
 
-	
+		if (m_pPlayerRotations)
+			m_pPlayerSprite->setRotation(m_pPlayerRotations, player.iHeading);
 
-	srand(time(NULL));
+		Vec2 position = SimLerp(player.PrevPosition, player.Position, dAlpha);
+		if (camera.IsVisible((float)position.x, (float)position.y, m_pPlayerSprite->width() * 0.5f, m_pPlayerSprite->height() * 0.5f))
+			DrawSprite(m_pPlayerSprite, camera, position);
+	}
 
-	for (auto enem : m_enemies)
+	float fBulletHalfWidth	= m_pBulletSprite->width() * 0.5f;
+	float fBulletHalfHeight	= m_pBulletSprite->height() * 0.5f;
+	const CBulletPool& bullets = m_World.GetBullets();
+	for (size_t i = 0; i < bullets.Count(); i++)
 	{
-		if (enem->frameCounter() == 1200)
-		{
-			enem->frameCounter() = rand() % 1000;
-			enem->Shoot("enemy");
-		}
+		Vec2 position = SimLerp(Vec2(bullets.PrevX()[i], bullets.PrevY()[i]), Vec2(bullets.X()[i], bullets.Y()[i]), dAlpha);
+		if (camera.IsVisible((float)position.x, (float)position.y, fBulletHalfWidth, fBulletHalfHeight))
+			DrawSprite(m_pBulletSprite, camera, position);
 	}
 
-	for (auto en : m_enemies) {
-		if (Sprite_Collide(en->m_pSprite, m_pPlayer1->m_pSprite)) {
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer1->Explode();
-			m_pPlayer1->m_pSprite->mPosition = Vec2(300, 500);
-			en->Explode();
-			en->m_pSprite->mPosition.x = 100;
-		}
-		if (Sprite_Collide(en->m_pSprite, m_pPlayer->m_pSprite)) {
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer->Explode();
-			m_pPlayer->m_pSprite->mPosition = Vec2(600, 500);
-			en->Explode();
-			en->m_pSprite->mPosition.x = 100;
-			
-		}
-	}
+	DrawParticles(camera);
 
+	RestoreDC(hdc, -1);
+}
 
-	if (Sprite_Collide(m_pPlayer->m_pSprite, m_pPlayer1->m_pSprite)) {
-		fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-		m_pPlayer1->Explode();
-		m_pPlayer1->m_pSprite->mPosition = Vec2(50, 600);
-		m_pPlayer->Explode();
-		m_pPlayer->m_pSprite->mPosition = Vec2(200, 600);
-	}
+void CGameApp::DrawObjects()
+{
+	// Draw between the last two simulation steps
+	double dAlpha = m_StepLoop.GetAlpha();
 
-	for (auto it : bulletsOnScreen) {
-		it.m_pSprite->draw();
-		it.Move();
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer1->m_pSprite)) {
-				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-				m_pPlayer1->Explode();
-				it.m_pSprite->mPosition.x = -100;
-				m_pPlayer->IncreaseScore();
-				m_pPlayer1->m_pSprite->mPosition = Vec2(50, 600);
-		}
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer->m_pSprite)) {
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer->Explode();
-			it.m_pSprite->mPosition.x = -100;
-			m_pPlayer1->IncreaseScore();
-			m_pPlayer->m_pSprite->mPosition = Vec2(200, 600);
-			
-		}
+	m_pBBuffer->reset();
 
-		for (auto en : m_enemies) {
-			if (Sprite_Collide(it.m_pSprite, en->m_pSprite)) {
-				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-				en->Explode();
-				en->m_pSprite->mPosition.x = -100;
-				it.m_pSprite->mPosition.x = 100;
-				m_pPlayer->IncreaseScore();
-				m_pPlayer1->IncreaseScore();
-			}
-			
-		}
+	DrawBackground();
 
+	if (!m_bSplitView)
+	{
+		DrawView(m_Cameras[0], dAlpha);
 	}
-	for (auto it : bulletsOnScreen1) {
-		it.m_pSprite->draw();
-		it.EnemyBullet();
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer1->m_pSprite)) {
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer1->Explode();
-			it.m_pSprite->mPosition.y = -100;
-			m_pPlayer1->m_pSprite->mPosition = Vec2(300, 500);
-		}
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer->m_pSprite)) {
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer->Explode();
-			it.m_pSprite->mPosition.y = -100;
-			m_pPlayer->m_pSprite->mPosition = Vec2(100, 500);
+	else
+	{
+		for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		{
+			const SimPlayer& player = m_World.GetPlayer(i);
+			Vec2 position = SimLerp(player.PrevPosition, player.Position, dAlpha);
+
+			m_Cameras[i].LookAt((float)position.x, (float)position.y);
+			DrawView(m_Cameras[i], dAlpha);
 		}
 
+		// Divider between the halves
+		PatBlt(m_pBBuffer->getDC(), m_Cameras[1].GetViewportX() - 1, 0, 2, m_pBBuffer->height(), BLACKNESS);
 	}
 
-	bulletsOnScreen.remove_if([](Bullet c) {
-		return c.m_pSprite->mPosition.y < 10 ? true : false;
-	});
-
 	m_pBBuffer->present();
 }
 
 void CGameApp::saveGame()
 {
 	std::ofstream save("savegame/savegame.save");
-	
-	save << m_pPlayer->Position().x << " " << m_pPlayer->Position().y << " " << m_pPlayer->GetLives() << " ";
-	save << m_pPlayer->GetScore() << "\n";
-	save << m_pPlayer1->Position().x << " " << m_pPlayer1->Position().y << " " << m_pPlayer1->GetLives() << " ";
-	save << m_pPlayer1->GetScore() << "\n";
-
-	save.close();
+	m_World.Save(save);
 }
 
 void CGameApp::loadGame()
 {
 	std::ifstream save("savegame/savegame.save");
-	
-	double cdx, cdy;
-	int livesP1, livesP2, score, noEn;
 
-	save >> cdx >> cdy >> livesP1 >> score;
-	m_pPlayer->Position() = Vec2(cdx, cdy);
-	m_pPlayer->SetScore(score);
-	m_pPlayer->SetLives(livesP1);
-
-	save >> cdx >> cdy >> livesP2 >> score;
-	m_pPlayer1->Position() = Vec2(cdx, cdy);
-	m_pPlayer1->SetScore(score);
-	m_pPlayer1->SetLives(livesP2);
-
-}
-
-void CGameApp::addEnemies(int noEnemies)
-{
-	srand(time(NULL));
-	Vec2 position = Vec2(300, 50);
-
-	for (int it = 0; it != noEnemies; ++it) {
-		m_enemies.push_back(new CPlayer(m_pBBuffer, 2));
-		m_enemies.back()->Position() = position;
-		m_enemies.back()->Velocity() = Vec2(0, 0);
-		m_enemies.back()->frameCounter() = rand() % 1000;
-
-		position.x += 150;
-		if (position.x > GetSystemMetrics(SM_CXSCREEN) - 300) {
-			position.x = 300;
-			position.y += 150;
-		}
-
-	}
-}
-
-
-void CGameApp::removeDead()
-{
-	for (auto enem : m_enemies)
+	// The recording starts from a fresh game, it cannot follow a loaded
+	// one; nothing more is recorded or saved until the next Begin()
+	if (m_World.Load(save))
 	{
-		if (enem->playerIsDead())
-		{
-			m_enemies.remove(enem);
-			break;
-		}
+		m_Recording.Clear();
+		m_Recording.Stop();
+		m_Particles.Clear();
 	}
 }
-
@@ -42,6 +42,8 @@ CTimer::CTimer()
 	m_FrameRate			= 0;
 	m_FPSFrameCount		= 0;
 	m_FPSTimeElapsed	= 0.0f;
+	m_TimeElapsed		= 0.0f;
+	m_RawTimeElapsed	= 0.0f;
 }
 
 //-----------------------------------------------------------------------------
@@ -107,6 +109,7 @@ void CTimer::Tick( float fLockFPS )
 
 	// Save current frame time
 	m_LastTime = m_CurrentTime;
+	m_RawTimeElapsed = fTimeElapsed;
 
 	// Filter out values wildly different from current average
 	if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  )
@@ -164,3 +167,13 @@ float CTimer::GetTimeElapsed() const
 {
 	return m_TimeElapsed;
 }
+
+//-----------------------------------------------------------------------------
+// Name : GetRawTimeElapsed () 
+// Desc : Returns the measured time of the last frame, without the averaging
+//		applied by GetTimeElapsed. Summed over frames it matches wall time.
+//-----------------------------------------------------------------------------
+float CTimer::GetRawTimeElapsed() const
+{
+	return m_RawTimeElapsed;
+}
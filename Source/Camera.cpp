@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------
+// File: Camera.cpp
+//
+// Desc: World to viewport transform, zoom and view bounds.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCamera Specific Includes
+//-----------------------------------------------------------------------------
+#include "Camera.h"
+#include <math.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const float		MIN_ZOOM	= 1.0f / 16.0f;
+	const float		MAX_ZOOM	= 16.0f;
+}
+
+//-----------------------------------------------------------------------------
+// CCamera Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCamera () (Constructor)
+// Desc : CCamera Class Constructor
+//-----------------------------------------------------------------------------
+CCamera::CCamera()
+{
+	m_iViewportX		= 0;
+	m_iViewportY		= 0;
+	m_iViewportWidth	= 1;
+	m_iViewportHeight	= 1;
+	m_fWorldWidth		= 1;
+	m_fWorldHeight		= 1;
+	m_fZoom				= 1;
+	m_fCentreX			= 0;
+	m_fCentreY			= 0;
+	Update();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCamera () (Destructor)
+// Desc : CCamera Class Destructor
+//-----------------------------------------------------------------------------
+CCamera::~CCamera()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetViewport ()
+//-----------------------------------------------------------------------------
+void CCamera::SetViewport( int x, int y, int iWidth, int iHeight )
+{
+	m_iViewportX		= x;
+	m_iViewportY		= y;
+	m_iViewportWidth	= std::max(1, iWidth);
+	m_iViewportHeight	= std::max(1, iHeight);
+	Update();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetWorldBounds ()
+//-----------------------------------------------------------------------------
+void CCamera::SetWorldBounds( float fWidth, float fHeight )
+{
+	m_fWorldWidth	= std::max(1.0f, fWidth);
+	m_fWorldHeight	= std::max(1.0f, fHeight);
+	Update();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetZoom ()
+//-----------------------------------------------------------------------------
+void CCamera::SetZoom( float fZoom )
+{
+	m_fZoom = std::min(MAX_ZOOM, std::max(MIN_ZOOM, fZoom));
+	Update();
+}
+
+//-----------------------------------------------------------------------------
+// Name : LookAt ()
+//-----------------------------------------------------------------------------
+void CCamera::LookAt( float x, float y )
+{
+	m_fCentreX = x;
+	m_fCentreY = y;
+	Update();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Fit ()
+//-----------------------------------------------------------------------------
+void CCamera::Fit( )
+{
+	m_fCentreX = m_fWorldWidth * 0.5f;
+	m_fCentreY = m_fWorldHeight * 0.5f;
+	SetZoom(std::min(m_iViewportWidth / m_fWorldWidth, m_iViewportHeight / m_fWorldHeight));
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update () (Private)
+// Desc : Places the view on the asked for centre, moved back inside the
+//		play area on each axis it fits, then derives the transform from it.
+//-----------------------------------------------------------------------------
+void CCamera::Update( )
+{
+	float fHalfWidth	= m_iViewportWidth * 0.5f / m_fZoom;
+	float fHalfHeight	= m_iViewportHeight * 0.5f / m_fZoom;
+	float fCentreX		= m_fCentreX, fCentreY = m_fCentreY;
+
+	if (fHalfWidth * 2 >= m_fWorldWidth)
+		fCentreX = m_fWorldWidth * 0.5f;
+	else
+		fCentreX = std::min(m_fWorldWidth - fHalfWidth, std::max(fHalfWidth, fCentreX));
+
+	if (fHalfHeight * 2 >= m_fWorldHeight)
+		fCentreY = m_fWorldHeight * 0.5f;
+	else
+		fCentreY = std::min(m_fWorldHeight - fHalfHeight, std::max(fHalfHeight, fCentreY));
+
+	m_fViewLeft		= fCentreX - fHalfWidth;
+	m_fViewTop		= fCentreY - fHalfHeight;
+	m_fViewRight	= fCentreX + fHalfWidth;
+	m_fViewBottom	= fCentreY + fHalfHeight;
+
+	// Whole pixels, so sprites do not shimmer as the view moves
+	m_fOffsetX		= floorf(m_iViewportX - m_fViewLeft * m_fZoom);
+	m_fOffsetY		= floorf(m_iViewportY - m_fViewTop * m_fZoom);
+}
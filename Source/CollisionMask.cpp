@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.cpp
+//
+// Desc: One bit per pixel opacity masks for pixel accurate collisions.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "CollisionMask.h"
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask () (Constructor)
+// Desc : CCollisionMask Class Constructor
+//-----------------------------------------------------------------------------
+CCollisionMask::CCollisionMask()
+{
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iRowWords	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCollisionMask () (Destructor)
+// Desc : CCollisionMask Class Destructor
+//-----------------------------------------------------------------------------
+CCollisionMask::~CCollisionMask()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Packs the solid pixels. Padding bits past the width stay clear.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::Create( const uint32_t *pPixels, int iWidth, int iHeight, uint32_t uSolidMask )
+{
+	Release();
+
+	if (!pPixels || iWidth <= 0 || iHeight <= 0)
+		return false;
+
+	m_iWidth	= iWidth;
+	m_iHeight	= iHeight;
+	m_iRowWords	= (iWidth + 63) / 64;
+	m_Bits.assign((size_t)m_iRowWords * iHeight, 0);
+
+	for (int y = 0; y < iHeight; y++)
+	{
+		uint64_t *pRow = &m_Bits[(size_t)y * m_iRowWords];
+		const uint32_t *pSrc = pPixels + (size_t)y * iWidth;
+
+		for (int x = 0; x < iWidth; x++)
+		{
+			if (pSrc[x] & uSolidMask)
+				pRow[x >> 6] |= (uint64_t)1 << (x & 63);
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+//-----------------------------------------------------------------------------
+void CCollisionMask::Release( )
+{
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iRowWords	= 0;
+	m_Bits.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsSolid ()
+// Desc : Outside the mask counts as empty.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::IsSolid( int x, int y ) const
+{
+	if (x < 0 || y < 0 || x >= m_iWidth || y >= m_iHeight)
+		return false;
+
+	return ((m_Bits[(size_t)y * m_iRowWords + (x >> 6)] >> (x & 63)) & 1) != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetSolidCount ()
+//-----------------------------------------------------------------------------
+size_t CCollisionMask::GetSolidCount( ) const
+{
+	size_t nCount = 0;
+	for (size_t i = 0; i < m_Bits.size(); i++)
+	{
+		for (uint64_t u = m_Bits[i]; u; u &= u - 1)
+			nCount++;
+	}
+
+	return nCount;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Overlap () (Static)
+// Desc : Walks the rows both masks cover. On each row both are read as 64
+//		pixel words starting at the same screen column, so one AND tests
+//		64 pixel pairs; the last word of the row is cut to the overlap.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::Overlap( const CCollisionMask& a, int ax, int ay, const CCollisionMask& b, int bx, int by )
+{
+	if (a.IsEmpty() || b.IsEmpty())
+		return false;
+
+	int x0 = ax > bx ? ax : bx;
+	int y0 = ay > by ? ay : by;
+	int x1 = (ax + a.m_iWidth) < (bx + b.m_iWidth) ? ax + a.m_iWidth : bx + b.m_iWidth;
+	int y1 = (ay + a.m_iHeight) < (by + b.m_iHeight) ? ay + a.m_iHeight : by + b.m_iHeight;
+
+	if (x0 >= x1 || y0 >= y1)
+		return false;
+
+	for (int y = y0; y < y1; y++)
+	{
+		for (int x = x0; x < x1; x += 64)
+		{
+			uint64_t uBits = a.GetBits(y - ay, x - ax) & b.GetBits(y - by, x - bx);
+
+			if (x1 - x < 64)
+				uBits &= ((uint64_t)1 << (x1 - x)) - 1;
+
+			if (uBits)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBits () (Private)
+// Desc : 64 pixels of row y starting at column x, which must lie inside the
+//		row. Bits past the end of the row read as clear.
+//-----------------------------------------------------------------------------
+uint64_t CCollisionMask::GetBits( int y, int x ) const
+{
+	const uint64_t *pRow = &m_Bits[(size_t)y * m_iRowWords];
+	int iWord	= x >> 6;
+	int iShift	= x & 63;
+
+	uint64_t uBits = pRow[iWord] >> iShift;
+	if (iShift && iWord + 1 < m_iRowWords)
+		uBits |= pRow[iWord + 1] << (64 - iShift);
+
+	return uBits;
+}
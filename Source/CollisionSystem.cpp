@@ -0,0 +1,332 @@
+//-----------------------------------------------------------------------------
+// File: CollisionSystem.cpp
+//
+// Desc: Layered collision detection. Rules with a small layer on either
+//	   side (the players) use the batched box kernel, two large layers go
+//	   through the uniform grid. Either way the candidates get the swept
+//	   box test and, where both sides have one, the pixel masks.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCollisionSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "CollisionSystem.h"
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int		MAX_SWEEP_SAMPLES	= 64;		// Pixel mask tests along one swept hit
+	const float		BOUNDS_SLACK		= 1.0f;		// Pixels, so float bounds only err towards a candidate
+}
+
+//-----------------------------------------------------------------------------
+// Name : HitBefore () (Static)
+// Desc : Hit order: earliest first, ties broken so the order never depends
+//		on how the candidates were found.
+//-----------------------------------------------------------------------------
+static bool HitBefore( const CollisionHit& a, const CollisionHit& b )
+{
+	if (a.dTime != b.dTime) return a.dTime < b.dTime;
+	if (a.iRule != b.iRule) return a.iRule < b.iRule;
+	if (a.uA != b.uA)		return a.uA < b.uA;
+	return a.uB < b.uB;
+}
+
+//-----------------------------------------------------------------------------
+// CCollisionSystem Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCollisionSystem () (Constructor)
+// Desc : CCollisionSystem Class Constructor
+//-----------------------------------------------------------------------------
+CCollisionSystem::CCollisionSystem()
+{
+	m_iGridLayer = -1;
+	for (int i = 0; i < COLLISION_MAX_LAYERS; i++)
+		m_bLayerUsed[i] = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCollisionSystem () (Destructor)
+// Desc : CCollisionSystem Class Destructor
+//-----------------------------------------------------------------------------
+CCollisionSystem::~CCollisionSystem()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddRule ()
+//-----------------------------------------------------------------------------
+int CCollisionSystem::AddRule( int iLayerA, int iLayerB )
+{
+	assert(iLayerA >= 0 && iLayerA < COLLISION_MAX_LAYERS);
+	assert(iLayerB >= 0 && iLayerB < COLLISION_MAX_LAYERS);
+
+	Rule rule = { iLayerA, iLayerB };
+	m_Rules.push_back(rule);
+
+	m_bLayerUsed[iLayerA] = true;
+	m_bLayerUsed[iLayerB] = true;
+
+	return (int)m_Rules.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Drops last step's proxies and hits, keeping the memory.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::Clear( )
+{
+	for (int i = 0; i < COLLISION_MAX_LAYERS; i++)
+	{
+		if (!IsLayerUsed(i))
+			continue;
+
+		Layer& layer = m_Layers[i];
+		layer.Proxies.clear();
+		layer.MinX.clear();	layer.MinY.clear();
+		layer.MaxX.clear();	layer.MaxY.clear();
+		layer.Claimed.clear();
+	}
+
+	m_Hits.clear();
+	m_iGridLayer = -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Proxies on layers no rule mentions are dropped straight away.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::Add( int iLayer, const CollisionProxy& proxy )
+{
+	if (!IsLayerUsed(iLayer))
+		return;
+
+	Layer& layer = m_Layers[iLayer];
+	double hw = proxy.dWidth / 2, hh = proxy.dHeight / 2;
+
+	layer.Proxies.push_back(proxy);
+	layer.MinX.push_back((float)((proxy.From.x < proxy.To.x ? proxy.From.x : proxy.To.x) - hw));
+	layer.MinY.push_back((float)((proxy.From.y < proxy.To.y ? proxy.From.y : proxy.To.y) - hh));
+	layer.MaxX.push_back((float)((proxy.From.x > proxy.To.x ? proxy.From.x : proxy.To.x) + hw));
+	layer.MaxY.push_back((float)((proxy.From.y > proxy.To.y ? proxy.From.y : proxy.To.y) + hh));
+	layer.Claimed.push_back(0);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Detect ()
+// Desc : Runs every rule, then sorts the hits.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::Detect( )
+{
+	m_Hits.clear();
+
+	for (int r = 0; r < (int)m_Rules.size(); r++)
+	{
+		const Rule& rule = m_Rules[r];
+		if (m_Layers[rule.iLayerA].Proxies.empty() || m_Layers[rule.iLayerB].Proxies.empty())
+			continue;
+
+		size_t nA = m_Layers[rule.iLayerA].Proxies.size();
+		size_t nB = m_Layers[rule.iLayerB].Proxies.size();
+		if (nA <= (size_t)COLLISION_BATCH_LIMIT || nB <= (size_t)COLLISION_BATCH_LIMIT)
+			DetectBatched(r);
+		else
+			DetectGrid(r);
+	}
+
+	std::sort(m_Hits.begin(), m_Hits.end(), HitBefore);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Claim ()
+//-----------------------------------------------------------------------------
+bool CCollisionSystem::Claim( const CollisionHit& hit )
+{
+	const Rule& rule = m_Rules[hit.iRule];
+	unsigned char& a = m_Layers[rule.iLayerA].Claimed[hit.uA];
+	unsigned char& b = m_Layers[rule.iLayerB].Claimed[hit.uB];
+
+	if (a || b)
+		return false;
+
+	a = b = 1;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DetectBatched () (Private)
+// Desc : Each proxy of the smaller layer against the whole of the other at
+//		once. Within a layer each pair is tested once, higher index first.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::DetectBatched( int iRule )
+{
+	const Rule& rule = m_Rules[iRule];
+	bool bQueryA = m_Layers[rule.iLayerA].Proxies.size() < m_Layers[rule.iLayerB].Proxies.size();
+	const Layer& query = m_Layers[bQueryA ? rule.iLayerA : rule.iLayerB];
+	const Layer& batch = m_Layers[bQueryA ? rule.iLayerB : rule.iLayerA];
+	size_t nBatch = batch.Proxies.size();
+
+	m_HitMask.resize(BOXBATCH_MASK_WORDS(nBatch));
+	if (m_Candidates.size() < nBatch)
+		m_Candidates.resize(nBatch);
+
+	for (unsigned int q = 0; q < (unsigned int)query.Proxies.size(); q++)
+	{
+		BoxF box = { query.MinX[q] - BOUNDS_SLACK, query.MinY[q] - BOUNDS_SLACK, query.MaxX[q] + BOUNDS_SLACK, query.MaxY[q] + BOUNDS_SLACK };
+		if (!BoxBatchOverlap(box, &batch.MinX[0], &batch.MinY[0], &batch.MaxX[0], &batch.MaxY[0], nBatch, &m_HitMask[0]))
+			continue;
+
+		size_t nHits = BoxBatchCompact(&m_HitMask[0], nBatch, &m_Candidates[0]);
+		for (size_t c = 0; c < nHits; c++)
+		{
+			unsigned int uA = bQueryA ? q : m_Candidates[c];
+			unsigned int uB = bQueryA ? m_Candidates[c] : q;
+			if (rule.iLayerA == rule.iLayerB && uA <= uB)
+				continue;
+
+			TestPair(iRule, uA, uB);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : DetectGrid () (Private)
+// Desc : The second layer goes into the grid (kept if the last rule used
+//		the same one), and the first looks up the cells its swept boxes
+//		cover.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::DetectGrid( int iRule )
+{
+	const Rule& rule = m_Rules[iRule];
+	const Layer& a = m_Layers[rule.iLayerA];
+	const Layer& b = m_Layers[rule.iLayerB];
+
+	if (m_iGridLayer != rule.iLayerB)
+	{
+		m_Grid.Clear();
+		for (size_t i = 0; i < b.Proxies.size(); i++)
+			m_Grid.Insert((unsigned int)i, b.MinX[i], b.MinY[i], b.MaxX[i], b.MaxY[i]);
+		m_Grid.Build();
+		m_iGridLayer = rule.iLayerB;
+	}
+
+	for (unsigned int uA = 0; uA < (unsigned int)a.Proxies.size(); uA++)
+	{
+		m_Grid.Query(a.MinX[uA] - BOUNDS_SLACK, a.MinY[uA] - BOUNDS_SLACK, a.MaxX[uA] + BOUNDS_SLACK, a.MaxY[uA] + BOUNDS_SLACK, m_Candidates);
+
+		for (size_t c = 0; c < m_Candidates.size(); c++)
+		{
+			unsigned int uB = m_Candidates[c];
+			if (rule.iLayerA == rule.iLayerB && uA <= uB)
+				continue;
+
+			TestPair(iRule, uA, uB);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : TestPair () (Private)
+// Desc : Swept boxes, then the pixel masks sampled at least once per pixel
+//		of relative movement across the span the boxes overlap.
+//-----------------------------------------------------------------------------
+void CCollisionSystem::TestPair( int iRule, unsigned int uA, unsigned int uB )
+{
+	const Rule& rule = m_Rules[iRule];
+	const CollisionProxy& a = m_Layers[rule.iLayerA].Proxies[uA];
+	const CollisionProxy& b = m_Layers[rule.iLayerB].Proxies[uB];
+
+	double dEnter, dExit;
+	if (!Sweep(a.From, a.To, a.dWidth, a.dHeight, b.From, b.To, b.dWidth, b.dHeight, dEnter, dExit))
+		return;
+
+	CollisionHit hit = { dEnter, iRule, uA, uB };
+
+	if (a.pMask && b.pMask)
+	{
+		double dx = (a.To.x - b.To.x) - (a.From.x - b.From.x);
+		double dy = (a.To.y - b.To.y) - (a.From.y - b.From.y);
+		int nSamples = (int)ceil(sqrt(dx * dx + dy * dy) * (dExit - dEnter)) + 1;
+		if (nSamples > MAX_SWEEP_SAMPLES)
+			nSamples = MAX_SWEEP_SAMPLES;
+
+		bool bHit = false;
+		for (int i = 0; i < nSamples && !bHit; i++)
+		{
+			double t = nSamples > 1 ? dEnter + (dExit - dEnter) * i / (nSamples - 1) : dExit;
+			Vec2 pa(a.From.x + (a.To.x - a.From.x) * t, a.From.y + (a.To.y - a.From.y) * t);
+			Vec2 pb(b.From.x + (b.To.x - b.From.x) * t, b.From.y + (b.To.y - b.From.y) * t);
+
+			if (PixelsOverlap(a.pMask, pa, b.pMask, pb))
+			{
+				hit.dTime = t;
+				bHit = true;
+			}
+		}
+
+		if (!bHit)
+			return;
+	}
+
+	m_Hits.push_back(hit);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Sweep () (Static)
+// Desc : Seen from b, a's centre travels a straight line, and the boxes
+//		overlap while that line is inside b grown by a's half size. Clips
+//		the line against both slabs.
+//-----------------------------------------------------------------------------
+bool CCollisionSystem::Sweep( const Vec2& a0, const Vec2& a1, double aw, double ah,
+							  const Vec2& b0, const Vec2& b1, double bw, double bh, double& dEnter, double& dExit )
+{
+	double s[2] = { a0.x - b0.x, a0.y - b0.y };
+	double d[2] = { (a1.x - b1.x) - s[0], (a1.y - b1.y) - s[1] };
+	double h[2] = { (aw + bw) / 2, (ah + bh) / 2 };
+
+	dEnter	= 0;
+	dExit	= 1;
+
+	for (int k = 0; k < 2; k++)
+	{
+		if (d[k] == 0)
+		{
+			// Not moving along this axis, in the slab all step or never
+			if (fabs(s[k]) >= h[k])
+				return false;
+			continue;
+		}
+
+		double t0 = (-h[k] - s[k]) / d[k];
+		double t1 = ( h[k] - s[k]) / d[k];
+		if (t0 > t1)
+		{
+			double t = t0; t0 = t1; t1 = t;
+		}
+
+		if (t0 > dEnter) dEnter = t0;
+		if (t1 < dExit)  dExit	= t1;
+	}
+
+	// Touching is not overlapping, so an empty or zero length span misses
+	return dEnter < dExit;
+}
+
+//-----------------------------------------------------------------------------
+// Name : PixelsOverlap () (Static)
+//-----------------------------------------------------------------------------
+bool CCollisionSystem::PixelsOverlap( const CCollisionMask *pA, const Vec2& a, const CCollisionMask *pB, const Vec2& b )
+{
+	if (!pA || !pB)
+		return true;
+
+	return CCollisionMask::Overlap(*pA, (int)floor(a.x - pA->Width() / 2.0 + 0.5), (int)floor(a.y - pA->Height() / 2.0 + 0.5),
+								   *pB, (int)floor(b.x - pB->Width() / 2.0 + 0.5), (int)floor(b.y - pB->Height() / 2.0 + 0.5));
+}
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.cpp
+//
+// Desc: Struct-of-arrays entity storage with generational handles,
+//	   swap-remove deletion and batch compaction.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// CEntityStore Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CEntityStore () (Constructor)
+// Desc : CEntityStore Class Constructor
+//-----------------------------------------------------------------------------
+CEntityStore::CEntityStore()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CEntityStore () (Destructor)
+// Desc : CEntityStore Class Destructor
+//-----------------------------------------------------------------------------
+CEntityStore::~CEntityStore()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Appends a zeroed entity and returns its handle.
+//-----------------------------------------------------------------------------
+EntityHandle CEntityStore::Create( )
+{
+	unsigned int uSlot;
+	if (!m_FreeSlots.empty())
+	{
+		uSlot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		uSlot = (unsigned int)m_SlotToDense.size();
+		m_SlotToDense.push_back(0);
+		m_SlotGeneration.push_back(0);
+	}
+
+	size_t iIndex = Size();
+	m_SlotToDense[uSlot] = (unsigned int)iIndex;
+	m_DenseToSlot.push_back(uSlot);
+	ResizeComponents(iIndex + 1);
+
+	EntityHandle handle = { uSlot, m_SlotGeneration[uSlot] };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Destroy ()
+// Desc : Removes the entity if the handle is still current.
+//-----------------------------------------------------------------------------
+bool CEntityStore::Destroy( EntityHandle handle )
+{
+	int iIndex = IndexOf(handle);
+	if (iIndex < 0)
+		return false;
+
+	RemoveAt((size_t)iIndex);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveAt ()
+// Desc : Removes by dense index. The last entity moves into the hole, so a
+//		loop removing as it goes should walk from the back.
+//-----------------------------------------------------------------------------
+void CEntityStore::RemoveAt( size_t iIndex )
+{
+	assert(iIndex < Size());
+
+	size_t iLast = Size() - 1;
+	unsigned int uSlot = m_DenseToSlot[iIndex];
+
+	if (iIndex != iLast)
+	{
+		MoveComponents(iLast, iIndex);
+		m_DenseToSlot[iIndex] = m_DenseToSlot[iLast];
+		m_SlotToDense[m_DenseToSlot[iIndex]] = (unsigned int)iIndex;
+	}
+
+	m_DenseToSlot.pop_back();
+	ResizeComponents(iLast);
+
+	m_SlotGeneration[uSlot]++;
+	m_FreeSlots.push_back(uSlot);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveFlagged ()
+// Desc : Removes every entity with any of uFlags set in one pass, sliding
+//		the survivors down over the holes. Each survivor moves once at most
+//		and keeps its order, where removing them one at a time would shuffle
+//		the tail in once per removal.
+//-----------------------------------------------------------------------------
+size_t CEntityStore::RemoveFlagged( unsigned int uFlags )
+{
+	size_t nCount = Size();
+	size_t iTo = 0;
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		unsigned int uSlot = m_DenseToSlot[i];
+
+		if (Flags[i] & uFlags)
+		{
+			m_SlotGeneration[uSlot]++;
+			m_FreeSlots.push_back(uSlot);
+			continue;
+		}
+
+		if (iTo != i)
+		{
+			MoveComponents(i, iTo);
+			m_DenseToSlot[iTo] = uSlot;
+			m_SlotToDense[uSlot] = (unsigned int)iTo;
+		}
+		iTo++;
+	}
+
+	m_DenseToSlot.resize(iTo);
+	ResizeComponents(iTo);
+	return nCount - iTo;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Removes everything. Outstanding handles all go stale.
+//-----------------------------------------------------------------------------
+void CEntityStore::Clear( )
+{
+	for (size_t i = 0; i < m_DenseToSlot.size(); i++)
+	{
+		m_SlotGeneration[m_DenseToSlot[i]]++;
+		m_FreeSlots.push_back(m_DenseToSlot[i]);
+	}
+
+	m_DenseToSlot.clear();
+	ResizeComponents(0);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reserve ()
+//-----------------------------------------------------------------------------
+void CEntityStore::Reserve( size_t nCount )
+{
+	X.reserve(nCount);			Y.reserve(nCount);
+	PrevX.reserve(nCount);		PrevY.reserve(nCount);
+	VelX.reserve(nCount);		VelY.reserve(nCount);
+	Speed.reserve(nCount);
+	SpriteId.reserve(nCount);
+	Flags.reserve(nCount);
+	for (int t = 0; t < ENTITY_TIMER_COUNT; t++)
+		Timer[t].reserve(nCount);
+
+	m_DenseToSlot.reserve(nCount);
+	m_SlotToDense.reserve(nCount);
+	m_SlotGeneration.reserve(nCount);
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsAlive ()
+//-----------------------------------------------------------------------------
+bool CEntityStore::IsAlive( EntityHandle handle ) const
+{
+	return IndexOf(handle) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IndexOf ()
+// Desc : Dense index of a live entity, -1 for stale or invalid handles.
+//-----------------------------------------------------------------------------
+int CEntityStore::IndexOf( EntityHandle handle ) const
+{
+	if (handle.uSlot >= m_SlotGeneration.size() || m_SlotGeneration[handle.uSlot] != handle.uGeneration)
+		return -1;
+
+	return (int)m_SlotToDense[handle.uSlot];
+}
+
+//-----------------------------------------------------------------------------
+// Name : HandleAt ()
+//-----------------------------------------------------------------------------
+EntityHandle CEntityStore::HandleAt( size_t iIndex ) const
+{
+	unsigned int uSlot = m_DenseToSlot[iIndex];
+	EntityHandle handle = { uSlot, m_SlotGeneration[uSlot] };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResizeComponents () (Private)
+//-----------------------------------------------------------------------------
+void CEntityStore::ResizeComponents( size_t nCount )
+{
+	X.resize(nCount);			Y.resize(nCount);
+	PrevX.resize(nCount);		PrevY.resize(nCount);
+	VelX.resize(nCount);		VelY.resize(nCount);
+	Speed.resize(nCount);
+	SpriteId.resize(nCount);
+	Flags.resize(nCount);
+	for (int t = 0; t < ENTITY_TIMER_COUNT; t++)
+		Timer[t].resize(nCount);
+}
+
+//-----------------------------------------------------------------------------
+// Name : MoveComponents () (Private)
+//-----------------------------------------------------------------------------
+void CEntityStore::MoveComponents( size_t iFrom, size_t iTo )
+{
+	X[iTo]		= X[iFrom];			Y[iTo]		= Y[iFrom];
+	PrevX[iTo]	= PrevX[iFrom];		PrevY[iTo]	= PrevY[iFrom];
+	VelX[iTo]	= VelX[iFrom];		VelY[iTo]	= VelY[iFrom];
+	Speed[iTo]	= Speed[iFrom];
+	SpriteId[iTo]	= SpriteId[iFrom];
+	Flags[iTo]		= Flags[iFrom];
+	for (int t = 0; t < ENTITY_TIMER_COUNT; t++)
+		Timer[t][iTo] = Timer[t][iFrom];
+}
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// File: FixedStepLoop.cpp
+//
+// Desc: Fixed timestep accumulator. Real frame time goes in, a whole number
+//	   of simulation steps comes out, plus how far the next step has got so
+//	   rendering can blend between the last two simulation states.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFixedStepLoop Specific Includes
+//-----------------------------------------------------------------------------
+#include "FixedStepLoop.h"
+
+//-----------------------------------------------------------------------------
+// CFixedStepLoop Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFixedStepLoop () (Constructor)
+// Desc : CFixedStepLoop Class Constructor
+//-----------------------------------------------------------------------------
+CFixedStepLoop::CFixedStepLoop( double dStepRate, int iMaxSteps )
+{
+	m_dStepTime = 1.0 / 120.0;
+	m_iMaxSteps = 1;
+
+	SetStepRate(dStepRate);
+	SetMaxSteps(iMaxSteps);
+	Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFixedStepLoop () (Destructor)
+// Desc : CFixedStepLoop Class Destructor
+//-----------------------------------------------------------------------------
+CFixedStepLoop::~CFixedStepLoop()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetStepRate ()
+// Desc : Steps per second. Time already accumulated is kept, so the rate can
+//		be changed between frames.
+//-----------------------------------------------------------------------------
+void CFixedStepLoop::SetStepRate( double dStepsPerSecond )
+{
+	if (dStepsPerSecond > 0)
+		m_dStepTime = 1.0 / dStepsPerSecond;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetMaxSteps ()
+// Desc : Most steps a single frame may run before time is dropped.
+//-----------------------------------------------------------------------------
+void CFixedStepLoop::SetMaxSteps( int iMaxSteps )
+{
+	m_iMaxSteps = iMaxSteps > 0 ? iMaxSteps : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+//-----------------------------------------------------------------------------
+void CFixedStepLoop::Reset( )
+{
+	m_dAccumulator	= 0;
+	m_ulDropped		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Advance ()
+// Desc : Accumulates real time and takes out whole steps.
+//-----------------------------------------------------------------------------
+int CFixedStepLoop::Advance( double dFrameTime )
+{
+	if (dFrameTime > 0)
+		m_dAccumulator += dFrameTime;
+
+	int iSteps = (int)(m_dAccumulator / m_dStepTime);
+
+	// Spiral of death: if we are further behind than we may catch up in one
+	// frame, run the maximum and forget the rest of the backlog.
+	if (iSteps > m_iMaxSteps)
+	{
+		m_ulDropped		+= (unsigned long)(iSteps - m_iMaxSteps);
+		m_dAccumulator	-= m_dStepTime * (iSteps - m_iMaxSteps);
+		iSteps			 = m_iMaxSteps;
+	}
+
+	m_dAccumulator -= m_dStepTime * iSteps;
+	if (m_dAccumulator < 0)
+		m_dAccumulator = 0;
+
+	return iSteps;
+}
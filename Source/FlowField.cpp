@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// File: FlowField.cpp
+//
+// Desc: Flow field built from a two pass chamfer distance transform, so a
+//	   rebuild is a few sweeps over the grid whatever the number of goals.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include "FlowField.h"
+#include <math.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int		STRAIGHT	= 3;			// Chamfer steps, about 1 : sqrt(2)
+	const int		DIAGONAL	= 4;
+	const uint16_t	FAR_AWAY	= 0xFFFF;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RelaxFromRow ()
+// Desc : Lowers each cell of row to its neighbours in the row next to it
+//		plus the step there. No cell depends on another, so it vectorises.
+//-----------------------------------------------------------------------------
+static void RelaxFromRow( uint16_t *row, const uint16_t *next, int w )
+{
+	row[0] = (uint16_t)std::min<int>(row[0], next[0] + STRAIGHT);
+	if (w > 1)
+		row[0] = (uint16_t)std::min<int>(row[0], next[1] + DIAGONAL);
+
+	for (int x = 1; x < w - 1; x++)
+	{
+		int iBest = std::min<int>(row[x], next[x] + STRAIGHT);
+		iBest = std::min<int>(iBest, std::min(next[x - 1], next[x + 1]) + DIAGONAL);
+		row[x] = (uint16_t)iBest;
+	}
+
+	if (w > 1)
+	{
+		int x = w - 1;
+		row[x] = (uint16_t)std::min<int>(row[x], std::min<int>(next[x] + STRAIGHT, next[x - 1] + DIAGONAL));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CFlowField Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFlowField () (Constructor)
+// Desc : CFlowField Class Constructor
+//-----------------------------------------------------------------------------
+CFlowField::CFlowField()
+{
+	m_iColumns		= 0;
+	m_iRows			= 0;
+	m_fCellSize		= 1;
+	m_fInvCellSize	= 1;
+	m_fMaxColumn	= 0;
+	m_fMaxRow		= 0;
+	Create(1, 1, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFlowField () (Destructor)
+// Desc : CFlowField Class Destructor
+//-----------------------------------------------------------------------------
+CFlowField::~CFlowField()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+//-----------------------------------------------------------------------------
+void CFlowField::Create( float fWidth, float fHeight, float fCellSize )
+{
+	int iColumns = std::max(1, (int)ceilf(fWidth / fCellSize));
+	int iRows	 = std::max(1, (int)ceilf(fHeight / fCellSize));
+
+	m_fCellSize		= fCellSize;
+	m_fInvCellSize	= 1.0f / fCellSize;
+	if (iColumns == m_iColumns && iRows == m_iRows)
+		return;
+
+	m_iColumns		= iColumns;
+	m_iRows			= iRows;
+	m_fMaxColumn	= (float)(iColumns - 1);
+	m_fMaxRow		= (float)(iRows - 1);
+
+	size_t nCells = (size_t)iColumns * iRows;
+	m_Distance.assign(nCells, FAR_AWAY);
+	m_DirX.assign(nCells, 0.0f);
+	m_DirY.assign(nCells, 0.0f);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Back to an empty field, every direction zero.
+//-----------------------------------------------------------------------------
+void CFlowField::Clear( )
+{
+	std::fill(m_Distance.begin(), m_Distance.end(), FAR_AWAY);
+	std::fill(m_DirX.begin(), m_DirX.end(), 0.0f);
+	std::fill(m_DirY.begin(), m_DirY.end(), 0.0f);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Seeds the goal cells with zero, sweeps down and back up to spread
+//		the distances, then turns each cell's slope into a direction.
+//-----------------------------------------------------------------------------
+void CFlowField::Build( const float *pX, const float *pY, int nGoals )
+{
+	const int w = m_iColumns, h = m_iRows;
+	uint16_t *d = &m_Distance[0];
+
+	std::fill(m_Distance.begin(), m_Distance.end(), FAR_AWAY);
+	for (int i = 0; i < nGoals; i++)
+		d[CellOf(pX[i], pY[i])] = 0;
+
+	// Forward: the row above, which is done, then along the row from the
+	// left; split so only the second half waits on the cell before it
+	for (int y = 0; y < h; y++)
+	{
+		uint16_t *row = d + y * w;
+
+		if (y > 0)
+			RelaxFromRow(row, row - w, w);
+		for (int x = 1; x < w; x++)
+			row[x] = (uint16_t)std::min<int>(row[x], row[x - 1] + STRAIGHT);
+	}
+
+	// Backward: the row below, then along the row from the right
+	for (int y = h - 1; y >= 0; y--)
+	{
+		uint16_t *row = d + y * w;
+
+		if (y < h - 1)
+			RelaxFromRow(row, row + w, w);
+		for (int x = w - 2; x >= 0; x--)
+			row[x] = (uint16_t)std::min<int>(row[x], row[x + 1] + STRAIGHT);
+	}
+
+	// Downhill, by central differences; one sided at the edges
+	for (int y = 0; y < h; y++)
+	{
+		const uint16_t *row		= d + y * w;
+		const uint16_t *above	= y > 0 ? row - w : row;
+		const uint16_t *below	= y < h - 1 ? row + w : row;
+		float *dx = &m_DirX[y * w];
+		float *dy = &m_DirY[y * w];
+
+		for (int x = 0; x < w; x++)
+		{
+			float gx = (float)row[x > 0 ? x - 1 : x] - (float)row[x < w - 1 ? x + 1 : x];
+			float gy = (float)above[x] - (float)below[x];
+			float fLengthSq = gx * gx + gy * gy;
+			float fScale = row[x] != 0 && fLengthSq > 0 ? 1.0f / sqrtf(fLengthSq) : 0.0f;
+
+			dx[x] = gx * fScale;
+			dy[x] = gy * fScale;
+		}
+	}
+}
@@ -0,0 +1,442 @@
+//-----------------------------------------------------------------------------
+// File: HeadlessMain.cpp
+//
+// Desc: Headless driver for the simulation. Runs games back to back with
+//	   scripted input as fast as the machine allows, no window, no sound,
+//	   and prints how fast the rules ran.
+//
+//	   Usage: planes_headless [steps] [seed] [enemies] [steps per second]
+//							  [job workers, -1 for all cores] [1 for system timings]
+//							  [enemy pattern, 0 single to 5 storm]
+//							  [enemy script, 0 drift, 1 strafe or 2 chase]
+//							  [waves, a wave file or ramp, swarm, mixed or chase]
+//			  planes_headless record <file> [same as above]
+//			  planes_headless replay <file> [job workers]
+//			  planes_headless particles [explosions per second] [seconds]
+//
+//	   Record saves the scripted input; replay runs a recording, from the
+//	   game or from record, again and times every step, with the
+//	   collision masks the game recorded. A replay does the
+//	   same work every time, which makes it the benchmark to compare
+//	   builds with, and the state hash shows whether they agree.
+//	   Particles times the explosion effects on a game sized surface.
+//	   The built in waves are stress scenarios growing to thousands of
+//	   enemies; with waves, the enemy count is ignored. An argument that
+//	   does not parse, or one too many, prints the usage above and exits
+//	   with 1.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Headless Driver Includes
+//-----------------------------------------------------------------------------
+#include "SimWorld.h"
+#include "InputRecording.h"
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const unsigned long	DEFAULT_STEPS	= 1000000;
+	const double		SCRIPT_RATE		= 120.0;	// Ticks per second the script is written in
+
+	const int			PARTICLE_SURFACE_WIDTH	= 1280;
+	const int			PARTICLE_SURFACE_HEIGHT	= 720;
+	const double		PARTICLE_FRAME_RATE		= 60.0;
+
+	const int			MAX_JOB_WORKERS	= 256;
+
+	const char			USAGE[] =
+		"Usage: planes_headless [steps] [seed] [enemies] [steps per second]\n"
+		"                       [job workers, -1 for all cores] [1 for system timings]\n"
+		"                       [enemy pattern, 0 single to 5 storm]\n"
+		"                       [enemy script, 0 drift, 1 strafe or 2 chase]\n"
+		"                       [waves, a wave file or ramp, swarm, mixed or chase]\n"
+		"       planes_headless record <file> [same as above]\n"
+		"       planes_headless replay <file> [job workers]\n"
+		"       planes_headless particles [explosions per second] [seconds]\n";
+}
+
+//-----------------------------------------------------------------------------
+// Name : Usage ()
+// Desc : Prints the usage for a bad command line; returns main()'s result.
+//-----------------------------------------------------------------------------
+static int Usage( )
+{
+	fputs(USAGE, stderr);
+	return 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseInt ()
+// Desc : The whole of szArg as a whole number in [llMin, llMax]. Anything
+//		else is reported and fails.
+//-----------------------------------------------------------------------------
+static bool ParseInt( const char *szArg, const char *szWhat, long long llMin, long long llMax, long long& llValue )
+{
+	char *pEnd;
+	errno	= 0;
+	llValue	= strtoll(szArg, &pEnd, 10);
+	if (pEnd == szArg || *pEnd != '\0' || errno == ERANGE || llValue < llMin || llValue > llMax)
+	{
+		fprintf(stderr, "bad %s: %s, expected %lld to %lld\n", szWhat, szArg, llMin, llMax);
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseReal ()
+// Desc : The whole of szArg as a finite number of at least dMin.
+//-----------------------------------------------------------------------------
+static bool ParseReal( const char *szArg, const char *szWhat, double dMin, double& dValue )
+{
+	char *pEnd;
+	errno	= 0;
+	dValue	= strtod(szArg, &pEnd);
+	if (pEnd == szArg || *pEnd != '\0' || errno == ERANGE || !std::isfinite(dValue) || dValue < dMin)
+	{
+		fprintf(stderr, "bad %s: %s, expected a number from %g\n", szWhat, szArg, dMin);
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Due ()
+// Desc : True if a tick in [ulTick, ulNextTick) is ulOffset short of a
+//		multiple of ulPeriod.
+//-----------------------------------------------------------------------------
+static bool Due( unsigned long ulTick, unsigned long ulNextTick, unsigned long ulOffset, unsigned long ulPeriod )
+{
+	return (ulNextTick + ulOffset + ulPeriod - 1) / ulPeriod != (ulTick + ulOffset + ulPeriod - 1) / ulPeriod;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScriptInput ()
+// Desc : Both players weave across the screen and fire at a steady rate.
+//		The script runs on its own clock of SCRIPT_RATE ticks a second, so
+//		a game plays out the same at any step rate; an action fires on the
+//		step its tick falls in.
+//-----------------------------------------------------------------------------
+static void ScriptInput( unsigned long ulTick, unsigned long ulNextTick, SimInput& input )
+{
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		SimPlayerInput& cmd = input.Players[i];
+
+		cmd.uMove = ((ulTick / 90 + i) & 1) ? SimPlayerInput::MOVE_LEFT : SimPlayerInput::MOVE_RIGHT;
+		if ((ulTick / 240 + i) & 1)
+			cmd.uMove |= ((ulTick / 30) & 1) ? SimPlayerInput::MOVE_FORWARD : SimPlayerInput::MOVE_BACKWARD;
+
+		cmd.uActions = 0;
+		if (Due(ulTick, ulNextTick, i * 60, 120))
+			cmd.uActions |= SimPlayerInput::ACTION_FIRE;
+		if (Due(ulTick, ulNextTick, i * 500, 1000))
+			cmd.uActions |= SimPlayerInput::ACTION_ROTATE_RIGHT;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : NextGame ()
+// Desc : Soak rule shared by the scripted run and replays: a finished game
+//		is followed at once by a new one on the next seed.
+//-----------------------------------------------------------------------------
+static void NextGame( CSimWorld& world, SimConfig& config )
+{
+	config.uSeed++;
+	world.Reset(config);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Replay ()
+// Desc : Plays a recording back as fast as possible, timing each step.
+//-----------------------------------------------------------------------------
+static int Replay( const char *szFileName, int iWorkers )
+{
+	CInputRecording recording;
+	if (!recording.LoadFile(szFileName))
+	{
+		fprintf(stderr, "cannot read recording %s\n", szFileName);
+		return 1;
+	}
+
+	CJobSystem	jobs;
+	CSimWorld	world;
+	SimConfig	config	  = recording.GetConfig();
+	float		fStepTime = (float)(1.0 / recording.GetStepRate());
+
+	if (iWorkers != 0)
+	{
+		jobs.Create(iWorkers);
+		world.SetJobSystem(&jobs);
+	}
+	world.SetCollisionMasks(recording.GetPlayerMasks(), recording.GetEnemyMask(), recording.GetBulletMask());
+	world.Reset(config);
+
+	std::vector<double>	stepTimes;
+	stepTimes.reserve(recording.GetStepCount());
+	unsigned long		ulGames = 0;
+	SimInput			input;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	while (recording.Next(input))
+	{
+		std::chrono::steady_clock::time_point stepStart = std::chrono::steady_clock::now();
+		world.Step(input, fStepTime);
+		stepTimes.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count());
+
+		world.ClearEvents();
+		if (world.IsGameOver())
+		{
+			ulGames++;
+			NextGame(world, config);
+		}
+	}
+
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("steps        %lu\n", recording.GetStepCount());
+	printf("seconds      %.3f\n", dSeconds);
+	printf("steps/sec    %.0f\n", dSeconds > 0 ? stepTimes.size() / dSeconds : 0.0);
+	printf("games        %lu\n", ulGames);
+
+	if (!stepTimes.empty())
+	{
+		std::sort(stepTimes.begin(), stepTimes.end());
+		size_t n = stepTimes.size();
+		printf("step us      min %.2f  median %.2f  p99 %.2f  max %.2f\n", stepTimes[0] * 1e6,
+			   stepTimes[n / 2] * 1e6, stepTimes[n - 1 - n / 100] * 1e6, stepTimes[n - 1] * 1e6);
+	}
+
+	printf("state hash   %016llx\n", (unsigned long long)world.GetStateHash());
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Particles ()
+// Desc : Sets off explosions all over a cleared surface at a steady rate,
+//		the way the game does, and times updating and drawing them.
+//-----------------------------------------------------------------------------
+static int Particles( double dRate, double dSeconds )
+{
+	const ParticlePreset *pPresets[] = { &CParticleSystem::GetPreset(PARTICLE_EXPLOSION),
+										 &CParticleSystem::GetPreset(PARTICLE_SMOKE),
+										 &CParticleSystem::GetPreset(PARTICLE_SPARKS) };
+
+	CParticleSystem			particles;
+	CRandom					random;
+	std::vector<uint32_t>	surface((size_t)PARTICLE_SURFACE_WIDTH * PARTICLE_SURFACE_HEIGHT);
+	particles.Create(1 << 18);
+
+	unsigned long	ulFrames		= (unsigned long)(dSeconds * PARTICLE_FRAME_RATE);
+	float			fFrameTime		= (float)(1.0 / PARTICLE_FRAME_RATE);
+	double			dDue			= 0;
+	unsigned long	ulExplosions	= 0;
+	size_t			nMaxParticles	= 0;
+	double			dUpdate = 0, dDraw = 0;
+
+	for (unsigned long ulFrame = 0; ulFrame < ulFrames; ulFrame++)
+	{
+		for (dDue += dRate / PARTICLE_FRAME_RATE; dDue >= 1; dDue--, ulExplosions++)
+		{
+			float x = random.Range(0, (float)PARTICLE_SURFACE_WIDTH);
+			float y = random.Range(0, (float)PARTICLE_SURFACE_HEIGHT);
+			for (size_t i = 0; i < sizeof(pPresets) / sizeof(pPresets[0]); i++)
+				particles.Emit(*pPresets[i], x, y);
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		particles.Update(fFrameTime);
+		std::chrono::steady_clock::time_point drawStart = std::chrono::steady_clock::now();
+		std::fill(surface.begin(), surface.end(), 0x203040);
+		particles.Draw(&surface[0], PARTICLE_SURFACE_WIDTH, PARTICLE_SURFACE_HEIGHT, 1.0f);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		dUpdate	+= std::chrono::duration<double>(drawStart - start).count();
+		dDraw	+= std::chrono::duration<double>(end - drawStart).count();
+		if (particles.Count() > nMaxParticles)
+			nMaxParticles = particles.Count();
+	}
+
+	double dPerFrame = ulFrames > 0 ? 1e6 / ulFrames : 0;
+	printf("frames       %lu\n", ulFrames);
+	printf("explosions   %lu\n", ulExplosions);
+	printf("particles    %lu max\n", (unsigned long)nMaxParticles);
+	printf("update us    %.1f per frame\n", dUpdate * dPerFrame);
+	printf("draw us      %.1f per frame (with clear)\n", dDraw * dPerFrame);
+	printf("kernel       %s\n", BoxBatchPathName(BoxBatchGetPath()));
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : main() (Application Entry Point)
+//-----------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+	if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0))
+		return Usage();
+	if (argc > 1 && strcmp(argv[1], "replay") == 0)
+	{
+		long long llWorkers = 0;
+		if (argc < 3 || argc > 4 || (argc > 3 && !ParseInt(argv[3], "job workers", -1, MAX_JOB_WORKERS, llWorkers)))
+			return Usage();
+		return Replay(argv[2], (int)llWorkers);
+	}
+	if (argc > 1 && strcmp(argv[1], "particles") == 0)
+	{
+		double dRate = 200.0, dSeconds = 10.0;
+		if (argc > 4 || (argc > 2 && !ParseReal(argv[2], "explosions per second", 0, dRate)) ||
+			(argc > 3 && !ParseReal(argv[3], "seconds", 0, dSeconds)))
+			return Usage();
+		return Particles(dRate, dSeconds);
+	}
+
+	// Recording takes the usual arguments after the file name
+	const char *szRecordFile = NULL;
+	if (argc > 1 && strcmp(argv[1], "record") == 0)
+	{
+		if (argc < 3)
+			return Usage();
+		szRecordFile = argv[2];
+		argc -= 2;
+		argv += 2;
+	}
+
+	SimConfig	config;
+	long long	llSteps = DEFAULT_STEPS, llSeed = 1, llEnemies = config.iEnemyCount, llWorkers = 0, llTimings = 0;
+	long long	llPattern = config.iEnemyPattern, llScript = config.iEnemyScript;
+	double		dStepRate = SIM_DEFAULT_STEP_RATE;
+
+	if (argc > 10 ||
+		(argc > 1 && !ParseInt(argv[1], "steps", 0, LONG_MAX, llSteps)) ||
+		(argc > 2 && !ParseInt(argv[2], "seed", 0, UINT_MAX, llSeed)) ||
+		(argc > 3 && !ParseInt(argv[3], "enemies", 0, INT_MAX, llEnemies)) ||
+		(argc > 4 && !ParseReal(argv[4], "steps per second", 1, dStepRate)) ||
+		(argc > 5 && !ParseInt(argv[5], "job workers", -1, MAX_JOB_WORKERS, llWorkers)) ||
+		(argc > 6 && !ParseInt(argv[6], "system timings", 0, 1, llTimings)) ||
+		(argc > 7 && !ParseInt(argv[7], "enemy pattern", 0, SIM_PATTERN_COUNT - 1, llPattern)) ||
+		(argc > 8 && !ParseInt(argv[8], "enemy script", 0, SIM_SCRIPT_COUNT - 1, llScript)))
+		return Usage();
+
+	unsigned long	ulSteps	= (unsigned long)llSteps;
+	config.uSeed			= (unsigned int)llSeed;
+	config.iEnemyCount		= (int)llEnemies;
+	config.iEnemyPattern	= (int)llPattern;
+	config.iEnemyScript		= (int)llScript;
+	if (argc > 9)
+	{
+		const char *szPreset = CWaveSpawner::GetPreset(argv[9]);
+		if (szPreset)
+			config.Waves = szPreset;
+		else if (!CWaveSpawner::ReadFile(argv[9], config.Waves))
+		{
+			fprintf(stderr, "cannot read waves %s\n", argv[9]);
+			return 1;
+		}
+	}
+
+	// Room for the bullet-hell patterns
+	config.iMaxBullets = 65536;
+
+	float	fStepTime	= (float)(1.0 / dStepRate);
+
+	// No job system unless asked for, so the default run stays on one thread
+	CJobSystem	jobs;
+	int			iWorkers = (int)llWorkers;
+	if (iWorkers != 0)
+		jobs.Create(iWorkers);
+
+	CSimWorld	world;
+	SimInput	input;
+	if (iWorkers != 0)
+		world.SetJobSystem(&jobs);
+	world.SetSystemTiming(llTimings != 0);
+	world.Reset(config);
+
+	CInputRecording recording;
+	recording.Begin(config, dStepRate);
+
+	unsigned long	ulGames		= 0;
+	unsigned long	ulEvents	= 0;
+	size_t			nMaxBullets	= 0;
+	size_t			nMaxEnemies	= 0;
+	int				iWins[SIM_PLAYER_COUNT] = { 0 };
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned long ulStep = 0; ulStep < ulSteps; ulStep++)
+	{
+		unsigned long ulTick	 = (unsigned long)(ulStep * SCRIPT_RATE / dStepRate + 1e-9);
+		unsigned long ulNextTick = (unsigned long)((ulStep + 1) * SCRIPT_RATE / dStepRate + 1e-9);
+		ScriptInput(ulTick, ulNextTick, input);
+		if (szRecordFile)
+			recording.Add(input);
+		world.Step(input, fStepTime);
+
+		const std::vector<SimEvent>& events = world.GetEvents();
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			if (events[i].Type == SimEvent::EVENT_GAME_OVER)
+				iWins[events[i].iSubject]++;
+		}
+		ulEvents += (unsigned long)events.size();
+		world.ClearEvents();
+
+		if (world.GetBullets().Count() > nMaxBullets)
+			nMaxBullets = world.GetBullets().Count();
+		if (world.GetEnemies().Size() > nMaxEnemies)
+			nMaxEnemies = world.GetEnemies().Size();
+
+		// Soak: keep playing new games until the step budget is spent
+		if (world.IsGameOver())
+		{
+			ulGames++;
+			NextGame(world, config);
+		}
+	}
+
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("steps        %lu\n", ulSteps);
+	printf("seconds      %.3f\n", dSeconds);
+	printf("steps/sec    %.0f\n", dSeconds > 0 ? ulSteps / dSeconds : 0.0);
+	printf("games        %lu (wins %d-%d)\n", ulGames, iWins[0], iWins[1]);
+	printf("events       %lu\n", ulEvents);
+	printf("max bullets  %lu\n", (unsigned long)nMaxBullets);
+	printf("max enemies  %lu\n", (unsigned long)nMaxEnemies);
+	printf("enemies left %lu\n", (unsigned long)world.GetEnemies().Size());
+	printf("state hash   %016llx\n", (unsigned long long)world.GetStateHash());
+	printf("box kernel   %s\n", BoxBatchPathName(BoxBatchGetPath()));
+	printf("job workers  %d\n", iWorkers != 0 ? jobs.GetWorkerCount() : 0);
+
+	// Per system: total time, average per step, and what it waits for
+	const CSystemScheduler& systems = world.GetSystems();
+	for (int i = 0; i < systems.GetSystemCount(); i++)
+	{
+		if (systems.GetRuns(i) == 0)
+			continue;
+
+		printf("  %-16s %8.3f s %8.1f ns  (%d deps)\n", systems.GetName(i), systems.GetSeconds(i),
+			   systems.GetSeconds(i) * 1e9 / systems.GetRuns(i), systems.GetDependencyCount(i));
+	}
+
+	if (szRecordFile && !recording.SaveFile(szRecordFile))
+	{
+		fprintf(stderr, "cannot write recording %s\n", szRecordFile);
+		return 1;
+	}
+
+	return 0;
+}
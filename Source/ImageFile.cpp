@@ -84,6 +84,35 @@ bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc)
 	return true;
 }
 
+void CImageFile::CreateFromPixels(const RGBQUAD *pPixels, LONG lWidth, LONG lHeight)
+{
+	if (m_pRGB)
+	{
+		delete[] m_pRGB;
+		m_pRGB = NULL;
+	}
+
+	if (m_hBMP)
+	{
+		DeleteObject(m_hBMP);
+		m_hBMP = 0;
+	}
+
+	m_szFileName[0] = 0;
+
+	ZeroMemory(&m_biInfo, sizeof(BITMAPINFOHEADER));
+	m_biInfo.biSize = sizeof(BITMAPINFOHEADER);
+	m_biInfo.biPlanes = 1;
+	m_biInfo.biBitCount = 32;
+	m_biInfo.biCompression = BI_RGB;
+	width = lWidth;
+	height = lHeight;
+	m_biInfo.biSizeImage = width * height * sizeof(RGBQUAD);
+
+	m_pRGB = new RGBQUAD[width * height];
+	memcpy(m_pRGB, pPixels, sizeof(RGBQUAD) * width * height);
+}
+
 void CImageFile::Reload(HDC hdc)
 {
 	LoadBitmapFromFile(m_szFileName, hdc);
@@ -298,3 +327,16 @@ void CImageFile::PasteMonoImage(const BYTE *img, EColorChannel chn, const RECT*
 
 }
 
+HBITMAP CreateTopDownDIB(HDC hdc, int iWidth, int iHeight, void **ppBits)
+{
+	BITMAPINFO bi;
+	ZeroMemory(&bi, sizeof(BITMAPINFO));
+	bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bi.bmiHeader.biWidth = iWidth;
+	bi.bmiHeader.biHeight = -iHeight; // negative height means rows are stored top to bottom
+	bi.bmiHeader.biPlanes = 1;
+	bi.bmiHeader.biBitCount = 32;
+	bi.bmiHeader.biCompression = BI_RGB;
+
+	return CreateDIBSection(hdc, &bi, DIB_RGB_COLORS, ppBits, NULL, 0);
+}
@@ -0,0 +1,459 @@
+//-----------------------------------------------------------------------------
+// File: InputRecording.cpp
+//
+// Desc: Per step input recording. The file is little endian throughout:
+//
+//	   "PLRC", u16 version, u16 players
+//	   config: f64 x 8 (play area, player, enemy and bullet sizes),
+//			   i32 x 3 (enemies, lives, bullets), f32 explosion time (6
+//			   on; i32 frames and f32 frame time before), u32 seed,
+//			   i32 enemy pattern (2 on), i32 enemy script (3 on), u32
+//			   length and the wave text (4 on)
+//	   masks (5 on): u16 player masks, each player mask, enemy mask,
+//			   bullet mask; a mask is u16 width, u16 height, then each
+//			   row's pixels a bit each, least significant first, padded to
+//			   whole bytes (0 x 0 for none)
+//	   f64 step rate, u32 steps, u32 runs
+//	   per run: varint steps, one byte per player
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CInputRecording Specific Includes
+//-----------------------------------------------------------------------------
+#include "InputRecording.h"
+#include <string.h>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const char		RECORDING_MAGIC[4]	= { 'P', 'L', 'R', 'C' };
+	const uint16_t	RECORDING_VERSION	= 6;		// 2 added the enemy pattern, 3 the script, 4 the waves, 5 the masks, 6 one explosion time
+	const uint32_t	MAX_WAVE_TEXT		= 1 << 24;	// Longer is taken for a bad file
+	const uint64_t	MAX_MASK_SIZE		= 4096;		// Sides past this too
+
+	//-------------------------------------------------------------------------
+	// Byte order independent writers and readers
+	//-------------------------------------------------------------------------
+	void PutU64( std::vector<uint8_t>& bytes, uint64_t u, int nBytes )
+	{
+		for (int i = 0; i < nBytes; i++)
+			bytes.push_back((uint8_t)(u >> (8 * i)));
+	}
+
+	void PutF64( std::vector<uint8_t>& bytes, double d )
+	{
+		uint64_t u;
+		memcpy(&u, &d, sizeof(u));
+		PutU64(bytes, u, 8);
+	}
+
+	void PutF32( std::vector<uint8_t>& bytes, float f )
+	{
+		uint32_t u;
+		memcpy(&u, &f, sizeof(u));
+		PutU64(bytes, u, 4);
+	}
+
+	void PutVarint( std::vector<uint8_t>& bytes, uint32_t u )
+	{
+		// Seven bits at a time, the top bit set on all but the last byte
+		while (u >= 0x80)
+		{
+			bytes.push_back((uint8_t)(u | 0x80));
+			u >>= 7;
+		}
+		bytes.push_back((uint8_t)u);
+	}
+
+	bool GetU64( std::istream& in, uint64_t& u, int nBytes )
+	{
+		uint8_t bytes[8];
+		if (!in.read((char*)bytes, nBytes))
+			return false;
+
+		u = 0;
+		for (int i = 0; i < nBytes; i++)
+			u |= (uint64_t)bytes[i] << (8 * i);
+		return true;
+	}
+
+	bool GetF64( std::istream& in, double& d )
+	{
+		uint64_t u;
+		if (!GetU64(in, u, 8))
+			return false;
+		memcpy(&d, &u, sizeof(d));
+		return true;
+	}
+
+	bool GetF32( std::istream& in, float& f )
+	{
+		uint64_t u;
+		if (!GetU64(in, u, 4))
+			return false;
+		uint32_t u32 = (uint32_t)u;
+		memcpy(&f, &u32, sizeof(f));
+		return true;
+	}
+
+	bool GetI32( std::istream& in, int& i )
+	{
+		uint64_t u;
+		if (!GetU64(in, u, 4))
+			return false;
+		i = (int)(int32_t)(uint32_t)u;
+		return true;
+	}
+
+	void PutMask( std::vector<uint8_t>& bytes, const CCollisionMask& mask )
+	{
+		PutU64(bytes, (uint32_t)mask.Width(), 2);
+		PutU64(bytes, (uint32_t)mask.Height(), 2);
+
+		for (int y = 0; y < mask.Height(); y++)
+		{
+			for (int x = 0; x < mask.Width(); x += 8)
+			{
+				uint8_t uByte = 0;
+				for (int i = 0; i < 8; i++)
+					uByte |= (uint8_t)(mask.IsSolid(x + i, y) << i);
+				bytes.push_back(uByte);
+			}
+		}
+	}
+
+	bool GetMask( std::istream& in, CCollisionMask& mask )
+	{
+		uint64_t uWidth, uHeight;
+		if (!GetU64(in, uWidth, 2) || !GetU64(in, uHeight, 2) || uWidth > MAX_MASK_SIZE || uHeight > MAX_MASK_SIZE)
+			return false;
+
+		mask.Release();
+		if (uWidth == 0 || uHeight == 0)
+			return true;
+
+		int iWidth = (int)uWidth, iHeight = (int)uHeight;
+		std::vector<uint8_t> row((iWidth + 7) / 8);
+		std::vector<uint32_t> pixels((size_t)iWidth * iHeight);
+
+		for (int y = 0; y < iHeight; y++)
+		{
+			if (!in.read((char*)&row[0], (std::streamsize)row.size()))
+				return false;
+
+			for (int x = 0; x < iWidth; x++)
+				pixels[(size_t)y * iWidth + x] = (row[x >> 3] >> (x & 7)) & 1;
+		}
+
+		return mask.Create(&pixels[0], iWidth, iHeight, 1);
+	}
+
+	bool GetVarint( std::istream& in, uint32_t& u )
+	{
+		u = 0;
+		for (int iShift = 0; iShift < 35; iShift += 7)
+		{
+			int c = in.get();
+			if (c == EOF)
+				return false;
+
+			u |= (uint32_t)(c & 0x7F) << iShift;
+			if (!(c & 0x80))
+				return true;
+		}
+		return false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CInputRecording Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CInputRecording () (Constructor)
+// Desc : CInputRecording Class Constructor
+//-----------------------------------------------------------------------------
+CInputRecording::CInputRecording()
+{
+	m_dStepRate		= SIM_DEFAULT_STEP_RATE;
+	m_bRecording	= false;
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CInputRecording () (Destructor)
+// Desc : CInputRecording Class Destructor
+//-----------------------------------------------------------------------------
+CInputRecording::~CInputRecording()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Begin ()
+// Desc : Starts a new recording of a world just Reset() with config.
+//-----------------------------------------------------------------------------
+void CInputRecording::Begin( const SimConfig& config, double dStepRate )
+{
+	Clear();
+	m_Config		= config;
+	m_dStepRate		= dStepRate;
+	m_bRecording	= true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+//-----------------------------------------------------------------------------
+void CInputRecording::Clear( )
+{
+	m_Runs.clear();
+	m_ulSteps = 0;
+	Rewind();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+//-----------------------------------------------------------------------------
+void CInputRecording::Add( const SimInput& input )
+{
+	Run run;
+	run.uSteps = 1;
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		run.Players[i] = (uint8_t)((input.Players[i].uMove & 0x0F) | ((input.Players[i].uActions & 0x0F) << 4));
+
+	m_ulSteps++;
+
+	if (!m_Runs.empty() && memcmp(m_Runs.back().Players, run.Players, sizeof(run.Players)) == 0 &&
+		m_Runs.back().uSteps < 0xFFFFFFFF)
+	{
+		m_Runs.back().uSteps++;
+		return;
+	}
+
+	m_Runs.push_back(run);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetCollisionMasks ()
+//-----------------------------------------------------------------------------
+void CInputRecording::SetCollisionMasks( const std::vector<CCollisionMask>& playerMasks,
+										 const CCollisionMask& enemyMask, const CCollisionMask& bulletMask )
+{
+	m_PlayerMasks	= playerMasks;
+	m_EnemyMask		= enemyMask;
+	m_BulletMask	= bulletMask;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Rewind ()
+//-----------------------------------------------------------------------------
+void CInputRecording::Rewind( )
+{
+	m_iRun		= 0;
+	m_uRunStep	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Next ()
+//-----------------------------------------------------------------------------
+bool CInputRecording::Next( SimInput& input )
+{
+	if (m_iRun >= m_Runs.size())
+		return false;
+
+	const Run& run = m_Runs[m_iRun];
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		input.Players[i].uMove		= run.Players[i] & 0x0F;
+		input.Players[i].uActions	= run.Players[i] >> 4;
+	}
+
+	if (++m_uRunStep >= run.uSteps)
+	{
+		m_iRun++;
+		m_uRunStep = 0;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Save ()
+//-----------------------------------------------------------------------------
+bool CInputRecording::Save( std::ostream& out ) const
+{
+	std::vector<uint8_t> bytes(RECORDING_MAGIC, RECORDING_MAGIC + 4);
+
+	PutU64(bytes, RECORDING_VERSION, 2);
+	PutU64(bytes, SIM_PLAYER_COUNT, 2);
+
+	PutF64(bytes, m_Config.dWidth);
+	PutF64(bytes, m_Config.dHeight);
+	PutF64(bytes, m_Config.dPlayerWidth);
+	PutF64(bytes, m_Config.dPlayerHeight);
+	PutF64(bytes, m_Config.dEnemyWidth);
+	PutF64(bytes, m_Config.dEnemyHeight);
+	PutF64(bytes, m_Config.dBulletWidth);
+	PutF64(bytes, m_Config.dBulletHeight);
+	PutU64(bytes, (uint32_t)m_Config.iEnemyCount, 4);
+	PutU64(bytes, (uint32_t)m_Config.iPlayerLives, 4);
+	PutU64(bytes, (uint32_t)m_Config.iMaxBullets, 4);
+	PutF32(bytes, m_Config.fExplosionTime);
+	PutU64(bytes, m_Config.uSeed, 4);
+	PutU64(bytes, (uint32_t)m_Config.iEnemyPattern, 4);
+	PutU64(bytes, (uint32_t)m_Config.iEnemyScript, 4);
+	PutU64(bytes, (uint32_t)m_Config.Waves.size(), 4);
+	bytes.insert(bytes.end(), m_Config.Waves.begin(), m_Config.Waves.end());
+
+	PutU64(bytes, (uint32_t)m_PlayerMasks.size(), 2);
+	for (size_t i = 0; i < m_PlayerMasks.size(); i++)
+		PutMask(bytes, m_PlayerMasks[i]);
+	PutMask(bytes, m_EnemyMask);
+	PutMask(bytes, m_BulletMask);
+
+	PutF64(bytes, m_dStepRate);
+	PutU64(bytes, (uint32_t)m_ulSteps, 4);
+	PutU64(bytes, (uint32_t)m_Runs.size(), 4);
+
+	for (size_t i = 0; i < m_Runs.size(); i++)
+	{
+		PutVarint(bytes, m_Runs[i].uSteps);
+		bytes.insert(bytes.end(), m_Runs[i].Players, m_Runs[i].Players + SIM_PLAYER_COUNT);
+	}
+
+	out.write((const char*)&bytes[0], bytes.size());
+	return out.good();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Load ()
+// Desc : The recording is untouched if the data is bad or was made with a
+//		different player count. Older versions leave out what they predate,
+//		which keeps its default.
+//-----------------------------------------------------------------------------
+bool CInputRecording::Load( std::istream& in )
+{
+	char		magic[4];
+	uint64_t	uVersion, uPlayers, uSeed, uSteps, uRuns;
+	SimConfig	config;
+	double		dStepRate;
+
+	if (!in.read(magic, 4) || memcmp(magic, RECORDING_MAGIC, 4) != 0)
+		return false;
+	if (!GetU64(in, uVersion, 2) || uVersion < 1 || uVersion > RECORDING_VERSION)
+		return false;
+	if (!GetU64(in, uPlayers, 2) || uPlayers != (uint64_t)SIM_PLAYER_COUNT)
+		return false;
+
+	if (!GetF64(in, config.dWidth) || !GetF64(in, config.dHeight) ||
+		!GetF64(in, config.dPlayerWidth) || !GetF64(in, config.dPlayerHeight) ||
+		!GetF64(in, config.dEnemyWidth) || !GetF64(in, config.dEnemyHeight) ||
+		!GetF64(in, config.dBulletWidth) || !GetF64(in, config.dBulletHeight) ||
+		!GetI32(in, config.iEnemyCount) || !GetI32(in, config.iPlayerLives) ||
+		!GetI32(in, config.iMaxBullets))
+		return false;
+
+	// Before 6 explosions were a frame count and a frame time
+	if (uVersion >= 6)
+	{
+		if (!GetF32(in, config.fExplosionTime))
+			return false;
+	}
+	else
+	{
+		int		iFrames;
+		float	fFrameTime;
+		if (!GetI32(in, iFrames) || !GetF32(in, fFrameTime))
+			return false;
+		config.fExplosionTime = fFrameTime * iFrames;
+	}
+
+	if (!GetU64(in, uSeed, 4))
+		return false;
+	config.uSeed = (unsigned int)uSeed;
+
+	if (uVersion >= 2 && !GetI32(in, config.iEnemyPattern))
+		return false;
+	if (uVersion >= 3 && !GetI32(in, config.iEnemyScript))
+		return false;
+	if (uVersion >= 4)
+	{
+		uint64_t uLength;
+		if (!GetU64(in, uLength, 4) || uLength > MAX_WAVE_TEXT)
+			return false;
+
+		config.Waves.resize((size_t)uLength);
+		if (uLength && !in.read(&config.Waves[0], (std::streamsize)uLength))
+			return false;
+	}
+
+	std::vector<CCollisionMask> playerMasks;
+	CCollisionMask enemyMask, bulletMask;
+	if (uVersion >= 5)
+	{
+		uint64_t uMasks;
+		if (!GetU64(in, uMasks, 2))
+			return false;
+
+		playerMasks.resize((size_t)uMasks);
+		for (size_t i = 0; i < playerMasks.size(); i++)
+		{
+			if (!GetMask(in, playerMasks[i]))
+				return false;
+		}
+		if (!GetMask(in, enemyMask) || !GetMask(in, bulletMask))
+			return false;
+	}
+
+	if (!GetF64(in, dStepRate) || dStepRate <= 0 || !GetU64(in, uSteps, 4) || !GetU64(in, uRuns, 4))
+		return false;
+
+	std::vector<Run> runs;
+	uint64_t uTotal = 0;
+	for (uint64_t i = 0; i < uRuns; i++)
+	{
+		Run run;
+		if (!GetVarint(in, run.uSteps) || run.uSteps == 0 || !in.read((char*)run.Players, SIM_PLAYER_COUNT))
+			return false;
+
+		uTotal += run.uSteps;
+		runs.push_back(run);
+	}
+
+	if (uTotal != uSteps)
+		return false;
+
+	m_Config		= config;
+	m_dStepRate		= dStepRate;
+	m_ulSteps		= (unsigned long)uSteps;
+	m_bRecording	= false;
+	m_Runs.swap(runs);
+	m_PlayerMasks.swap(playerMasks);
+	m_EnemyMask		= enemyMask;
+	m_BulletMask	= bulletMask;
+	Rewind();
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveFile ()
+//-----------------------------------------------------------------------------
+bool CInputRecording::SaveFile( const char *szFileName ) const
+{
+	std::ofstream out(szFileName, std::ios::binary);
+	return out && Save(out);
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadFile ()
+//-----------------------------------------------------------------------------
+bool CInputRecording::LoadFile( const char *szFileName )
+{
+	std::ifstream in(szFileName, std::ios::binary);
+	return in && Load(in);
+}
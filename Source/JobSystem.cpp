@@ -0,0 +1,271 @@
+//-----------------------------------------------------------------------------
+// File: JobSystem.cpp
+//
+// Desc: Work stealing job system. Deques are locked rather than lock free;
+//	   an owner and a thief only meet on a deque that is nearly empty, and
+//	   jobs here are chunks of real work, not single items.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CJobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "JobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Static Variables
+//-----------------------------------------------------------------------------
+// The system a thread works for and its deque there
+static thread_local const CJobSystem*	t_pOwner	= NULL;
+static thread_local int					t_iWorker	= 0;
+
+//-----------------------------------------------------------------------------
+// CJobSystem Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CJobSystem () (Constructor)
+// Desc : CJobSystem Class Constructor. Without Create() there is just the
+//		one deque, and jobs run when waited on.
+//-----------------------------------------------------------------------------
+CJobSystem::CJobSystem()
+{
+	m_pQueues			= new WorkerQueue[1];
+	m_nQueues			= 1;
+	m_nQueued			= 0;
+	m_bQuit				= false;
+	m_bDeterministic	= false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CJobSystem () (Destructor)
+// Desc : CJobSystem Class Destructor
+//-----------------------------------------------------------------------------
+CJobSystem::~CJobSystem()
+{
+	Release();
+	delete [] m_pQueues;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+//-----------------------------------------------------------------------------
+bool CJobSystem::Create( int iWorkers )
+{
+	Release();
+
+	if (iWorkers < 0)
+	{
+		unsigned int uHardware = std::thread::hardware_concurrency();
+		iWorkers = uHardware > 1 ? (int)uHardware - 1 : 0;
+	}
+
+	delete [] m_pQueues;
+	m_pQueues	= new WorkerQueue[iWorkers + 1];
+	m_nQueues	= iWorkers + 1;
+	m_bQuit		= false;
+
+	t_pOwner	= this;
+	t_iWorker	= 0;
+
+	for (int i = 1; i <= iWorkers; i++)
+		m_Threads.push_back(std::thread(&CJobSystem::WorkerMain, this, i));
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Stops the workers. Jobs they left behind run on the calling thread,
+//		then the system is back to a single deque.
+//-----------------------------------------------------------------------------
+void CJobSystem::Release( )
+{
+	if (m_Threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_SleepLock);
+		m_bQuit = true;
+	}
+	m_Wake.notify_all();
+
+	for (size_t i = 0; i < m_Threads.size(); i++)
+		m_Threads[i].join();
+	m_Threads.clear();
+
+	while (RunOne(0))
+		;
+
+	delete [] m_pQueues;
+	m_pQueues	= new WorkerQueue[1];
+	m_nQueues	= 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Run ()
+//-----------------------------------------------------------------------------
+void CJobSystem::Run( JOB_FUNC pFunc, void *pData, size_t iBegin, size_t iEnd,
+					  CJobCounter *pCounter, CJobCounter *pDependency )
+{
+	Job job = { pFunc, pData, iBegin, iEnd, pCounter };
+
+	if (pCounter)
+		pCounter->m_nPending.fetch_add(1, std::memory_order_relaxed);
+
+	if (pDependency)
+	{
+		// Checked under the lock the last job of the dependency takes, so
+		// the job is either parked before the release or sees it happened
+		std::lock_guard<std::mutex> lock(pDependency->m_Lock);
+		if (pDependency->m_nPending.load(std::memory_order_acquire) > 0)
+		{
+			pDependency->m_Waiting.push_back(job);
+			return;
+		}
+	}
+
+	if (m_bDeterministic)
+		Execute(job);
+	else
+		Push(job);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Wait ()
+//-----------------------------------------------------------------------------
+void CJobSystem::Wait( CJobCounter& counter )
+{
+	int iWorker = GetWorkerIndex();
+
+	while (!counter.IsDone())
+	{
+		if (!RunOne(iWorker))
+			std::this_thread::yield();
+	}
+
+	// The last job may still hold the lock; the counter must outlive that
+	std::lock_guard<std::mutex> lock(counter.m_Lock);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetWorkerIndex () (Private)
+// Desc : Threads that are not workers of this system share deque 0.
+//-----------------------------------------------------------------------------
+int CJobSystem::GetWorkerIndex( ) const
+{
+	return t_pOwner == this ? t_iWorker : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Push () (Private)
+//-----------------------------------------------------------------------------
+void CJobSystem::Push( const Job& job )
+{
+	WorkerQueue& queue = m_pQueues[GetWorkerIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		queue.Jobs.push_back(job);
+	}
+	m_nQueued.fetch_add(1, std::memory_order_release);
+
+	if (m_nQueues > 1)
+	{
+		// Sleepers test the count under this lock, so the wake cannot slip
+		// in between their test and their wait
+		{ std::lock_guard<std::mutex> lock(m_SleepLock); }
+		m_Wake.notify_one();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunOne () (Private)
+// Desc : Newest job of our own deque, else the oldest of the next deque
+//		along that has one.
+//-----------------------------------------------------------------------------
+bool CJobSystem::RunOne( int iWorker )
+{
+	if (m_nQueued.load(std::memory_order_acquire) == 0)
+		return false;
+
+	Job job;
+	bool bFound = false;
+
+	{
+		WorkerQueue& queue = m_pQueues[iWorker];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			job = queue.Jobs.back();
+			queue.Jobs.pop_back();
+			bFound = true;
+		}
+	}
+
+	for (int i = 1; i < m_nQueues && !bFound; i++)
+	{
+		WorkerQueue& queue = m_pQueues[(iWorker + i) % m_nQueues];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			job = queue.Jobs.front();
+			queue.Jobs.pop_front();
+			bFound = true;
+		}
+	}
+
+	if (!bFound)
+		return false;
+
+	m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+	Execute(job);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute () (Private)
+// Desc : Runs a job and counts it off. The job that empties a counter
+//		hands on whatever was waiting for it.
+//-----------------------------------------------------------------------------
+void CJobSystem::Execute( const Job& job )
+{
+	job.pFunc(job.pData, job.iBegin, job.iEnd);
+
+	CJobCounter *pCounter = job.pCounter;
+	if (!pCounter)
+		return;
+
+	std::vector<Job> released;
+	{
+		std::lock_guard<std::mutex> lock(pCounter->m_Lock);
+		if (pCounter->m_nPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			released.swap(pCounter->m_Waiting);
+	}
+
+	for (size_t i = 0; i < released.size(); i++)
+	{
+		if (m_bDeterministic)
+			Execute(released[i]);
+		else
+			Push(released[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerMain () (Private)
+//-----------------------------------------------------------------------------
+void CJobSystem::WorkerMain( int iWorker )
+{
+	t_pOwner	= this;
+	t_iWorker	= iWorker;
+
+	for (;;)
+	{
+		if (RunOne(iWorker))
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_SleepLock);
+		m_Wake.wait(lock, [this] { return m_bQuit || m_nQueued.load(std::memory_order_acquire) > 0; });
+		if (m_bQuit)
+			return;
+	}
+}
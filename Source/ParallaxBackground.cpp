@@ -0,0 +1,443 @@
+//-----------------------------------------------------------------------------
+// File: ParallaxBackground.cpp
+//
+// Desc: Multi-layer scrolling background. Every layer is converted once into
+//	   a strip the width of the viewport, so scrolling a layer only moves a
+//	   row offset into its strip. Layers hidden under an opaque layer are
+//	   dropped, and when a layer moves only it and the layers in front of
+//	   it are composited again, over a cached copy of the ones behind.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CParallaxBackground Specific Includes
+//-----------------------------------------------------------------------------
+#include "ParallaxBackground.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const DWORD PIXEL_OPAQUE	= 0xFF000000;	// Alpha byte marking an opaque strip pixel
+const DWORD PIXEL_RGB		= 0x00FFFFFF;
+const DWORD CLEAR_COLOR		= 0x00FFFFFF;	// Same white BackBuffer::reset() clears to
+
+//-----------------------------------------------------------------------------
+// Name : IsLayerOpaque () (Static)
+// Desc : A layer is opaque if it is not keyed or no pixel matches its key.
+//-----------------------------------------------------------------------------
+static bool IsLayerOpaque(const std::vector<DWORD>& pixels, bool bColorKey, DWORD dwKey)
+{
+	if (!bColorKey)
+		return true;
+
+	for (size_t i = 0; i < pixels.size(); i++)
+		if ((pixels[i] & PIXEL_RGB) == dwKey)
+			return false;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CParallaxBackground () (Constructor)
+// Desc : CParallaxBackground Class Constructor
+//-----------------------------------------------------------------------------
+CParallaxBackground::CParallaxBackground()
+{
+	m_hMemDC		= NULL;
+	m_hOldBitmap	= NULL;
+	m_hComposite	= NULL;
+	m_pComposite	= NULL;
+	m_iWidth		= 0;
+	m_iHeight		= 0;
+	m_iDirtyFrom	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CParallaxBackground () (Destructor)
+// Desc : CParallaxBackground Class Destructor
+//-----------------------------------------------------------------------------
+CParallaxBackground::~CParallaxBackground()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddLayer ()
+// Desc : Loads an opaque layer.
+//-----------------------------------------------------------------------------
+bool CParallaxBackground::AddLayer(const char *szFileName, HDC hdc, float fSpeed)
+{
+	if (!AddLayer(szFileName, hdc, fSpeed, RGB(0xff, 0x00, 0xff)))
+		return false;
+
+	m_Layers.back().bColorKey = false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddLayer ()
+// Desc : Loads a layer whose pixels matching crColorKey are see-through.
+//-----------------------------------------------------------------------------
+bool CParallaxBackground::AddLayer(const char *szFileName, HDC hdc, float fSpeed, COLORREF crColorKey)
+{
+	CImageFile image;
+	if (!image.LoadBitmapFromFile(szFileName, hdc))
+		return false;
+
+	if (image.Width() <= 0 || image.Height() <= 0)
+		return false;
+
+	m_Layers.push_back(Layer());
+	Layer& layer = m_Layers.back();
+
+	layer.iWidth	= image.Width();
+	layer.iHeight	= image.Height();
+	layer.fSpeed	= fSpeed;
+	layer.bColorKey = true;
+	layer.dwKey		= (GetRValue(crColorKey) << 16) | (GetGValue(crColorKey) << 8) | GetBValue(crColorKey);
+	layer.Pixels.resize(layer.iWidth * layer.iHeight);
+
+	// CImageFile keeps the rows bottom-up, flip them while copying
+	const DWORD *pSrc = (const DWORD*)image.Pixels();
+	for (int y = 0; y < layer.iHeight; y++)
+		memcpy(&layer.Pixels[y * layer.iWidth], &pSrc[(layer.iHeight - 1 - y) * layer.iWidth], layer.iWidth * sizeof(DWORD));
+
+	m_iDirtyFrom = 0;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Converts the visible layers into view-wide strips. Layers under the
+//		top-most opaque layer are skipped, and neighbouring layers that scroll
+//		together are flattened into a single strip.
+//-----------------------------------------------------------------------------
+bool CParallaxBackground::Build(HDC hdc, int iWidth, int iHeight)
+{
+	Release();
+
+	if (m_Layers.empty() || iWidth <= 0 || iHeight <= 0)
+		return false;
+
+	m_iWidth  = iWidth;
+	m_iHeight = iHeight;
+
+	// Nothing below the top-most opaque layer can ever be seen
+	size_t first = 0;
+	for (size_t i = 0; i < m_Layers.size(); i++)
+	{
+		const Layer& layer = m_Layers[i];
+		if (IsLayerOpaque(layer.Pixels, layer.bColorKey, layer.dwKey))
+			first = i;
+	}
+
+	for (size_t i = first; i < m_Layers.size(); i++)
+	{
+		Strip strip;
+		if (!BuildStrip(hdc, m_Layers[i], strip))
+		{
+			Release();
+			return false;
+		}
+
+		// Layers that always move together only need to be composited once
+		if (!m_Strips.empty() && m_Strips.back().fSpeed == strip.fSpeed && m_Strips.back().iHeight == strip.iHeight)
+		{
+			MergeStrip(m_Strips.back(), strip);
+			DeleteObject(strip.hBitmap);
+			continue;
+		}
+
+		m_Strips.push_back(strip);
+	}
+
+	m_hMemDC = CreateCompatibleDC(hdc);
+
+	if (m_Strips.size() == 1 && m_Strips[0].bOpaque)
+	{
+		// A single opaque strip is blitted straight from its cache
+		m_hOldBitmap = (HBITMAP)SelectObject(m_hMemDC, m_Strips[0].hBitmap);
+	}
+	else
+	{
+		m_hComposite = CreateTopDownDIB(hdc, m_iWidth, m_iHeight, (void**)&m_pComposite);
+		if (!m_hComposite)
+		{
+			Release();
+			return false;
+		}
+
+		m_hOldBitmap = (HBITMAP)SelectObject(m_hMemDC, m_hComposite);
+		m_Behind.resize(m_Strips.size() - 1);
+		for (size_t i = 0; i < m_Behind.size(); i++)
+			m_Behind[i].resize(m_iWidth * m_iHeight);
+	}
+
+	m_iDirtyFrom = 0;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the strip caches. Loaded layers are kept so Build can be
+//		called again, e.g. when the viewport changes size.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::Release()
+{
+	if (m_hMemDC)
+	{
+		SelectObject(m_hMemDC, m_hOldBitmap);
+		DeleteDC(m_hMemDC);
+		m_hMemDC = NULL;
+	}
+
+	if (m_hComposite)
+	{
+		DeleteObject(m_hComposite);
+		m_hComposite = NULL;
+		m_pComposite = NULL;
+	}
+
+	for (size_t i = 0; i < m_Strips.size(); i++)
+		DeleteObject(m_Strips[i].hBitmap);
+
+	m_Strips.clear();
+	m_Behind.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildStrip () (Private)
+// Desc : Tiles a layer horizontally across the view width. Opaque pixels get
+//		their alpha byte set so keyed layers can be flattened later.
+//-----------------------------------------------------------------------------
+bool CParallaxBackground::BuildStrip(HDC hdc, const Layer& layer, Strip& strip)
+{
+	strip.hBitmap = CreateTopDownDIB(hdc, m_iWidth, layer.iHeight, (void**)&strip.pBits);
+	if (!strip.hBitmap)
+		return false;
+
+	strip.iHeight	= layer.iHeight;
+	strip.fSpeed	= layer.fSpeed;
+	strip.fOffset	= 0.0f;
+	strip.iRow		= 0;
+	strip.bOpaque	= IsLayerOpaque(layer.Pixels, layer.bColorKey, layer.dwKey);
+
+	for (int y = 0; y < layer.iHeight; y++)
+	{
+		const DWORD *pSrc = &layer.Pixels[y * layer.iWidth];
+		DWORD *pDst = &strip.pBits[y * m_iWidth];
+
+		for (int x = 0; x < m_iWidth; x++)
+		{
+			DWORD c = pSrc[x % layer.iWidth] & PIXEL_RGB;
+			if (strip.bOpaque || c != layer.dwKey)
+				pDst[x] = c | PIXEL_OPAQUE;
+			else
+				pDst[x] = 0;
+		}
+	}
+
+	BuildSpans(strip);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildSpans () (Private)
+// Desc : Records the runs of opaque pixels on every row of a keyed strip so
+//		compositing never touches its transparent pixels.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::BuildSpans(Strip& strip)
+{
+	strip.Spans.clear();
+	strip.RowSpans.clear();
+
+	if (strip.bOpaque)
+		return;
+
+	strip.RowSpans.reserve(strip.iHeight + 1);
+
+	for (int y = 0; y < strip.iHeight; y++)
+	{
+		const DWORD *pRow = &strip.pBits[y * m_iWidth];
+		strip.RowSpans.push_back((int)strip.Spans.size());
+
+		int x = 0;
+		while (x < m_iWidth)
+		{
+			// skip transparent pixels
+			while (x < m_iWidth && !(pRow[x] & PIXEL_OPAQUE))
+				x++;
+
+			if (x == m_iWidth)
+				break;
+
+			Span span;
+			span.iStart = x;
+			while (x < m_iWidth && (pRow[x] & PIXEL_OPAQUE))
+				x++;
+			span.iCount = x - span.iStart;
+
+			strip.Spans.push_back(span);
+		}
+	}
+
+	strip.RowSpans.push_back((int)strip.Spans.size());
+}
+
+//-----------------------------------------------------------------------------
+// Name : MergeStrip () (Private)
+// Desc : Flattens src on top of dst. Both strips must share speed and height.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::MergeStrip(Strip& dst, const Strip& src)
+{
+	if (src.bOpaque)
+	{
+		memcpy(dst.pBits, src.pBits, m_iWidth * src.iHeight * sizeof(DWORD));
+		dst.bOpaque = true;
+	}
+	else
+	{
+		for (int y = 0; y < src.iHeight; y++)
+		{
+			for (int s = src.RowSpans[y]; s < src.RowSpans[y + 1]; s++)
+			{
+				const Span& span = src.Spans[s];
+				int i = y * m_iWidth + span.iStart;
+				memcpy(&dst.pBits[i], &src.pBits[i], span.iCount * sizeof(DWORD));
+			}
+		}
+	}
+
+	BuildSpans(dst);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+// Desc : Scrolls every strip. The composite is only marked dirty, from the
+//		back-most strip that moved by at least one whole row.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::Update(float dt)
+{
+	for (size_t i = 0; i < m_Strips.size(); i++)
+	{
+		Strip& strip = m_Strips[i];
+
+		strip.fOffset = fmodf(strip.fOffset + strip.fSpeed * dt, (float)strip.iHeight);
+		if (strip.fOffset < 0)
+			strip.fOffset += strip.iHeight;
+
+		// Content moves down the screen, so the top row walks backwards through the strip
+		int iRow = (strip.iHeight - (int)strip.fOffset) % strip.iHeight;
+		if (iRow != strip.iRow)
+		{
+			strip.iRow = iRow;
+			m_iDirtyFrom = min(m_iDirtyFrom, i);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Paint ()
+// Desc : Copies the background into hdc, rebuilding the composite if needed.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::Paint(HDC hdc)
+{
+	if (!m_hMemDC)
+		return;
+
+	if (!m_hComposite)
+	{
+		BlitStrip(hdc, m_Strips[0]);
+		return;
+	}
+
+	if (m_iDirtyFrom < m_Strips.size())
+		Composite();
+
+	BitBlt(hdc, 0, 0, m_iWidth, m_iHeight, m_hMemDC, 0, 0, SRCCOPY);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BlitStrip () (Private)
+// Desc : Copies a wrapped strip selected into the memory DC straight to hdc.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::BlitStrip(HDC hdc, const Strip& strip)
+{
+	for (int y = 0; y < m_iHeight; )
+	{
+		int iRow = (strip.iRow + y) % strip.iHeight;
+		int iCount = min(strip.iHeight - iRow, m_iHeight - y);
+
+		BitBlt(hdc, 0, y, m_iWidth, iCount, m_hMemDC, 0, iRow, SRCCOPY);
+		y += iCount;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Composite () (Private)
+// Desc : Rebuilds the composite from the back-most strip that moved. What
+//		is behind it comes from the cache, and the cache of each strip
+//		drawn is refreshed for the next time one in front of it moves.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::Composite()
+{
+	// Make sure GDI is done with the DIB before touching its bits
+	GdiFlush();
+
+	size_t iFirst = m_iDirtyFrom;
+	size_t nPixels = m_iWidth * m_iHeight;
+
+	if (iFirst > 0)
+	{
+		memcpy(m_pComposite, &m_Behind[iFirst - 1][0], nPixels * sizeof(DWORD));
+	}
+	else if (!m_Strips[0].bOpaque)
+	{
+		for (size_t i = 0; i < nPixels; i++)
+			m_pComposite[i] = CLEAR_COLOR;
+	}
+
+	for (size_t i = iFirst; i < m_Strips.size(); i++)
+	{
+		CompositeStrip(m_Strips[i]);
+		if (i < m_Behind.size())
+			memcpy(&m_Behind[i][0], m_pComposite, nPixels * sizeof(DWORD));
+	}
+
+	m_iDirtyFrom = m_Strips.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CompositeStrip () (Private)
+// Desc : Draws one strip over the composite. Opaque strips are copied in
+//		whole blocks of rows, keyed ones span by span.
+//-----------------------------------------------------------------------------
+void CParallaxBackground::CompositeStrip(const Strip& strip)
+{
+	for (int y = 0; y < m_iHeight; )
+	{
+		int iRow = (strip.iRow + y) % strip.iHeight;
+		int iCount = min(strip.iHeight - iRow, m_iHeight - y);
+
+		if (strip.bOpaque)
+		{
+			memcpy(&m_pComposite[y * m_iWidth], &strip.pBits[iRow * m_iWidth], iCount * m_iWidth * sizeof(DWORD));
+		}
+		else
+		{
+			for (int r = 0; r < iCount; r++)
+			{
+				DWORD *pDst = &m_pComposite[(y + r) * m_iWidth];
+				const DWORD *pSrc = &strip.pBits[(iRow + r) * m_iWidth];
+
+				for (int s = strip.RowSpans[iRow + r]; s < strip.RowSpans[iRow + r + 1]; s++)
+				{
+					const Span& span = strip.Spans[s];
+					memcpy(&pDst[span.iStart], &pSrc[span.iStart], span.iCount * sizeof(DWORD));
+				}
+			}
+		}
+
+		y += iCount;
+	}
+}
@@ -0,0 +1,378 @@
+//-----------------------------------------------------------------------------
+// File: ParticleSystem.cpp
+//
+// Desc: Pooled particles. Update() has scalar, SSE2 and AVX2 kernels,
+//	   chosen by the path BoxBatch picked for the CPU. Drawing writes the
+//	   surface's pixels directly: additive particles with a saturating add
+//	   of four channels at once, keyed ones through an ordered dither that
+//	   thins them out as they fade.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CParticleSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "ParticleSystem.h"
+#include "BoxBatch.h"
+#include "MathDefs.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define PARTICLES_X86
+	#include <immintrin.h>
+#endif
+
+#if defined(PARTICLES_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define PARTICLES_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define PARTICLES_TARGET(isa)
+#endif
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	// 4x4 ordered dither; a keyed pixel is drawn while its fade, in 16ths,
+	// is above the threshold for its place on the surface
+	const int DITHER[4][4] =
+	{
+		{  0,  8,  2, 10 },
+		{ 12,  4, 14,  6 },
+		{  3, 11,  1,  9 },
+		{ 15,  7, 13,  5 },
+	};
+
+	//-------------------------------------------------------------------------
+	// Name : AddSaturate ()
+	// Desc : Adds two pixels channel by channel, clamping each at 255.
+	//-------------------------------------------------------------------------
+	inline uint32_t AddSaturate( uint32_t a, uint32_t b )
+	{
+		uint32_t uSum	= (a & 0x7F7F7F7F) + (b & 0x7F7F7F7F);
+		uint32_t uCarry	= ((a & b) | ((a | b) & uSum)) & 0x80808080;
+
+		uSum ^= (a ^ b) & 0x80808080;
+		return uSum | ((uCarry >> 7) * 0xFF);
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : ScaleColour ()
+	// Desc : uScale is out of 256.
+	//-------------------------------------------------------------------------
+	inline uint32_t ScaleColour( uint32_t uColour, uint32_t uScale )
+	{
+		return (((uColour & 0xFF00FF) * uScale >> 8) & 0xFF00FF) | (((uColour & 0x00FF00) * uScale >> 8) & 0x00FF00);
+	}
+
+	struct ParticleArrays
+	{
+		float		*x, *y, *vx, *vy, *life, *fade;
+		const float	*invLife, *drag, *gravity;
+	};
+
+	//-------------------------------------------------------------------------
+	// Name : UpdateScalar ()
+	// Desc : Reference kernel, also used for the tail the vector kernels
+	//		leave. Drag never turns a particle round, however long the step.
+	//-------------------------------------------------------------------------
+	void UpdateScalar( const ParticleArrays& p, size_t iStart, size_t n, float dt )
+	{
+		for (size_t i = iStart; i < n; i++)
+		{
+			float fKeep = 1.0f - p.drag[i] * dt;
+			if (fKeep < 0)
+				fKeep = 0;
+
+			p.vx[i] = p.vx[i] * fKeep;
+			p.vy[i] = p.vy[i] * fKeep + p.gravity[i] * dt;
+			p.x[i] += p.vx[i] * dt;
+			p.y[i] += p.vy[i] * dt;
+			p.life[i] -= dt;
+
+			float fFade = p.life[i] * p.invLife[i];
+			p.fade[i] = fFade > 0 ? fFade : 0;
+		}
+	}
+
+#ifdef PARTICLES_X86
+	//-------------------------------------------------------------------------
+	// Name : UpdateSSE2 ()
+	//-------------------------------------------------------------------------
+	PARTICLES_TARGET("sse2")
+	void UpdateSSE2( const ParticleArrays& p, size_t n, float dt )
+	{
+		__m128 step = _mm_set1_ps(dt), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128 keep = _mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(p.drag + i), step)), zero);
+
+			__m128 vx = _mm_mul_ps(_mm_loadu_ps(p.vx + i), keep);
+			__m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p.vy + i), keep), _mm_mul_ps(_mm_loadu_ps(p.gravity + i), step));
+			_mm_storeu_ps(p.vx + i, vx);
+			_mm_storeu_ps(p.vy + i, vy);
+			_mm_storeu_ps(p.x + i, _mm_add_ps(_mm_loadu_ps(p.x + i), _mm_mul_ps(vx, step)));
+			_mm_storeu_ps(p.y + i, _mm_add_ps(_mm_loadu_ps(p.y + i), _mm_mul_ps(vy, step)));
+
+			__m128 life = _mm_sub_ps(_mm_loadu_ps(p.life + i), step);
+			_mm_storeu_ps(p.life + i, life);
+			_mm_storeu_ps(p.fade + i, _mm_max_ps(_mm_mul_ps(life, _mm_loadu_ps(p.invLife + i)), zero));
+		}
+
+		UpdateScalar(p, i, n, dt);
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : UpdateAVX2 ()
+	//-------------------------------------------------------------------------
+	PARTICLES_TARGET("avx2")
+	void UpdateAVX2( const ParticleArrays& p, size_t n, float dt )
+	{
+		__m256 step = _mm256_set1_ps(dt), one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256 keep = _mm256_max_ps(_mm256_sub_ps(one, _mm256_mul_ps(_mm256_loadu_ps(p.drag + i), step)), zero);
+
+			__m256 vx = _mm256_mul_ps(_mm256_loadu_ps(p.vx + i), keep);
+			__m256 vy = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(p.vy + i), keep),
+									  _mm256_mul_ps(_mm256_loadu_ps(p.gravity + i), step));
+			_mm256_storeu_ps(p.vx + i, vx);
+			_mm256_storeu_ps(p.vy + i, vy);
+			_mm256_storeu_ps(p.x + i, _mm256_add_ps(_mm256_loadu_ps(p.x + i), _mm256_mul_ps(vx, step)));
+			_mm256_storeu_ps(p.y + i, _mm256_add_ps(_mm256_loadu_ps(p.y + i), _mm256_mul_ps(vy, step)));
+
+			__m256 life = _mm256_sub_ps(_mm256_loadu_ps(p.life + i), step);
+			_mm256_storeu_ps(p.life + i, life);
+			_mm256_storeu_ps(p.fade + i, _mm256_max_ps(_mm256_mul_ps(life, _mm256_loadu_ps(p.invLife + i)), zero));
+		}
+
+		UpdateScalar(p, i, n, dt);
+	}
+#endif // PARTICLES_X86
+}
+
+//-----------------------------------------------------------------------------
+// Particle Presets
+//-----------------------------------------------------------------------------
+// By PARTICLE_PRESET: count, speed range, life range, drag, gravity, start
+// radius, colour, size and blend. Smoke has negative gravity and rises.
+const ParticlePreset CParticleSystem::m_Presets[PARTICLE_PRESET_COUNT] =
+{
+	{ 48,	40,	 160,	0.35f,	0.8f,	2.5f,	   0,	 6,	0xFF9020,	4,	PARTICLE_BLEND_ADD },	// Explosion
+	{ 24,	10,	  45,	0.8f,	1.6f,	1.2f,	 -20,	10,	0x505050,	5,	PARTICLE_BLEND_KEY },	// Smoke
+	{ 32,	150, 320,	0.2f,	0.5f,	1.0f,	 220,	 2,	0xFFE080,	2,	PARTICLE_BLEND_ADD },	// Sparks
+};
+
+//-----------------------------------------------------------------------------
+// CParticleSystem Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CParticleSystem () (Constructor)
+// Desc : CParticleSystem Class Constructor
+//-----------------------------------------------------------------------------
+CParticleSystem::CParticleSystem()
+{
+	m_nCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CParticleSystem () (Destructor)
+// Desc : CParticleSystem Class Destructor
+//-----------------------------------------------------------------------------
+CParticleSystem::~CParticleSystem()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates room for nCapacity particles. This is the only allocation
+//		the system makes; existing particles are dropped.
+//-----------------------------------------------------------------------------
+void CParticleSystem::Create( size_t nCapacity )
+{
+	m_X.assign(nCapacity, 0);		m_Y.assign(nCapacity, 0);
+	m_VelX.assign(nCapacity, 0);	m_VelY.assign(nCapacity, 0);
+	m_Life.assign(nCapacity, 0);	m_InvLifetime.assign(nCapacity, 0);
+	m_Fade.assign(nCapacity, 0);
+	m_Drag.assign(nCapacity, 0);	m_Gravity.assign(nCapacity, 0);
+	m_Colour.assign(nCapacity, 0);
+	m_Size.assign(nCapacity, 0);
+	m_Blend.assign(nCapacity, 0);
+
+	m_nCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Emit ()
+//-----------------------------------------------------------------------------
+size_t CParticleSystem::Emit( const ParticlePreset& preset, float x, float y )
+{
+	size_t nFree = m_X.size() - m_nCount;
+	size_t n = preset.nCount > 0 ? (size_t)preset.nCount : 0;
+	if (n > nFree)
+		n = nFree;
+
+	uint8_t uSize = (uint8_t)(preset.iSize < 1 ? 1 : preset.iSize > 255 ? 255 : preset.iSize);
+
+	for (size_t k = 0; k < n; k++)
+	{
+		size_t i = m_nCount++;
+
+		float fAngle	= m_Random.Range(0, (float)(2 * PI));
+		float fDirX		= cosf(fAngle);
+		float fDirY		= sinf(fAngle);
+		float fRadius	= preset.fRadius * m_Random.NextFloat();
+		float fSpeed	= m_Random.Range(preset.fSpeedMin, preset.fSpeedMax);
+		float fLife		= m_Random.Range(preset.fLifeMin, preset.fLifeMax);
+
+		m_X[i]				= x + fDirX * fRadius;
+		m_Y[i]				= y + fDirY * fRadius;
+		m_VelX[i]			= fDirX * fSpeed;
+		m_VelY[i]			= fDirY * fSpeed;
+		m_Life[i]			= fLife;
+		m_InvLifetime[i]	= fLife > 0 ? 1.0f / fLife : 0;
+		m_Fade[i]			= 1.0f;
+		m_Drag[i]			= preset.fDrag;
+		m_Gravity[i]		= preset.fGravity;
+		m_Colour[i]			= preset.uColour & 0xFFFFFF;
+		m_Size[i]			= uSize;
+		m_Blend[i]			= (uint8_t)preset.Blend;
+	}
+
+	return n;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+//-----------------------------------------------------------------------------
+void CParticleSystem::Update( float dt )
+{
+	ParticleArrays p = { m_X.data(), m_Y.data(), m_VelX.data(), m_VelY.data(), m_Life.data(), m_Fade.data(),
+						 m_InvLifetime.data(), m_Drag.data(), m_Gravity.data() };
+
+	switch (BoxBatchGetPath())
+	{
+#ifdef PARTICLES_X86
+	case BOXBATCH_AVX2:	UpdateAVX2(p, m_nCount, dt); break;
+	case BOXBATCH_SSE2:	UpdateSSE2(p, m_nCount, dt); break;
+#endif
+	default:			UpdateScalar(p, 0, m_nCount, dt); break;
+	}
+
+	// From the back, so the particle swapped in has been checked already
+	for (size_t i = m_nCount; i-- > 0; )
+	{
+		if (m_Life[i] <= 0)
+			RemoveAt(i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : World and window coordinates are the same here.
+//-----------------------------------------------------------------------------
+void CParticleSystem::Draw( uint32_t *pBits, int iWidth, int iHeight, float fScale ) const
+{
+	CCamera camera;
+	float fWidth = iWidth / fScale, fHeight = iHeight / fScale;
+
+	camera.SetWorldBounds(fWidth, fHeight);
+	camera.SetViewport(0, 0, (int)ceilf(fWidth), (int)ceilf(fHeight));
+	camera.LookAt(0, 0);
+	Draw(pBits, iWidth, iHeight, camera, fScale);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Each particle is a square of its size centred on it, clipped to
+//		the camera's viewport on the surface.
+//-----------------------------------------------------------------------------
+void CParticleSystem::Draw( uint32_t *pBits, int iWidth, int iHeight, const CCamera& camera, float fScale ) const
+{
+	static const uint8_t Passes[] = { PARTICLE_BLEND_KEY, PARTICLE_BLEND_ADD };
+
+	// World to surface is the camera's transform then fScale
+	float fZoom		= camera.GetZoom() * fScale;
+	float fOffsetX, fOffsetY;
+	camera.WorldToScreen(0, 0, fOffsetX, fOffsetY);
+	fOffsetX *= fScale;
+	fOffsetY *= fScale;
+
+	int iClipLeft	= std::max(0, (int)(camera.GetViewportX() * fScale));
+	int iClipTop	= std::max(0, (int)(camera.GetViewportY() * fScale));
+	int iClipRight	= std::min(iWidth, (int)ceilf((camera.GetViewportX() + camera.GetViewportWidth()) * fScale));
+	int iClipBottom	= std::min(iHeight, (int)ceilf((camera.GetViewportY() + camera.GetViewportHeight()) * fScale));
+
+	for (size_t iPass = 0; iPass < sizeof(Passes); iPass++)
+	{
+		for (size_t i = 0; i < m_nCount; i++)
+		{
+			if (m_Blend[i] != Passes[iPass])
+				continue;
+
+			int iSize	= (int)(m_Size[i] * fZoom + 0.5f);
+			if (iSize < 1)
+				iSize = 1;
+
+			int x0 = (int)floorf(m_X[i] * fZoom + fOffsetX) - iSize / 2, x1 = x0 + iSize;
+			int y0 = (int)floorf(m_Y[i] * fZoom + fOffsetY) - iSize / 2, y1 = y0 + iSize;
+			if (x0 < iClipLeft) x0 = iClipLeft;
+			if (y0 < iClipTop) y0 = iClipTop;
+			if (x1 > iClipRight) x1 = iClipRight;
+			if (y1 > iClipBottom) y1 = iClipBottom;
+			if (x0 >= x1 || y0 >= y1)
+				continue;
+
+			if (Passes[iPass] == PARTICLE_BLEND_ADD)
+			{
+				uint32_t uColour = ScaleColour(m_Colour[i], (uint32_t)(m_Fade[i] * 256.0f));
+
+				for (int y = y0; y < y1; y++)
+				{
+					uint32_t *pRow = pBits + (size_t)y * iWidth;
+					for (int x = x0; x < x1; x++)
+						pRow[x] = AddSaturate(pRow[x], uColour);
+				}
+			}
+			else
+			{
+				int iLevel = (int)(m_Fade[i] * 16.0f + 0.5f);
+
+				for (int y = y0; y < y1; y++)
+				{
+					uint32_t *pRow = pBits + (size_t)y * iWidth;
+					const int *pDither = DITHER[y & 3];
+					for (int x = x0; x < x1; x++)
+					{
+						if (iLevel > pDither[x & 3])
+							pRow[x] = m_Colour[i];
+					}
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveAt () (Private)
+// Desc : The last live particle moves into the hole.
+//-----------------------------------------------------------------------------
+void CParticleSystem::RemoveAt( size_t iIndex )
+{
+	size_t iLast = --m_nCount;
+	if (iIndex == iLast)
+		return;
+
+	m_X[iIndex]				= m_X[iLast];			m_Y[iIndex]			= m_Y[iLast];
+	m_VelX[iIndex]			= m_VelX[iLast];		m_VelY[iIndex]		= m_VelY[iLast];
+	m_Life[iIndex]			= m_Life[iLast];		m_InvLifetime[iIndex] = m_InvLifetime[iLast];
+	m_Fade[iIndex]			= m_Fade[iLast];
+	m_Drag[iIndex]			= m_Drag[iLast];		m_Gravity[iIndex]	= m_Gravity[iLast];
+	m_Colour[iIndex]		= m_Colour[iLast];
+	m_Size[iIndex]			= m_Size[iLast];
+	m_Blend[iIndex]			= m_Blend[iLast];
+}
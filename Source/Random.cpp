@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// File: Random.cpp
+//
+// Desc: Seeding, jumps and batch fills for CRandom. The generator is
+//	   xoshiro256** by Blackman and Vigna; seeds are spread over its state
+//	   with splitmix64 as they recommend.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRandom Specific Includes
+//-----------------------------------------------------------------------------
+#include "Random.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const uint64_t	JUMP[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+								0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+
+	uint64_t SplitMix( uint64_t& x )
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CRandom Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Seed ()
+// Desc : Stream n is the seed's stream 0 jumped n times, which makes it
+//		disjoint from the others. Streams are few, so the jumps are cheap.
+//-----------------------------------------------------------------------------
+void CRandom::Seed( uint64_t uSeed, uint64_t uStream )
+{
+	uint64_t x = uSeed;
+	for (int i = 0; i < 4; i++)
+		m_State.s[i] = SplitMix(x);
+
+	for (uint64_t i = 0; i < uStream; i++)
+		Jump();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Jump ()
+//-----------------------------------------------------------------------------
+void CRandom::Jump( )
+{
+	uint64_t s[4] = { 0, 0, 0, 0 };
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			if (JUMP[i] & ((uint64_t)1 << b))
+			{
+				for (int j = 0; j < 4; j++)
+					s[j] ^= m_State.s[j];
+			}
+			Next();
+		}
+	}
+
+	for (int j = 0; j < 4; j++)
+		m_State.s[j] = s[j];
+}
+
+//-----------------------------------------------------------------------------
+// Name : FillFloat ()
+// Desc : Uniform in [fMin, fMax), 24 random bits each.
+//-----------------------------------------------------------------------------
+void CRandom::FillFloat( float *pOut, size_t n, float fMin, float fMax )
+{
+	CRandom rng(*this);
+	float fScale = (fMax - fMin) * (1.0f / 16777216.0f);
+
+	for (size_t i = 0; i < n; i++)
+		pOut[i] = fMin + (float)(rng.Next() >> 40) * fScale;
+
+	m_State = rng.m_State;
+}
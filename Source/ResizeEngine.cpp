@@ -1,5 +1,11 @@
 #include "ResizeEngine.h"
 
+// Rows and columns per job; each writes only its own part of the result
+static const size_t ROW_JOB_GRAIN = 16;
+static const size_t COL_JOB_GRAIN = 64;		// wide enough that jobs rarely share a cache line
+
+CJobSystem *CResizableImage::s_pJobs = NULL;
+
 CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize) 
 {
 	DWORD u;
@@ -93,6 +99,16 @@ CWeightsTable::~CWeightsTable()
 }
 
 
+// Filters with negative lobes (bicubic, lanczos) can overshoot the byte range
+static inline BYTE ClampChannel(double v)
+{
+	if (v <= 0.0)
+		return 0;
+	if (v >= 255.0)
+		return 255;
+	return (BYTE)(v + 0.5);
+}
+
 void CResizableImage::ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row)
 {
 	RGBQUAD *pDstRow = &(m_pResImg[row * dst_width]);
@@ -101,23 +117,23 @@ void CResizableImage::ScaleRow(unsigned int dst_width, unsigned int /*dst_height
 	for (UINT x = 0; x < dst_width; x++) 
 	{
 		// Loop through row
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
+		double r = 0;
+		double g = 0;
+		double b = 0;
 		int iLeft = m_pWeights->getLeftBoundary(x);	// Retrieve left boundries
 		int iRight = m_pWeights->getRightBoundary(x);  // Retrieve right boundries
 		for (int i = iLeft; i <= iRight; i++)
 		{
 			// Scan between boundries
 			// Accumulate weighted effect of each neighboring pixel
-			r += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbRed)); 
-			g += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbGreen)); 
-			b += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbBlue)); 
+			r += m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbRed); 
+			g += m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbGreen); 
+			b += m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbBlue); 
 		} 
 		// set destination row
-		pDstRow[x].rgbRed = r;
-		pDstRow[x].rgbGreen = g;
-		pDstRow[x].rgbBlue = b;
+		pDstRow[x].rgbRed = ClampChannel(r);
+		pDstRow[x].rgbGreen = ClampChannel(g);
+		pDstRow[x].rgbBlue = ClampChannel(b);
 		pDstRow[x].rgbReserved = 0;
 	}
 }
@@ -129,15 +145,24 @@ void CResizableImage::HorizontalFilter(unsigned int dst_width, unsigned int dst_
 	{
 		// No scaling required, just copy
 		memcpy (m_pResImg, m_pRGB, sizeof(RGBQUAD) * width * height);
+		return;
 	}
 	
 	m_pWeights = new CWeightsTable(m_pFilter, dst_width, width);
 
-	for (UINT u = 0; u < dst_height; u++)
+	auto rows = [&](size_t iBegin, size_t iEnd)
 	{
-		// scale each row
-		ScaleRow (dst_width, dst_width, u);	// Scale each row 
-	}
+		for (size_t u = iBegin; u < iEnd; u++)
+		{
+			// scale each row
+			ScaleRow (dst_width, dst_width, (UINT)u);	// Scale each row 
+		}
+	};
+
+	if (s_pJobs)
+		s_pJobs->ParallelFor(dst_height, ROW_JOB_GRAIN, rows);
+	else
+		rows(0, dst_height);
 
 	delete m_pWeights;
 }
@@ -147,9 +172,9 @@ void CResizableImage::ScaleCol(unsigned int dst_width, unsigned int dst_height,
 	for (UINT y = 0; y < dst_height; y++) 
 	{
 		// Loop through column
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
+		double r = 0;
+		double g = 0;
+		double b = 0;
 		int iLeft = m_pWeights->getLeftBoundary(y);	// Retrieve left boundries
 		int iRight = m_pWeights->getRightBoundary(y);  // Retrieve right boundries
 		for (int i = iLeft; i <= iRight; i++)
@@ -157,15 +182,15 @@ void CResizableImage::ScaleCol(unsigned int dst_width, unsigned int dst_height,
 			// Scan between boundries
 			// Accumulate weighted effect of each neighboring pixel
 			RGBQUAD &src = m_pRGB[i * width + col];
-			r += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbRed));
-			g += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbGreen));
-			b += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbBlue));
+			r += m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbRed);
+			g += m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbGreen);
+			b += m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbBlue);
 		}
 
 		RGBQUAD &dst = m_pResImg[y * dst_width + col];
-		dst.rgbRed = r;
-		dst.rgbGreen = g;
-		dst.rgbBlue = b;
+		dst.rgbRed = ClampChannel(r);
+		dst.rgbGreen = ClampChannel(g);
+		dst.rgbBlue = ClampChannel(b);
 		dst.rgbReserved = 0;
 	}
 }
@@ -177,15 +202,24 @@ void CResizableImage::VerticalFilter(unsigned int dst_width, unsigned int dst_he
 	{
 		// No scaling required, just copy
 		memcpy(m_pResImg, m_pRGB, sizeof (RGBQUAD) * width * height);
+		return;
 	}
 	
 	m_pWeights = new CWeightsTable(m_pFilter, dst_height, height);
 
-	for (UINT u = 0; u < dst_width; u++)
+	auto cols = [&](size_t iBegin, size_t iEnd)
 	{
-		// Step through columns
-		ScaleCol(dst_width, dst_height, u);   // Scale each column
-	}
+		for (size_t u = iBegin; u < iEnd; u++)
+		{
+			// Step through columns
+			ScaleCol(dst_width, dst_height, (UINT)u);   // Scale each column
+		}
+	};
+
+	if (s_pJobs)
+		s_pJobs->ParallelFor(dst_width, COL_JOB_GRAIN, cols);
+	else
+		cols(0, dst_width);
 
 	delete m_pWeights;
 }
@@ -199,7 +233,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 
 		HorizontalFilter(dst_width, height);
 		
-		delete m_pRGB;
+		delete [] m_pRGB;
 		m_pRGB = m_pResImg;
 		width = dst_width;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -211,7 +245,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		m_pResImg = new RGBQUAD[width * dst_height];
 		VerticalFilter(width, dst_height);
 		
-		delete m_pRGB;
+		delete [] m_pRGB;
 		m_pRGB = m_pResImg;
 		height = dst_height;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -219,11 +253,119 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		HorizontalFilter(dst_width, dst_height);
 	}
 
-	delete m_pRGB;
+	delete [] m_pRGB;
 	m_pRGB = m_pResImg;
 	width = dst_width;
 	height = dst_height;
 
 	DeleteObject(m_hBMP);
 	m_hBMP = 0;
-}
\ No newline at end of file
+}
+
+
+// Blends two 0x00RRGGBB pixels, w is the weight of b in 1/256ths. Red and
+// blue are blended together in one multiply, green in another.
+static inline DWORD LerpPixel(DWORD a, DWORD b, int w)
+{
+	DWORD rb = (((a & 0xFF00FF) * (256 - w) + (b & 0xFF00FF) * w) >> 8) & 0xFF00FF;
+	DWORD g = (((a & 0x00FF00) * (256 - w) + (b & 0x00FF00) * w) >> 8) & 0x00FF00;
+	return rb | g;
+}
+
+void CFastResampler::BuildAxis(std::vector<int>& index, std::vector<int>& weight, int src_size, int dst_size)
+{
+	index.resize(dst_size);
+	weight.resize(dst_size);
+
+	double dScale = double(src_size) / double(dst_size);
+	for (int u = 0; u < dst_size; u++)
+	{
+		// sample at pixel centres
+		double dCenter = (u + 0.5) * dScale - 0.5;
+		if (dCenter < 0)
+			dCenter = 0;
+
+		int i = (int)dCenter;
+		if (i >= src_size - 1)
+		{
+			index[u] = src_size - 1;
+			weight[u] = 0;
+		}
+		else
+		{
+			index[u] = i;
+			weight[u] = (int)((dCenter - i) * 256.0);
+		}
+	}
+}
+
+void CFastResampler::ScaleRow(const DWORD *pSrcRow, DWORD *pDstRow)
+{
+	for (int x = 0; x < m_DstWidth; x++)
+	{
+		int i = m_XIndex[x];
+		int j = min(i + 1, m_SrcWidth - 1);
+		pDstRow[x] = LerpPixel(pSrcRow[i], pSrcRow[j], m_XWeight[x]);
+	}
+}
+
+void CFastResampler::Resample(const DWORD *pSrc, int src_width, int src_height, DWORD *pDst, int dst_width, int dst_height)
+{
+	if (src_width != m_SrcWidth || src_height != m_SrcHeight || dst_width != m_DstWidth || dst_height != m_DstHeight)
+	{
+		m_SrcWidth = src_width;
+		m_SrcHeight = src_height;
+		m_DstWidth = dst_width;
+		m_DstHeight = dst_height;
+
+		BuildAxis(m_XIndex, m_XWeight, src_width, dst_width);
+		BuildAxis(m_YIndex, m_YWeight, src_height, dst_height);
+
+		m_Rows[0].resize(dst_width);
+		m_Rows[1].resize(dst_width);
+	}
+
+	// rows are rescaled horizontally at most once per call
+	m_RowSrc[0] = m_RowSrc[1] = -1;
+
+	for (int y = 0; y < dst_height; y++)
+	{
+		int i = m_YIndex[y];
+		int j = min(i + 1, src_height - 1);
+
+		// keep row i in slot 0 and row j in slot 1, rescaling only what changed
+		if (m_RowSrc[0] != i)
+		{
+			if (m_RowSrc[1] == i)
+			{
+				m_Rows[0].swap(m_Rows[1]);
+				m_RowSrc[0] = i;
+				m_RowSrc[1] = -1;
+			}
+			else
+			{
+				ScaleRow(&pSrc[i * src_width], &m_Rows[0][0]);
+				m_RowSrc[0] = i;
+			}
+		}
+
+		if (m_RowSrc[1] != j)
+		{
+			ScaleRow(&pSrc[j * src_width], &m_Rows[1][0]);
+			m_RowSrc[1] = j;
+		}
+
+		DWORD *pDstRow = &pDst[y * dst_width];
+		int w = m_YWeight[y];
+
+		if (w == 0)
+		{
+			memcpy(pDstRow, &m_Rows[0][0], dst_width * sizeof(DWORD));
+		}
+		else
+		{
+			for (int x = 0; x < dst_width; x++)
+				pDstRow[x] = LerpPixel(m_Rows[0][x], m_Rows[1][x], w);
+		}
+	}
+}
@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+// File: RotationCache.cpp
+//
+// Desc: Rotated copies of a sprite generated once at load time, so turning
+//	   at run time is only a change of index into the cache.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRotationCache Specific Includes
+//-----------------------------------------------------------------------------
+#include "RotationCache.h"
+#include "Sprite.h"
+#include "Vec2.h"
+
+//-----------------------------------------------------------------------------
+// Name : SnapUnit () (Static)
+// Desc : Rounds cos / sin results that should be exactly 0 or 1, so the
+//		quarter turns come out as exact transpositions.
+//-----------------------------------------------------------------------------
+static double SnapUnit(double v)
+{
+	if (fabs(v) < 1e-9)
+		return 0.0;
+	if (fabs(v - 1.0) < 1e-9)
+		return 1.0;
+	if (fabs(v + 1.0) < 1e-9)
+		return -1.0;
+	return v;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AngleFromStepCount () (Static)
+// Desc : Clockwise angle of step iStep out of iSteps.
+//-----------------------------------------------------------------------------
+static double AngleFromStepCount(int iStep, int iSteps)
+{
+	return 2 * PI * iStep / iSteps;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RotatePixels () (Static)
+// Desc : Rotates top-down pixels about their centre by inverse mapping every
+//		destination pixel into the source and sampling it bilinearly. Colour
+//		is weighted by coverage so the see-through pixels never bleed in.
+//-----------------------------------------------------------------------------
+static void RotatePixels(const DWORD *pSrc, int iWidth, int iHeight, double dRadians,
+						 std::vector<DWORD>& dst, int& iDstWidth, int& iDstHeight)
+{
+	// Source step for one destination pixel along x and along y
+	Vec2 ax(1.0, 0.0), ay(0.0, 1.0);
+	ax.Rotate(-dRadians);
+	ay.Rotate(-dRadians);
+	ax = Vec2(SnapUnit(ax.x), SnapUnit(ax.y));
+	ay = Vec2(SnapUnit(ay.x), SnapUnit(ay.y));
+
+	// Bounding box of the rotated image
+	iDstWidth = (int)ceil(fabs(iWidth * ax.x) + fabs(iHeight * ax.y) - 1e-6);
+	iDstHeight = (int)ceil(fabs(iWidth * ay.x) + fabs(iHeight * ay.y) - 1e-6);
+
+	dst.assign(iDstWidth * iDstHeight, 0);
+
+	for (int y = 0; y < iDstHeight; y++)
+	{
+		for (int x = 0; x < iDstWidth; x++)
+		{
+			// Destination pixel centre, relative to the destination centre,
+			// mapped back into source pixel space
+			double dx = x + 0.5 - iDstWidth / 2.0;
+			double dy = y + 0.5 - iDstHeight / 2.0;
+			double sx = dx * ax.x + dy * ay.x + iWidth / 2.0 - 0.5;
+			double sy = dx * ax.y + dy * ay.y + iHeight / 2.0 - 0.5;
+
+			int x0 = (int)floor(sx);
+			int y0 = (int)floor(sy);
+			double fx = sx - x0;
+			double fy = sy - y0;
+
+			double r = 0, g = 0, b = 0, cover = 0;
+			for (int t = 0; t < 4; t++)
+			{
+				int tx = x0 + (t & 1);
+				int ty = y0 + (t >> 1);
+				if (tx < 0 || ty < 0 || tx >= iWidth || ty >= iHeight)
+					continue;
+
+				DWORD c = pSrc[ty * iWidth + tx];
+				if (!(c & PIXEL_ALPHA_MASK))
+					continue;
+
+				double w = ((t & 1) ? fx : 1.0 - fx) * ((t >> 1) ? fy : 1.0 - fy);
+				r += w * ((c >> 16) & 0xFF);
+				g += w * ((c >> 8) & 0xFF);
+				b += w * (c & 0xFF);
+				cover += w;
+			}
+
+			if (cover < 0.5)
+				continue;
+
+			DWORD ir = (DWORD)min(255.0, r / cover + 0.5);
+			DWORD ig = (DWORD)min(255.0, g / cover + 0.5);
+			DWORD ib = (DWORD)min(255.0, b / cover + 0.5);
+			dst[y * iDstWidth + x] = PIXEL_ALPHA_MASK | (ir << 16) | (ig << 8) | ib;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CRotationCache () (Constructor)
+// Desc : CRotationCache Class Constructor
+//-----------------------------------------------------------------------------
+CRotationCache::CRotationCache()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CRotationCache () (Destructor)
+// Desc : CRotationCache Class Destructor
+//-----------------------------------------------------------------------------
+CRotationCache::~CRotationCache()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Generates the rotations of a sprite's image.
+//-----------------------------------------------------------------------------
+bool CRotationCache::Build(HDC hdc, Sprite *pSprite, int iSteps)
+{
+	std::vector<DWORD> pixels;
+	if (!pSprite || !pSprite->getPixels(pixels))
+		return false;
+
+	return Build(hdc, &pixels[0], pSprite->mImageBM.bmWidth, pSprite->mImageBM.bmHeight, iSteps);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Generates iSteps rotations of top-down pixels whose alpha byte is
+//		set on opaque pixels.
+//-----------------------------------------------------------------------------
+bool CRotationCache::Build(HDC hdc, const DWORD *pPixels, int iWidth, int iHeight, int iSteps)
+{
+	Release();
+
+	if (iSteps <= 0 || iWidth <= 0 || iHeight <= 0)
+		return false;
+
+	std::vector<DWORD> rotated;
+	m_Masks.resize(iSteps);
+
+	for (int i = 0; i < iSteps; i++)
+	{
+		int iDstWidth, iDstHeight;
+		RotatePixels(pPixels, iWidth, iHeight, AngleFromStepCount(i, iSteps), rotated, iDstWidth, iDstHeight);
+		m_Masks[i].Create((const uint32_t *)&rotated[0], iDstWidth, iDstHeight, PIXEL_ALPHA_MASK);
+
+		CMaskedImage *pImage = new CMaskedImage();
+		if (!pImage->Create(hdc, &rotated[0], iDstWidth, iDstHeight))
+		{
+			delete pImage;
+			Release();
+			return false;
+		}
+
+		m_Images.push_back(pImage);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees every rotation.
+//-----------------------------------------------------------------------------
+void CRotationCache::Release()
+{
+	for (size_t i = 0; i < m_Images.size(); i++)
+		delete m_Images[i];
+
+	m_Images.clear();
+	m_Masks.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetImage ()
+// Desc : Rotation for a step, any step index is wrapped into range.
+//-----------------------------------------------------------------------------
+const CMaskedImage* CRotationCache::GetImage(int iStep) const
+{
+	if (m_Images.empty())
+		return NULL;
+
+	return m_Images[WrapStep(iStep)];
+}
+
+//-----------------------------------------------------------------------------
+// Name : WrapStep ()
+// Desc : Wraps a step index, including negative ones, into [0, steps).
+//-----------------------------------------------------------------------------
+int CRotationCache::WrapStep(int iStep) const
+{
+	int n = GetStepCount();
+	if (n == 0)
+		return 0;
+
+	iStep %= n;
+	return iStep < 0 ? iStep + n : iStep;
+}
+
+//-----------------------------------------------------------------------------
+// Name : StepFromAngle ()
+// Desc : Nearest step to a clockwise angle in radians.
+//-----------------------------------------------------------------------------
+int CRotationCache::StepFromAngle(double dRadians) const
+{
+	int n = GetStepCount();
+	if (n == 0)
+		return 0;
+
+	return WrapStep((int)floor(dRadians * n / (2 * PI) + 0.5));
+}
+
+//-----------------------------------------------------------------------------
+// Name : AngleFromStep ()
+// Desc : Clockwise angle in radians of a step.
+//-----------------------------------------------------------------------------
+double CRotationCache::AngleFromStep(int iStep) const
+{
+	return GetStepCount() ? AngleFromStepCount(WrapStep(iStep), GetStepCount()) : 0.0;
+}
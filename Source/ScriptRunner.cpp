@@ -0,0 +1,243 @@
+//-----------------------------------------------------------------------------
+// File: ScriptRunner.cpp
+//
+// Desc: Coroutine scripts resumed from a timing wheel, with their frames
+//	   pooled by size.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CScriptRunner Specific Includes
+//-----------------------------------------------------------------------------
+#include "ScriptRunner.h"
+#include <assert.h>
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const unsigned int	NO_SCRIPT		= ~0u;
+	const size_t		FRAME_STEP		= 64;
+	const size_t		FRAME_BUCKETS	= 32;			// Larger frames are not pooled
+
+	//-------------------------------------------------------------------------
+	// Name : FrameHeader (Struct)
+	// Desc : In front of every frame; 16 bytes keep the frame as aligned as
+	//		operator new's own blocks.
+	//-------------------------------------------------------------------------
+	struct alignas(16) FrameHeader
+	{
+		CScriptRunner*	pRunner;
+		size_t			nBucket;
+	};
+
+	uint64_t PackScript( unsigned int uIndex, unsigned int uGeneration )
+	{
+		return ((uint64_t)uGeneration << 32) | uIndex;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CScriptRunner Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CScriptRunner () (Constructor)
+// Desc : CScriptRunner Class Constructor
+//-----------------------------------------------------------------------------
+CScriptRunner::CScriptRunner()
+{
+	m_pTimers	= NULL;
+	m_uFree		= NO_SCRIPT;
+	m_uRunning	= NO_SCRIPT;
+	m_nActive	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CScriptRunner () (Destructor)
+// Desc : CScriptRunner Class Destructor
+//-----------------------------------------------------------------------------
+CScriptRunner::~CScriptRunner()
+{
+	Clear();
+
+	for (size_t i = 0; i < m_Frames.size(); i++)
+		::operator delete(m_Frames[i]);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+//-----------------------------------------------------------------------------
+ScriptHandle CScriptRunner::Start( ScriptTask task )
+{
+	unsigned int uIndex = m_uFree;
+	if (uIndex != NO_SCRIPT)
+	{
+		m_uFree = m_Scripts[uIndex].uNextFree;
+	}
+	else
+	{
+		uIndex = (unsigned int)m_Scripts.size();
+		m_Scripts.push_back(Script());
+		m_Scripts[uIndex].uGeneration = 0;
+	}
+
+	Script& script	= m_Scripts[uIndex];
+	script.Handle	= task.m_Handle;
+	script.hTimer	= INVALID_TIMER;
+	task.m_Handle	= nullptr;
+
+	script.Handle.promise().pRunner	= this;
+	script.Handle.promise().uIndex	= uIndex;
+	m_nActive++;
+
+	ScriptHandle handle = { uIndex, script.uGeneration };
+	Resume(uIndex);
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Stop ()
+// Desc : Ends a script where it waits. A script can not stop itself, it
+//		returns instead; false then, as for scripts already over.
+//-----------------------------------------------------------------------------
+bool CScriptRunner::Stop( ScriptHandle handle )
+{
+	if (!IsRunning(handle) || handle.uIndex == m_uRunning)
+		return false;
+
+	Release(handle.uIndex);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsRunning ()
+//-----------------------------------------------------------------------------
+bool CScriptRunner::IsRunning( ScriptHandle handle ) const
+{
+	return handle.uIndex < m_Scripts.size() && m_Scripts[handle.uIndex].uGeneration == handle.uGeneration &&
+		   m_Scripts[handle.uIndex].Handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Ends every script, from outside any of them.
+//-----------------------------------------------------------------------------
+void CScriptRunner::Clear( )
+{
+	assert(m_uRunning == NO_SCRIPT);
+
+	for (size_t i = 0; i < m_Scripts.size(); i++)
+	{
+		if (m_Scripts[i].Handle)
+			Release((unsigned int)i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : AllocateFrame ()
+// Desc : Frames are rounded up to 64 bytes and reused by size; a script
+//		function's frames are all one size, so each finds its own again.
+//-----------------------------------------------------------------------------
+void* CScriptRunner::AllocateFrame( size_t nSize )
+{
+	size_t nTotal	= sizeof(FrameHeader) + nSize;
+	size_t nBucket	= (nTotal + FRAME_STEP - 1) / FRAME_STEP - 1;
+	FrameHeader *pHeader;
+
+	if (nBucket >= FRAME_BUCKETS)
+	{
+		pHeader = (FrameHeader*)::operator new(nTotal);
+	}
+	else if (!m_FreeFrames[nBucket].empty())
+	{
+		pHeader = (FrameHeader*)m_FreeFrames[nBucket].back();
+		m_FreeFrames[nBucket].pop_back();
+	}
+	else
+	{
+		pHeader = (FrameHeader*)::operator new((nBucket + 1) * FRAME_STEP);
+		m_Frames.push_back(pHeader);
+	}
+
+	pHeader->pRunner = this;
+	pHeader->nBucket = nBucket;
+	return pHeader + 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FreeFrame () (Static)
+// Desc : Back to the runner the frame came from.
+//-----------------------------------------------------------------------------
+void CScriptRunner::FreeFrame( void *pFrame, size_t /*nSize*/ )
+{
+	FrameHeader *pHeader = (FrameHeader*)pFrame - 1;
+
+	if (pHeader->nBucket >= FRAME_BUCKETS)
+		::operator delete(pHeader);
+	else
+		pHeader->pRunner->m_FreeFrames[pHeader->nBucket].push_back(pHeader);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Suspend () (Private)
+// Desc : Called by Wait as the script stops to wait for ulTick.
+//-----------------------------------------------------------------------------
+void CScriptRunner::Suspend( unsigned int uIndex, uint64_t ulTick )
+{
+	Script& script = m_Scripts[uIndex];
+	script.hTimer = m_pTimers->ScheduleAt(ulTick, OnTimer, this, PackScript(uIndex, script.uGeneration));
+}
+
+//-----------------------------------------------------------------------------
+// Name : Resume () (Private)
+// Desc : Runs the script to its next wait or its end. The script may start
+//		others, which can move the slot table, so it is looked up again.
+//-----------------------------------------------------------------------------
+void CScriptRunner::Resume( unsigned int uIndex )
+{
+	std::coroutine_handle<ScriptTask::promise_type> handle = m_Scripts[uIndex].Handle;
+	unsigned int uOuter = m_uRunning;
+
+	m_Scripts[uIndex].hTimer = INVALID_TIMER;
+	m_uRunning = uIndex;
+	handle.resume();
+	m_uRunning = uOuter;
+
+	if (handle.done())
+		Release(uIndex);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release () (Private)
+// Desc : Destroys the frame and frees the slot, making handles stale.
+//-----------------------------------------------------------------------------
+void CScriptRunner::Release( unsigned int uIndex )
+{
+	Script& script = m_Scripts[uIndex];
+
+	m_pTimers->Cancel(script.hTimer);
+	script.Handle.destroy();
+	script.Handle		= nullptr;
+	script.hTimer		= INVALID_TIMER;
+	script.uGeneration++;
+	script.uNextFree	= m_uFree;
+	m_uFree				= uIndex;
+	m_nActive--;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnTimer () (Private, Static)
+// Desc : A wait is over. Stopped scripts cancel their timer, the generation
+//		check is only a guard.
+//-----------------------------------------------------------------------------
+void CScriptRunner::OnTimer( void *pRunner, uint64_t uData )
+{
+	CScriptRunner *pThis = (CScriptRunner*)pRunner;
+	unsigned int uIndex = (unsigned int)uData;
+
+	if (uIndex < pThis->m_Scripts.size() && pThis->m_Scripts[uIndex].uGeneration == (unsigned int)(uData >> 32) &&
+		pThis->m_Scripts[uIndex].Handle)
+		pThis->Resume(uIndex);
+}
@@ -0,0 +1,1322 @@
+//-----------------------------------------------------------------------------
+// File: SimWorld.cpp
+//
+// Desc: Platform independent game simulation. The rules here used to live in
+//	   CGameApp and CPlayer; they are kept step for step so the game plays
+//	   the same under either frontend.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSimWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include "SimWorld.h"
+#include "MathDefs.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Rates are per second; they were tuned as per-frame amounts at about 240 FPS.
+namespace
+{
+	const double	PLAYER_THRUST			= 744.0;	// Pixels per second squared while a key is held
+	const double	EDGE_PUSH				= 240.0;	// Pixels per second back into the play area
+	const double	PLAYER_BULLET_SPEED		= -168.0;	// Pixels per second, positive is down
+	const double	ENEMY_BULLET_SPEED		= 120.0;
+	const double	ENEMY_DRIFT				= 21.6;
+	const float		PLAYER_FIRE_COOLDOWN	= 0.42f;	// Seconds
+	const float		PLAYER_FIRE_START		= 0.2f;
+	const float		ENEMY_FIRE_COOLDOWN		= 2.9f;
+	const float		ENEMY_FIRE_START		= 2.5f;
+	const float		ENEMY_FIRE_PERIOD		= 5.0f;		// Between fire attempts, less a random head start
+	const float		ENEMY_FIRE_JITTER		= 4.2f;		// Seconds
+	const int		SCORE_PER_HIT			= 100;
+	const double	ENGINE_START_SPEED		= 35.0;		// Jet sound hysteresis
+	const double	ENGINE_STOP_SPEED		= 25.0;
+	const float		ENGINE_CABIN_PERIOD		= 1.0f;		// Seconds
+	const size_t	ENEMY_JOB_GRAIN			= 4096;		// Enemies per job
+	const double	TIMER_TICKS_PER_SECOND	= 1000.0;	// Timing wheel resolution
+	const float		STRAFE_FLY_SPEED		= 120.0f;	// Flying in and retreating
+	const double	STRAFE_FLY_TIME			= 1.5;
+	const float		STRAFE_SPEED			= 150.0f;
+	const double	STRAFE_TIME				= 2.0;
+	const double	STRAFE_HOLD				= 2.0;		// Still before firing
+	const float		FLOW_CELL_SIZE			= 48.0f;	// Pixels, half an enemy or so
+	const double	FLOW_PERIOD				= 0.1;		// Seconds between rebuilds
+
+	// Wave file names, by SIM_ENEMY_PATTERN and SIM_ENEMY_SCRIPT
+	const char *PATTERN_NAMES[SIM_PATTERN_COUNT]	= { "single", "spread", "ring", "spiral", "aimed", "storm" };
+	const char *SCRIPT_NAMES[SIM_SCRIPT_COUNT]		= { "drift", "strafe", "chase" };
+	const char *PATTERN_HOLD_FIRE					= "none";
+
+	// By name, iDefault for a name not in the list
+	int FindName( const char **szNames, int nNames, const std::string& name, int iDefault )
+	{
+		for (int i = 0; i < nNames; i++)
+		{
+			if (name == szNames[i])
+				return i;
+		}
+
+		return iDefault;
+	}
+
+	uint64_t PackHandle( EntityHandle handle )
+	{
+		return ((uint64_t)handle.uGeneration << 32) | handle.uSlot;
+	}
+
+	EntityHandle UnpackHandle( uint64_t uData )
+	{
+		EntityHandle handle = { (unsigned int)uData, (unsigned int)(uData >> 32) };
+		return handle;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : StateHash (Class)
+// Desc : 64 bit FNV-1a, fed raw bytes.
+//-----------------------------------------------------------------------------
+namespace
+{
+	class StateHash
+	{
+	public:
+		StateHash() : m_uHash(0xCBF29CE484222325ull) {}
+
+		void Add( const void *pData, size_t nBytes )
+		{
+			const unsigned char *p = (const unsigned char*)pData;
+			for (size_t i = 0; i < nBytes; i++)
+				m_uHash = (m_uHash ^ p[i]) * 0x100000001B3ull;
+		}
+
+		template <class T> void Add( const T& value ) { Add((const void*)&value, sizeof(T)); }
+		template <class T> void Add( const T *pArray, size_t n ) { if (n) Add((const void*)pArray, n * sizeof(T)); }
+
+		uint64_t Get( ) const { return m_uHash; }
+
+	private:
+		uint64_t m_uHash;
+	};
+}
+
+//-----------------------------------------------------------------------------
+// Collision Rules
+//-----------------------------------------------------------------------------
+// Layer pairs that meet and their response, the rule index is the table
+// index. Pairs not listed are never tested. When both layers are large the
+// second one goes into the grid, so it should be the one shared by rules.
+const CSimWorld::CollisionRule CSimWorld::m_CollisionRules[] =
+{
+	{ SIM_LAYER_ENEMY,		 SIM_LAYER_PLAYER,	&CSimWorld::OnEnemyHitsPlayer		},
+	{ SIM_LAYER_PLAYER,		 SIM_LAYER_PLAYER,	&CSimWorld::OnPlayersCrash			},
+	{ SIM_LAYER_ENEMY_SHOT,	 SIM_LAYER_PLAYER,	&CSimWorld::OnEnemyShotHitsPlayer	},
+	{ SIM_LAYER_PLAYER_SHOT, SIM_LAYER_PLAYER,	&CSimWorld::OnPlayerShotHitsPlayer	},
+	{ SIM_LAYER_PLAYER_SHOT, SIM_LAYER_ENEMY,	&CSimWorld::OnPlayerShotHitsEnemy	},
+};
+
+//-----------------------------------------------------------------------------
+// Step Systems
+//-----------------------------------------------------------------------------
+// One step, in order. Each system's data access decides what it waits for;
+// on a job system the others run alongside, e.g. enemies drift while the
+// players move. Anything raising events is kept in order through
+// SIM_DATA_EVENTS, so the event list is the same either way.
+const CSimWorld::StepSystem CSimWorld::m_StepSystems[] =
+{
+	{ "save positions",	RunSystem<&CSimWorld::SavePositions>,		0,
+		SIM_DATA_PLAYERS | SIM_DATA_ENEMY_MOTION },
+	{ "player input",	RunSystem<&CSimWorld::ApplyInput>,			0,
+		SIM_DATA_PLAYERS | SIM_DATA_BULLETS | SIM_DATA_EVENTS | SIM_DATA_TIMERS },
+	{ "enemy drift",	RunSystem<&CSimWorld::MoveEnemies>,			SIM_DATA_ENEMY_STATE | SIM_DATA_FLOW,
+		SIM_DATA_ENEMY_MOTION },
+	{ "integrate",		RunSystem<&CSimWorld::Integrate>,			0,
+		SIM_DATA_PLAYERS },
+	{ "flow field",		RunSystem<&CSimWorld::UpdateFlowField>,		SIM_DATA_PLAYERS,
+		SIM_DATA_FLOW },
+	{ "sounds",			RunSystem<&CSimWorld::UpdateSounds>,		0,
+		SIM_DATA_PLAYERS | SIM_DATA_EVENTS },
+	{ "timers",			RunSystem<&CSimWorld::RunTimers>,			0,
+		SIM_DATA_PLAYERS | SIM_DATA_ENEMY_MOTION | SIM_DATA_ENEMY_STATE | SIM_DATA_BULLETS | SIM_DATA_EVENTS |
+		SIM_DATA_TIMERS | SIM_DATA_FLOW },
+	{ "remove gone",	RunSystem<&CSimWorld::RemoveGone>,			0,
+		SIM_DATA_ENEMY_MOTION | SIM_DATA_ENEMY_STATE },
+	{ "emitters",		RunSystem<&CSimWorld::UpdateEmitters>,		0,
+		SIM_DATA_BULLETS },
+	{ "move bullets",	RunSystem<&CSimWorld::MoveBullets>,			0,
+		SIM_DATA_BULLETS },
+	{ "collide",		RunSystem<&CSimWorld::Collide>,				SIM_DATA_ENEMY_MOTION,
+		SIM_DATA_PLAYERS | SIM_DATA_ENEMY_STATE | SIM_DATA_BULLETS | SIM_DATA_EVENTS | SIM_DATA_COLLISION |
+		SIM_DATA_TIMERS },
+	{ "game over",		RunSystem<&CSimWorld::CheckGameOver>,		SIM_DATA_PLAYERS,
+		SIM_DATA_EVENTS | SIM_DATA_GAME },
+};
+
+//-----------------------------------------------------------------------------
+// Enemy Fire Patterns
+//-----------------------------------------------------------------------------
+// By SIM_ENEMY_PATTERN: type, bullets per burst, bursts, seconds between
+// bursts, speed, acceleration, direction, arc and turn per burst.
+const BulletPattern CSimWorld::m_EnemyPatterns[SIM_PATTERN_COUNT] =
+{
+	{ PATTERN_SPREAD,	 1,	 1,	0,		(float)ENEMY_BULLET_SPEED,	0,	0,	0,	0		},	// Single
+	{ PATTERN_SPREAD,	 5,	 1,	0,		140,	0,		0,	60,	0		},	// Spread
+	{ PATTERN_RING,		24,	 1,	0,		110,	0,		0,	0,	0		},	// Ring
+	{ PATTERN_SPIRAL,	 4,	16,	0.06f,	130,	0,		0,	0,	11.25f	},	// Spiral
+	{ PATTERN_AIMED,	 3,	 3,	0.12f,	200,	0,		0,	12,	0		},	// Aimed
+	{ PATTERN_SPIRAL,	64,	12,	0.05f,	50,		40,		0,	0,	2.8125f	},	// Storm
+};
+
+//-----------------------------------------------------------------------------
+// Enemy Scripts
+//-----------------------------------------------------------------------------
+// By SIM_ENEMY_SCRIPT. Each enemy runs one from SpawnFormation() on.
+const CSimWorld::ENEMY_SCRIPT CSimWorld::m_EnemyScripts[SIM_SCRIPT_COUNT] =
+{
+	&CSimWorld::DriftScript,
+	&CSimWorld::StrafeScript,
+	&CSimWorld::ChaseScript,
+};
+
+//-----------------------------------------------------------------------------
+// SimConfig Member Functions
+//-----------------------------------------------------------------------------
+SimConfig::SimConfig()
+{
+	dWidth				= 1920;
+	dHeight				= 1080;
+	dPlayerWidth		= 100;
+	dPlayerHeight		= 143;
+	dEnemyWidth			= 99;
+	dEnemyHeight		= 142;
+	dBulletWidth		= 32;
+	dBulletHeight		= 32;
+	iEnemyCount			= 14;
+	iPlayerLives		= 3;
+	iMaxBullets			= 4096;
+	iEnemyPattern		= SIM_PATTERN_SINGLE;
+	iEnemyScript		= SIM_SCRIPT_DRIFT;
+	fExplosionTime		= 16 * 0.07f;		// 16 frames of 70 ms
+	uSeed				= 1;
+}
+
+//-----------------------------------------------------------------------------
+// CSimWorld Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSimWorld () (Constructor)
+// Desc : CSimWorld Class Constructor
+//-----------------------------------------------------------------------------
+CSimWorld::CSimWorld()
+{
+	m_pJobs		= NULL;
+	m_fStepTime	= 0;
+	m_dTime		= 0;
+	m_bFlowField= false;
+	m_dFlowDue	= 0;
+	m_Scripts.Create(&m_Timers);
+
+	for (size_t i = 0; i < sizeof(m_StepSystems) / sizeof(m_StepSystems[0]); i++)
+	{
+		const StepSystem& system = m_StepSystems[i];
+		m_Systems.AddSystem(system.szName, system.pFunc, this, system.uReads, system.uWrites);
+	}
+
+	for (size_t i = 0; i < sizeof(m_CollisionRules) / sizeof(m_CollisionRules[0]); i++)
+		m_Collision.AddRule(m_CollisionRules[i].LayerA, m_CollisionRules[i].LayerB);
+
+	Reset(SimConfig());
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSimWorld () (Destructor)
+// Desc : CSimWorld Class Destructor
+//-----------------------------------------------------------------------------
+CSimWorld::~CSimWorld()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Starts a new game with the given configuration.
+//-----------------------------------------------------------------------------
+void CSimWorld::Reset( const SimConfig& config )
+{
+	m_Config	= config;
+	m_ulStep	= 0;
+	if (m_Config.iEnemyPattern < 0 || m_Config.iEnemyPattern >= SIM_PATTERN_COUNT)
+		m_Config.iEnemyPattern = SIM_PATTERN_SINGLE;
+	if (m_Config.iEnemyScript < 0 || m_Config.iEnemyScript >= SIM_SCRIPT_COUNT)
+		m_Config.iEnemyScript = SIM_SCRIPT_DRIFT;
+	m_dTime		= 0;
+	m_bGameOver	= false;
+	m_bFlowField= false;
+	m_dFlowDue	= 0;
+	m_FlowField.Clear();
+	m_Scripts.Clear();
+	m_Timers.Clear();
+
+	for (int i = 0; i < SIM_RANDOM_STREAM_COUNT; i++)
+		m_Random[i].Seed(m_Config.uSeed, i);
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		SimPlayer& player = m_Players[i];
+		player.Spawn			= Vec2(100 + 200 * i, 500);
+		player.Position			= player.Spawn;
+		player.PrevPosition		= player.Spawn;
+		player.Velocity			= Vec2(0, 0);
+		player.iHeading			= 0;
+		player.iLives			= m_Config.iPlayerLives;
+		player.iScore			= 0;
+		player.dFireReady		= PLAYER_FIRE_START;
+		player.bEngineOn		= false;
+		player.fSoundTimer		= 0;
+		player.bExploding		= false;
+		player.hExplosionTimer	= INVALID_TIMER;
+	}
+
+	// The pool only allocates when its size changes
+	if (m_Bullets.Capacity() != (size_t)m_Config.iMaxBullets)
+		m_Bullets.Create(m_Config.iMaxBullets);
+	m_Bullets.Clear();
+	m_Emitters.Clear();
+	m_Bullets.SetBounds(0, 0, (float)m_Config.dWidth, (float)m_Config.dHeight);
+
+	// Grid cells about one enemy in size
+	double dCell = m_Config.dEnemyWidth > m_Config.dEnemyHeight ? m_Config.dEnemyWidth : m_Config.dEnemyHeight;
+	m_Collision.SetCellSize((float)dCell);
+	m_Events.clear();
+
+	m_Enemies.Clear();
+	if (m_Waves.Parse(m_Config.Waves))
+		ScheduleWaves();
+	else
+		SpawnEnemies();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetPlayArea ()
+// Desc : Resizes the area players are kept in.
+//-----------------------------------------------------------------------------
+void CSimWorld::SetPlayArea( double dWidth, double dHeight )
+{
+	m_Config.dWidth	 = dWidth;
+	m_Config.dHeight = dHeight;
+	m_Bullets.SetBounds(0, 0, (float)dWidth, (float)dHeight);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Step ()
+// Desc : Advances the world by one input command and dt seconds. Run it
+//		at a fixed dt (see CFixedStepLoop) to keep play independent of the
+//		frame rate.
+//-----------------------------------------------------------------------------
+void CSimWorld::Step( const SimInput& input, float dt )
+{
+	if (m_bGameOver)
+		return;
+
+	m_ulStep++;
+	m_dTime += dt;
+
+	m_StepInput	= input;
+	m_fStepTime	= dt;
+	m_Systems.Run(m_pJobs);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Save ()
+// Desc : Writes position, lives and score of both players, then the state
+//		of each random stream.
+//-----------------------------------------------------------------------------
+bool CSimWorld::Save( std::ostream& out ) const
+{
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		const SimPlayer& player = m_Players[i];
+		out << player.Position.x << " " << player.Position.y << " " << player.iLives << " ";
+		out << player.iScore << "\n";
+	}
+
+	std::ios::fmtflags flags = out.flags();
+	for (int i = 0; i < SIM_RANDOM_STREAM_COUNT; i++)
+	{
+		const RandomState& state = m_Random[i].GetState();
+		out << std::hex << state.s[0] << " " << state.s[1] << " " << state.s[2] << " " << state.s[3] << "\n";
+	}
+	out.flags(flags);
+
+	return out.good();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Load ()
+// Desc : Reads what Save() wrote. The world is untouched if the data is bad.
+//		Saves from before the random streams were kept still load and
+//		leave the streams as they are.
+//-----------------------------------------------------------------------------
+bool CSimWorld::Load( std::istream& in )
+{
+	double		x[SIM_PLAYER_COUNT], y[SIM_PLAYER_COUNT];
+	int			iLives[SIM_PLAYER_COUNT], iScore[SIM_PLAYER_COUNT];
+	RandomState	random[SIM_RANDOM_STREAM_COUNT];
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		if (!(in >> x[i] >> y[i] >> iLives[i] >> iScore[i]))
+			return false;
+	}
+
+	bool bRandom = !(in >> std::ws).eof();
+	if (bRandom)
+	{
+		in >> std::hex;
+		for (int i = 0; i < SIM_RANDOM_STREAM_COUNT; i++)
+		{
+			if (!(in >> random[i].s[0] >> random[i].s[1] >> random[i].s[2] >> random[i].s[3]))
+				return false;
+		}
+		in >> std::dec;
+	}
+
+	if (bRandom)
+	{
+		for (int i = 0; i < SIM_RANDOM_STREAM_COUNT; i++)
+			m_Random[i].SetState(random[i]);
+	}
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		m_Players[i].Position	= Vec2(x[i], y[i]);
+		m_Players[i].PrevPosition = m_Players[i].Position;
+		m_Players[i].iLives		= iLives[i];
+		m_Players[i].iScore		= iScore[i];
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStateHash ()
+// Desc : Floats are hashed by their bits, so the smallest numeric drift
+//		shows.
+//-----------------------------------------------------------------------------
+uint64_t CSimWorld::GetStateHash( ) const
+{
+	StateHash hash;
+
+	hash.Add(m_ulStep);
+	hash.Add(m_dTime);
+	hash.Add(m_bGameOver);
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		const SimPlayer& player = m_Players[i];
+		hash.Add(player.Position.x);	hash.Add(player.Position.y);
+		hash.Add(player.Velocity.x);	hash.Add(player.Velocity.y);
+		hash.Add(player.iHeading);
+		hash.Add(player.iLives);
+		hash.Add(player.iScore);
+		hash.Add(player.dFireReady);
+		hash.Add(player.bExploding);
+	}
+
+	size_t nEnemies = m_Enemies.Size();
+	hash.Add(nEnemies);
+	hash.Add(m_Enemies.X.data(), nEnemies);
+	hash.Add(m_Enemies.Y.data(), nEnemies);
+	hash.Add(m_Enemies.Flags.data(), nEnemies);
+	hash.Add(m_Enemies.Timer[ENEMY_TIMER_FIRE].data(), nEnemies);
+	hash.Add(m_Enemies.Timer[ENEMY_TIMER_COOLDOWN].data(), nEnemies);
+	hash.Add(m_Enemies.Timer[ENEMY_TIMER_EXPLOSION].data(), nEnemies);
+
+	size_t nBullets = m_Bullets.Count();
+	hash.Add(nBullets);
+	hash.Add(m_Bullets.X(), nBullets);
+	hash.Add(m_Bullets.Y(), nBullets);
+	hash.Add(m_Bullets.VelX(), nBullets);
+	hash.Add(m_Bullets.VelY(), nBullets);
+	hash.Add(m_Bullets.AccX(), nBullets);
+	hash.Add(m_Bullets.AccY(), nBullets);
+	hash.Add(m_Bullets.Owner(), nBullets);
+	hash.Add(m_Emitters.GetActiveCount());
+	hash.Add(m_Scripts.GetActiveCount());
+	hash.Add(m_bFlowField);
+	hash.Add(m_dFlowDue);
+
+	for (int i = 0; i < SIM_RANDOM_STREAM_COUNT; i++)
+		hash.Add(m_Random[i].GetState());
+
+	return hash.Get();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPlayerSize ()
+// Desc : Bounds of the player box rotated to its heading.
+//-----------------------------------------------------------------------------
+void CSimWorld::GetPlayerSize( int iIndex, double& dWidth, double& dHeight ) const
+{
+	double dAngle = 2 * PI * m_Players[iIndex].iHeading / SIM_PLAYER_ROTATION_STEPS;
+	double c = fabs(cos(dAngle));
+	double s = fabs(sin(dAngle));
+
+	dWidth	= c * m_Config.dPlayerWidth + s * m_Config.dPlayerHeight;
+	dHeight	= s * m_Config.dPlayerWidth + c * m_Config.dPlayerHeight;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetCollisionMasks ()
+// Desc : The masks are copied. Player masks are only used when there is one
+//		for every heading.
+//-----------------------------------------------------------------------------
+void CSimWorld::SetCollisionMasks( const std::vector<CCollisionMask>& playerMasks,
+								   const CCollisionMask& enemyMask, const CCollisionMask& bulletMask )
+{
+	m_PlayerMasks.clear();
+	if (playerMasks.size() == (size_t)SIM_PLAYER_ROTATION_STEPS)
+		m_PlayerMasks = playerMasks;
+
+	m_EnemyMask		= enemyMask;
+	m_BulletMask	= bulletMask;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SpawnEnemies () (Private)
+// Desc : Lays the enemies out in rows across the play area, the game before
+//		there were wave files.
+//-----------------------------------------------------------------------------
+void CSimWorld::SpawnEnemies( )
+{
+	Vec2 position = Vec2(300, 50);
+
+	m_SpawnX.clear();
+	m_SpawnY.clear();
+	for (int i = 0; i < m_Config.iEnemyCount; i++)
+	{
+		m_SpawnX.push_back((float)position.x);
+		m_SpawnY.push_back((float)position.y);
+
+		position.x += 150;
+		if (position.x > m_Config.dWidth - 300)
+		{
+			position.x = 300;
+			position.y += 150;
+		}
+	}
+
+	m_Enemies.Reserve(m_SpawnX.size());
+	SpawnFormation(m_SpawnX.size(), (float)ENEMY_DRIFT, m_EnemyScripts[m_Config.iEnemyScript],
+				   &m_EnemyPatterns[m_Config.iEnemyPattern]);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SpawnFormation () (Private)
+// Desc : Adds nCount enemies at m_SpawnX/Y, drifting down at fSpeed, and
+//		starts their scripts. They hold fire for a while, then each waits
+//		out a random head start so they do not all fire together.
+//-----------------------------------------------------------------------------
+void CSimWorld::SpawnFormation( size_t nCount, float fSpeed, ENEMY_SCRIPT pScript, const BulletPattern *pPattern )
+{
+	size_t iFirst = m_Enemies.Size();
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		size_t e = m_Enemies.Size();
+		m_Enemies.Create();
+		m_Enemies.X[e]		= m_Enemies.PrevX[e] = m_SpawnX[i];
+		m_Enemies.Y[e]		= m_Enemies.PrevY[e] = m_SpawnY[i];
+		m_Enemies.VelX[e]	= 0;
+		m_Enemies.VelY[e]	= fSpeed;
+		m_Enemies.Speed[e]	= fSpeed;
+		m_Enemies.SpriteId[e]	= SIM_SPRITE_ENEMY;
+		m_Enemies.Flags[e]		= 0;
+		m_Enemies.Timer[ENEMY_TIMER_COOLDOWN][e]	= (float)(m_dTime + ENEMY_FIRE_START);
+		m_Enemies.Timer[ENEMY_TIMER_EXPLOSION][e]	= 0;
+	}
+
+	float *fire = m_Enemies.Timer[ENEMY_TIMER_FIRE].data() + iFirst;
+	m_Random[SIM_RANDOM_SPAWN].FillFloat(fire, nCount, 0, ENEMY_FIRE_JITTER);
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		fire[i] = (float)(m_dTime + ENEMY_FIRE_PERIOD - fire[i]);
+		m_Scripts.Start(pScript(m_Scripts, this, m_Enemies.HandleAt(iFirst + i), pPattern));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScheduleWaves () (Private)
+// Desc : Looks up the names the wave file's archetypes use and sets a timer
+//		for the first coming of every wave. Unknown names fall back to the
+//		configured script and pattern.
+//-----------------------------------------------------------------------------
+void CSimWorld::ScheduleWaves( )
+{
+	const std::vector<EnemyArchetype>& archetypes = m_Waves.GetArchetypes();
+
+	m_WaveArchetypes.resize(archetypes.size());
+	for (size_t i = 0; i < archetypes.size(); i++)
+	{
+		WaveArchetype& archetype = m_WaveArchetypes[i];
+		int iScript	 = FindName(SCRIPT_NAMES, SIM_SCRIPT_COUNT, archetypes[i].Script, m_Config.iEnemyScript);
+		int iPattern = FindName(PATTERN_NAMES, SIM_PATTERN_COUNT, archetypes[i].Pattern, m_Config.iEnemyPattern);
+
+		archetype.pScript	= m_EnemyScripts[iScript];
+		archetype.pPattern	= archetypes[i].Pattern == PATTERN_HOLD_FIRE ? NULL : &m_EnemyPatterns[iPattern];
+		archetype.fSpeed	= archetypes[i].fSpeed;
+	}
+
+	const std::vector<Wave>& waves = m_Waves.GetWaves();
+	for (size_t i = 0; i < waves.size(); i++)
+		ScheduleTimer(waves[i].dTime, RunTimer<&CSimWorld::OnWaveTimer>, i);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SavePositions () (Private)
+// Desc : Keeps this step's starting positions for render interpolation.
+//-----------------------------------------------------------------------------
+void CSimWorld::SavePositions( )
+{
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		m_Players[i].PrevPosition = m_Players[i].Position;
+
+	m_Enemies.PrevX = m_Enemies.X;
+	m_Enemies.PrevY = m_Enemies.Y;
+
+}
+
+//-----------------------------------------------------------------------------
+// Name : ApplyInput () (Private)
+// Desc : Thrust, turning and firing for both players.
+//-----------------------------------------------------------------------------
+void CSimWorld::ApplyInput( )
+{
+	const SimInput& input = m_StepInput;
+	float dt = m_fStepTime;
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		const SimPlayerInput& cmd = input.Players[i];
+		SimPlayer& player = m_Players[i];
+
+		if (cmd.uActions & SimPlayerInput::ACTION_ROTATE_LEFT)
+			player.iHeading = (player.iHeading + SIM_PLAYER_ROTATION_STEPS * 3 / 4) % SIM_PLAYER_ROTATION_STEPS;
+		if (cmd.uActions & SimPlayerInput::ACTION_ROTATE_RIGHT)
+			player.iHeading = (player.iHeading + SIM_PLAYER_ROTATION_STEPS / 4) % SIM_PLAYER_ROTATION_STEPS;
+		if (cmd.uActions & SimPlayerInput::ACTION_SELF_DESTRUCT)
+			ExplodePlayer(i);
+		if (cmd.uActions & SimPlayerInput::ACTION_FIRE)
+			PlayerFire(i);
+
+		double w, h;
+		GetPlayerSize(i, w, h);
+
+		// Each axis bounces off the play area edge even while thrusting into it
+		if (cmd.uMove & SimPlayerInput::MOVE_LEFT)
+			player.Velocity.x -= PLAYER_THRUST * dt;
+
+		if (player.Position.x - w / 2 <= 0)
+		{
+			player.Velocity.x = 0;
+			player.Position.x += EDGE_PUSH * dt;
+		}
+
+		if (cmd.uMove & SimPlayerInput::MOVE_RIGHT)
+			player.Velocity.x += PLAYER_THRUST * dt;
+
+		if (player.Position.x + w / 2 >= m_Config.dWidth)
+		{
+			player.Velocity.x = 0;
+			player.Position.x -= EDGE_PUSH * dt;
+		}
+
+		if (cmd.uMove & SimPlayerInput::MOVE_FORWARD)
+			player.Velocity.y -= PLAYER_THRUST * dt;
+
+		if (player.Position.y - h / 2 <= 0)
+		{
+			player.Velocity.y = 0;
+			player.Position.y += EDGE_PUSH * dt;
+		}
+
+		if (cmd.uMove & SimPlayerInput::MOVE_BACKWARD)
+			player.Velocity.y += PLAYER_THRUST * dt;
+
+		if (player.Position.y + h >= m_Config.dHeight)
+		{
+			player.Velocity.y = 0;
+			player.Position.y -= EDGE_PUSH * dt;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : MoveEnemies () (Private)
+// Desc : Exploding enemies hold still so the explosion stays where they
+//		were hit. Homing ones first turn to the flow field's heading for
+//		their cell, one lookup each however many there are.
+//-----------------------------------------------------------------------------
+void CSimWorld::MoveEnemies( )
+{
+	float dt = m_fStepTime;
+	float *x = m_Enemies.X.data();
+	float *y = m_Enemies.Y.data();
+	float *vx = m_Enemies.VelX.data();
+	float *vy = m_Enemies.VelY.data();
+	const float *speed = m_Enemies.Speed.data();
+	const unsigned int *flags = m_Enemies.Flags.data();
+	const CFlowField *pField = &m_FlowField;
+
+	auto drift = [=]( size_t iBegin, size_t iEnd )
+	{
+		for (size_t i = iBegin; i < iEnd; i++)
+		{
+			if (flags[i] & ENEMY_EXPLODING)
+				continue;
+
+			if (flags[i] & ENEMY_HOMING)
+			{
+				float fDirX, fDirY;
+				pField->Sample(x[i], y[i], fDirX, fDirY);
+				vx[i] = fDirX * speed[i];
+				vy[i] = fDirY * speed[i];
+			}
+
+			x[i] += vx[i] * dt;
+			y[i] += vy[i] * dt;
+		}
+	};
+
+	if (m_pJobs)
+		m_pJobs->ParallelFor(m_Enemies.Size(), ENEMY_JOB_GRAIN, drift);
+	else
+		drift(0, m_Enemies.Size());
+}
+
+//-----------------------------------------------------------------------------
+// Name : Integrate () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::Integrate( )
+{
+	float dt = m_fStepTime;
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		m_Players[i].Position += m_Players[i].Velocity * dt;
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateFlowField () (Private)
+// Desc : Rebuilds the field toward both players every FLOW_PERIOD, once an
+//		enemy has started homing. Enemies steer by the last rebuild, which
+//		is never more than a few steps behind.
+//-----------------------------------------------------------------------------
+void CSimWorld::UpdateFlowField( )
+{
+	if (!m_bFlowField || m_dTime < m_dFlowDue)
+		return;
+
+	float x[SIM_PLAYER_COUNT], y[SIM_PLAYER_COUNT];
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		x[i] = (float)m_Players[i].Position.x;
+		y[i] = (float)m_Players[i].Position.y;
+	}
+
+	m_FlowField.Create((float)m_Config.dWidth, (float)m_Config.dHeight, FLOW_CELL_SIZE);
+	m_FlowField.Build(x, y, SIM_PLAYER_COUNT);
+	m_dFlowDue = m_dTime + FLOW_PERIOD;
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateSounds () (Private)
+// Desc : Jet sound state machine, with hysteresis so sounds do not overlap.
+//-----------------------------------------------------------------------------
+void CSimWorld::UpdateSounds( )
+{
+	float dt = m_fStepTime;
+
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		SimPlayer& player = m_Players[i];
+		double v = player.Velocity.Magnitude();
+
+		player.fSoundTimer += dt;
+
+		if (!player.bEngineOn)
+		{
+			if (v > ENGINE_START_SPEED)
+			{
+				player.bEngineOn = true;
+				player.fSoundTimer = 0;
+				RaiseEvent(SimEvent::EVENT_SOUND, i, false, player.Position, SimEvent::SOUND_JET_START);
+			}
+		}
+		else if (v < ENGINE_STOP_SPEED)
+		{
+			player.bEngineOn = false;
+			player.fSoundTimer = 0;
+			RaiseEvent(SimEvent::EVENT_SOUND, i, false, player.Position, SimEvent::SOUND_JET_STOP);
+		}
+		else if (player.fSoundTimer > ENGINE_CABIN_PERIOD)
+		{
+			player.fSoundTimer = 0;
+			RaiseEvent(SimEvent::EVENT_SOUND, i, false, player.Position, SimEvent::SOUND_JET_CABIN);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunTimers () (Private)
+// Desc : Brings the timing wheel up to the end of this step. Only timers
+//		falling due cost anything: enemy scripts, explosion frames and the
+//		end of enemy explosions.
+//-----------------------------------------------------------------------------
+void CSimWorld::RunTimers( )
+{
+	m_Timers.AdvanceTo((uint64_t)(m_dTime * TIMER_TICKS_PER_SECOND + 1e-6));
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveGone () (Private)
+// Desc : Enemies done exploding, and those that drifted off the bottom, all
+//		go in one compaction pass rather than one by one.
+//-----------------------------------------------------------------------------
+void CSimWorld::RemoveGone( )
+{
+	float fBottom = (float)(m_Config.dHeight + m_Config.dEnemyHeight / 2);
+	const float *y = m_Enemies.Y.data();
+	unsigned int *flags = m_Enemies.Flags.data();
+	size_t nGone = 0;
+
+	for (size_t i = 0; i < m_Enemies.Size(); i++)
+	{
+		if (y[i] > fBottom)
+			flags[i] |= ENEMY_GONE;
+		nGone += (flags[i] & ENEMY_GONE) != 0;
+	}
+
+	if (nGone)
+		m_Enemies.RemoveFlagged(ENEMY_GONE);
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateEmitters () (Private)
+// Desc : Later bursts of the patterns enemies started firing.
+//-----------------------------------------------------------------------------
+void CSimWorld::UpdateEmitters( )
+{
+	m_Emitters.Update(m_dTime, m_Bullets);
+}
+
+//-----------------------------------------------------------------------------
+// Name : MoveBullets () (Private)
+// Desc : Moves every bullet; Collide() then tests the whole path each one
+//		took this step.
+//-----------------------------------------------------------------------------
+void CSimWorld::MoveBullets( )
+{
+	m_Bullets.Integrate(m_fStepTime);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Collide () (Private)
+// Desc : One pass over every rule in the table. Hits come back earliest
+//		first along each object's path this step, and each object takes
+//		part in one hit at most, so a bullet stops at the first thing it
+//		reaches and a player sent home is not hit again where it was.
+//-----------------------------------------------------------------------------
+void CSimWorld::Collide( )
+{
+	m_Collision.Clear();
+	AddProxies();
+	m_Collision.Detect();
+
+	const std::vector<CollisionHit>& hits = m_Collision.GetHits();
+	for (size_t i = 0; i < hits.size(); i++)
+	{
+		const CollisionHit& hit = hits[i];
+		if (!m_Collision.Claim(hit))
+			continue;
+
+		const CollisionRule& rule = m_CollisionRules[hit.iRule];
+		(this->*rule.pHandler)(m_Collision.GetProxy(rule.LayerA, hit.uA).uId, m_Collision.GetProxy(rule.LayerB, hit.uB).uId);
+	}
+
+	RemoveHitBullets();
+	m_Bullets.Cull((float)m_Config.dBulletWidth, (float)m_Config.dBulletHeight);
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddProxies () (Private)
+// Desc : Everything that can still be hit, with its move this step. Layers
+//		no rule mentions are skipped before they are gathered.
+//-----------------------------------------------------------------------------
+void CSimWorld::AddProxies( )
+{
+	CollisionProxy proxy;
+
+	if (m_Collision.IsLayerUsed(SIM_LAYER_PLAYER))
+	{
+		for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		{
+			proxy.uId	= (unsigned int)i;
+			proxy.From	= m_Players[i].PrevPosition;
+			proxy.To	= m_Players[i].Position;
+			proxy.pMask	= GetPlayerMask(i);
+			GetPlayerSize(i, proxy.dWidth, proxy.dHeight);
+			m_Collision.Add(SIM_LAYER_PLAYER, proxy);
+		}
+	}
+
+	if (m_Collision.IsLayerUsed(SIM_LAYER_ENEMY))
+	{
+		proxy.dWidth	= m_Config.dEnemyWidth;
+		proxy.dHeight	= m_Config.dEnemyHeight;
+		proxy.pMask		= GetEnemyMask();
+
+		for (size_t e = 0; e < m_Enemies.Size(); e++)
+		{
+			if (m_Enemies.Flags[e] & ENEMY_EXPLODING)
+				continue;
+
+			proxy.uId	= (unsigned int)e;
+			proxy.From	= Vec2(m_Enemies.PrevX[e], m_Enemies.PrevY[e]);
+			proxy.To	= Vec2(m_Enemies.X[e], m_Enemies.Y[e]);
+			m_Collision.Add(SIM_LAYER_ENEMY, proxy);
+		}
+	}
+
+	const float *x = m_Bullets.X();
+	const float *y = m_Bullets.Y();
+	const float *px = m_Bullets.PrevX();
+	const float *py = m_Bullets.PrevY();
+	const int *owner = m_Bullets.Owner();
+
+	proxy.dWidth	= m_Config.dBulletWidth;
+	proxy.dHeight	= m_Config.dBulletHeight;
+	proxy.pMask		= GetBulletMask();
+
+	for (size_t b = 0; b < m_Bullets.Count(); b++)
+	{
+		proxy.uId	= (unsigned int)b;
+		proxy.From	= Vec2(px[b], py[b]);
+		proxy.To	= Vec2(x[b], y[b]);
+		m_Collision.Add(owner[b] == BULLET_OWNER_ENEMY ? SIM_LAYER_ENEMY_SHOT : SIM_LAYER_PLAYER_SHOT, proxy);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveHitBullets () (Private)
+// Desc : Bullets that hit something are recycled once the hits are done,
+//		highest index first since despawning moves the last bullet into the
+//		hole.
+//-----------------------------------------------------------------------------
+void CSimWorld::RemoveHitBullets( )
+{
+	static const SIM_COLLISION_LAYER Layers[] = { SIM_LAYER_PLAYER_SHOT, SIM_LAYER_ENEMY_SHOT };
+
+	m_HitBullets.clear();
+	for (size_t l = 0; l < sizeof(Layers) / sizeof(Layers[0]); l++)
+	{
+		for (unsigned int i = 0; i < (unsigned int)m_Collision.GetCount(Layers[l]); i++)
+		{
+			if (m_Collision.IsClaimed(Layers[l], i))
+				m_HitBullets.push_back(m_Collision.GetProxy(Layers[l], i).uId);
+		}
+	}
+
+	std::sort(m_HitBullets.begin(), m_HitBullets.end());
+	for (size_t i = m_HitBullets.size(); i-- > 0; )
+		m_Bullets.DespawnAt(m_HitBullets[i]);
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnEnemyHitsPlayer () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::OnEnemyHitsPlayer( unsigned int uEnemy, unsigned int uPlayer )
+{
+	ExplodePlayer((int)uPlayer);
+	Respawn((int)uPlayer);
+	ExplodeEnemy(uEnemy);
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnPlayersCrash () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::OnPlayersCrash( unsigned int uPlayerA, unsigned int uPlayerB )
+{
+	ExplodePlayer((int)uPlayerA);
+	Respawn((int)uPlayerA);
+	ExplodePlayer((int)uPlayerB);
+	Respawn((int)uPlayerB);
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnEnemyShotHitsPlayer () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::OnEnemyShotHitsPlayer( unsigned int /*uBullet*/, unsigned int uPlayer )
+{
+	ExplodePlayer((int)uPlayer);
+	Respawn((int)uPlayer);
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnPlayerShotHitsPlayer () (Private)
+// Desc : A player's shot scores for the opponent.
+//-----------------------------------------------------------------------------
+void CSimWorld::OnPlayerShotHitsPlayer( unsigned int /*uBullet*/, unsigned int uPlayer )
+{
+	ExplodePlayer((int)uPlayer);
+	Respawn((int)uPlayer);
+	m_Players[1 - uPlayer].iScore += SCORE_PER_HIT;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnPlayerShotHitsEnemy () (Private)
+// Desc : Enemies score for both players.
+//-----------------------------------------------------------------------------
+void CSimWorld::OnPlayerShotHitsEnemy( unsigned int /*uBullet*/, unsigned int uEnemy )
+{
+	ExplodeEnemy(uEnemy);
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+		m_Players[i].iScore += SCORE_PER_HIT;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckGameOver () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::CheckGameOver( )
+{
+	for (int i = 0; i < SIM_PLAYER_COUNT; i++)
+	{
+		if (m_Players[i].iLives <= 0)
+		{
+			m_bGameOver = true;
+			RaiseEvent(SimEvent::EVENT_GAME_OVER, 1 - i, false, m_Players[1 - i].Position);
+			return;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnEnemyExplosionTimer () (Private)
+// Desc : RemoveGone() takes the enemy out once the timers are done.
+//-----------------------------------------------------------------------------
+void CSimWorld::OnEnemyExplosionTimer( uint64_t uData )
+{
+	int iIndex = m_Enemies.IndexOf(UnpackHandle(uData));
+	if (iIndex >= 0)
+		m_Enemies.Flags[iIndex] |= ENEMY_GONE;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnPlayerExplosionTimer () (Private)
+// Desc : The explosion is over; the player stops dead.
+//-----------------------------------------------------------------------------
+void CSimWorld::OnPlayerExplosionTimer( uint64_t uData )
+{
+	SimPlayer& player = m_Players[uData];
+
+	player.bExploding		= false;
+	player.Velocity			= Vec2(0, 0);
+	player.bEngineOn		= false;
+	player.hExplosionTimer	= INVALID_TIMER;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnWaveTimer () (Private)
+// Desc : A wave comes; uData is the wave index over the number of times it
+//		has come before. Its next coming is scheduled from the wave's start
+//		time, so repeats do not drift.
+//-----------------------------------------------------------------------------
+void CSimWorld::OnWaveTimer( uint64_t uData )
+{
+	const Wave& wave = m_Waves.GetWaves()[(size_t)(uint32_t)uData];
+	const WaveArchetype& archetype = m_WaveArchetypes[wave.iArchetype];
+	int iTime = (int)(uData >> 32);
+
+	m_SpawnX.clear();
+	m_SpawnY.clear();
+	m_Waves.Place(wave, m_Waves.GetCount(wave, iTime), m_SpawnX, m_SpawnY);
+	SpawnFormation(m_SpawnX.size(), archetype.fSpeed, archetype.pScript, archetype.pPattern);
+
+	if (++iTime < wave.nTimes)
+		ScheduleTimer(wave.dTime + iTime * wave.dEvery, RunTimer<&CSimWorld::OnWaveTimer>,
+					  ((uint64_t)iTime << 32) | (uint32_t)uData);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScheduleTimer () (Private)
+// Desc : Sets a timer for game time dTime. It runs in the first step that
+//		reaches that time, or the next step if it already has.
+//-----------------------------------------------------------------------------
+TimerHandle CSimWorld::ScheduleTimer( double dTime, TIMER_FUNC pFunc, uint64_t uData )
+{
+	return m_Timers.ScheduleAt(TimeToTick(dTime), pFunc, this, uData);
+}
+
+//-----------------------------------------------------------------------------
+// Name : TimeToTick () (Private)
+// Desc : The first wheel tick at or after game time dTime.
+//-----------------------------------------------------------------------------
+uint64_t CSimWorld::TimeToTick( double dTime ) const
+{
+	double dTick = ceil(dTime * TIMER_TICKS_PER_SECOND - 1e-6);
+	return dTick > 0 ? (uint64_t)dTick : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitEnemy () (Private)
+// Desc : Awaited by enemy scripts, resuming as ScheduleTimer() would.
+//-----------------------------------------------------------------------------
+CSimWorld::EnemyWait CSimWorld::WaitEnemy( EntityHandle hEnemy, double dTime )
+{
+	EnemyWait wait = { m_Scripts.WaitUntil(TimeToTick(dTime)), &m_Enemies, hEnemy };
+	return wait;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DriftScript () (Private, Static)
+// Desc : Drifts down at the speed it was spawned with, attempting to fire
+//		every period less a random head start. A script ends the first time
+//		it wakes to find its enemy removed.
+//-----------------------------------------------------------------------------
+ScriptTask CSimWorld::DriftScript( CScriptRunner& /*scripts*/, CSimWorld *pWorld, EntityHandle hEnemy,
+								   const BulletPattern *pPattern )
+{
+	double dNext = pWorld->m_Enemies.Timer[ENEMY_TIMER_FIRE][pWorld->m_Enemies.IndexOf(hEnemy)];
+
+	for (;;)
+	{
+		int iIndex = co_await pWorld->WaitEnemy(hEnemy, dNext);
+		if (iIndex < 0)
+			co_return;
+
+		pWorld->EnemyFire(iIndex, pPattern);
+
+		dNext = pWorld->m_dTime + ENEMY_FIRE_PERIOD - pWorld->m_Random[SIM_RANDOM_FIRE].Range(0, ENEMY_FIRE_JITTER);
+		pWorld->m_Enemies.Timer[ENEMY_TIMER_FIRE][iIndex] = (float)dNext;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : StrafeScript () (Private, Static)
+// Desc : Waits out its head start, then flies in, strafes, holds still,
+//		fires and retreats to where it began, strafing the other way the
+//		next time round. Movement between these is left to MoveEnemies().
+//-----------------------------------------------------------------------------
+ScriptTask CSimWorld::StrafeScript( CScriptRunner& /*scripts*/, CSimWorld *pWorld, EntityHandle hEnemy,
+									const BulletPattern *pPattern )
+{
+	CEntityStore& enemies = pWorld->m_Enemies;
+	int iIndex = enemies.IndexOf(hEnemy);
+
+	double	dTime	= enemies.Timer[ENEMY_TIMER_FIRE][iIndex];
+	float	fSide	= (iIndex & 1) ? 1.0f : -1.0f;
+	enemies.VelX[iIndex] = enemies.VelY[iIndex] = 0;
+
+	for (;;)
+	{
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dTime)) < 0)
+			co_return;
+		enemies.VelY[iIndex] = STRAFE_FLY_SPEED;
+
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dTime += STRAFE_FLY_TIME)) < 0)
+			co_return;
+		enemies.VelX[iIndex] = fSide * STRAFE_SPEED;
+		enemies.VelY[iIndex] = 0;
+
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dTime += STRAFE_TIME)) < 0)
+			co_return;
+		enemies.VelX[iIndex] = 0;
+
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dTime += STRAFE_HOLD)) < 0)
+			co_return;
+		pWorld->EnemyFire(iIndex, pPattern);
+		enemies.VelY[iIndex] = -STRAFE_FLY_SPEED;
+
+		dTime += STRAFE_FLY_TIME;
+		enemies.Timer[ENEMY_TIMER_FIRE][iIndex] = (float)(dTime + STRAFE_FLY_TIME + STRAFE_TIME + STRAFE_HOLD);
+
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dTime)) < 0)
+			co_return;
+		enemies.VelY[iIndex] = 0;
+		fSide = -fSide;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ChaseScript () (Private, Static)
+// Desc : Homes in on the nearer player at its spawn speed, steered by
+//		MoveEnemies() from the flow field, and fires as the drift script
+//		does.
+//-----------------------------------------------------------------------------
+ScriptTask CSimWorld::ChaseScript( CScriptRunner& /*scripts*/, CSimWorld *pWorld, EntityHandle hEnemy,
+								   const BulletPattern *pPattern )
+{
+	CEntityStore& enemies = pWorld->m_Enemies;
+	int iIndex = enemies.IndexOf(hEnemy);
+
+	double dNext = enemies.Timer[ENEMY_TIMER_FIRE][iIndex];
+	enemies.Flags[iIndex] |= ENEMY_HOMING;
+	pWorld->m_bFlowField = true;
+
+	for (;;)
+	{
+		if ((iIndex = co_await pWorld->WaitEnemy(hEnemy, dNext)) < 0)
+			co_return;
+
+		pWorld->EnemyFire(iIndex, pPattern);
+
+		dNext = pWorld->m_dTime + ENEMY_FIRE_PERIOD - pWorld->m_Random[SIM_RANDOM_FIRE].Range(0, ENEMY_FIRE_JITTER);
+		enemies.Timer[ENEMY_TIMER_FIRE][iIndex] = (float)dNext;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : PlayerFire () (Private)
+// Desc : Fires when the cooldown has run out. Every attempt restarts it.
+//-----------------------------------------------------------------------------
+void CSimWorld::PlayerFire( int iIndex )
+{
+	SimPlayer& player = m_Players[iIndex];
+
+	if (m_dTime >= player.dFireReady)
+	{
+		double w, h;
+		GetPlayerSize(iIndex, w, h);
+
+		Vec2 position(player.Position.x, player.Position.y - h / 1.5);
+
+		// A full pool drops the shot rather than growing
+		if (m_Bullets.Spawn((float)position.x, (float)position.y, 0, (float)PLAYER_BULLET_SPEED, iIndex) != INVALID_ENTITY)
+			RaiseEvent(SimEvent::EVENT_SHOT, iIndex, false, position);
+	}
+
+	player.dFireReady = m_dTime + PLAYER_FIRE_COOLDOWN;
+}
+
+//-----------------------------------------------------------------------------
+// Name : EnemyFire () (Private)
+// Desc : Starts the pattern, aimed at the nearer player. Enemies without
+//		one hold their fire.
+//-----------------------------------------------------------------------------
+void CSimWorld::EnemyFire( size_t iIndex, const BulletPattern *pPattern )
+{
+	float& cooldown = m_Enemies.Timer[ENEMY_TIMER_COOLDOWN][iIndex];
+
+	if (pPattern && m_dTime >= cooldown)
+	{
+		Vec2 position(m_Enemies.X[iIndex], m_Enemies.Y[iIndex] + m_Config.dEnemyHeight / 1.5);
+
+		int iTarget = 0;
+		for (int i = 1; i < SIM_PLAYER_COUNT; i++)
+		{
+			if ((m_Players[i].Position - position).Magnitude() < (m_Players[iTarget].Position - position).Magnitude())
+				iTarget = i;
+		}
+
+		float fAim = CBulletEmitter::AimAt((float)position.x, (float)position.y,
+										   (float)m_Players[iTarget].Position.x, (float)m_Players[iTarget].Position.y);
+
+		if (m_Emitters.Start(pPattern, (float)position.x, (float)position.y, fAim,
+							 BULLET_OWNER_ENEMY, m_dTime, m_Bullets) > 0)
+			RaiseEvent(SimEvent::EVENT_SHOT, (int)iIndex, true, position);
+	}
+
+	cooldown = (float)(m_dTime + ENEMY_FIRE_COOLDOWN);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ExplodePlayer () (Private)
+// Desc : Costs a life and (re)starts the explosion where the player is.
+//-----------------------------------------------------------------------------
+void CSimWorld::ExplodePlayer( int iIndex )
+{
+	SimPlayer& player = m_Players[iIndex];
+
+	player.iLives--;
+	player.bExploding			= true;
+	player.ExplosionPosition	= player.Position;
+
+	m_Timers.Cancel(player.hExplosionTimer);
+	player.hExplosionTimer = ScheduleTimer(m_dTime + m_Config.fExplosionTime,
+										   RunTimer<&CSimWorld::OnPlayerExplosionTimer>, iIndex);
+
+	RaiseEvent(SimEvent::EVENT_EXPLOSION, iIndex, false, player.Position);
+	RaiseEvent(SimEvent::EVENT_SOUND, iIndex, false, player.Position, SimEvent::SOUND_EXPLOSION);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Respawn () (Private)
+// Desc : Puts a player back at its start point without a blended jump.
+//-----------------------------------------------------------------------------
+void CSimWorld::Respawn( int iIndex )
+{
+	m_Players[iIndex].Position		= m_Players[iIndex].Spawn;
+	m_Players[iIndex].PrevPosition	= m_Players[iIndex].Spawn;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ExplodeEnemy () (Private)
+// Desc : An exploding enemy no longer collides and is removed afterwards.
+//-----------------------------------------------------------------------------
+void CSimWorld::ExplodeEnemy( size_t iIndex )
+{
+	Vec2 position(m_Enemies.X[iIndex], m_Enemies.Y[iIndex]);
+
+	m_Enemies.Flags[iIndex] |= ENEMY_EXPLODING;
+	m_Enemies.Timer[ENEMY_TIMER_EXPLOSION][iIndex] = (float)m_dTime;
+	ScheduleTimer(m_dTime + m_Config.fExplosionTime,
+				  RunTimer<&CSimWorld::OnEnemyExplosionTimer>, PackHandle(m_Enemies.HandleAt(iIndex)));
+
+	RaiseEvent(SimEvent::EVENT_EXPLOSION, (int)iIndex, true, position);
+	RaiseEvent(SimEvent::EVENT_SOUND, (int)iIndex, true, position, SimEvent::SOUND_EXPLOSION);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RaiseEvent () (Private)
+//-----------------------------------------------------------------------------
+void CSimWorld::RaiseEvent( SimEvent::TYPE type, int iSubject, bool bEnemy, const Vec2& position, int iSound )
+{
+	SimEvent event;
+	event.Type		= type;
+	event.iSound	= iSound;
+	event.iSubject	= iSubject;
+	event.bEnemy	= bEnemy;
+	event.Position	= position;
+	m_Events.push_back(event);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPlayerMask () (Private)
+// Desc : Mask for the player's current heading, NULL without masks.
+//-----------------------------------------------------------------------------
+const CCollisionMask* CSimWorld::GetPlayerMask( int iIndex ) const
+{
+	if (m_PlayerMasks.empty() || m_PlayerMasks[m_Players[iIndex].iHeading].IsEmpty())
+		return NULL;
+
+	return &m_PlayerMasks[m_Players[iIndex].iHeading];
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetEnemyMask () (Private)
+//-----------------------------------------------------------------------------
+const CCollisionMask* CSimWorld::GetEnemyMask( ) const
+{
+	return m_EnemyMask.IsEmpty() ? NULL : &m_EnemyMask;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBulletMask () (Private)
+//-----------------------------------------------------------------------------
+const CCollisionMask* CSimWorld::GetBulletMask( ) const
+{
+	return m_BulletMask.IsEmpty() ? NULL : &m_BulletMask;
+}
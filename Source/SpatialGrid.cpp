@@ -0,0 +1,205 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.cpp
+//
+// Desc: Uniform grid broadphase. Cells map row by row onto a power of two
+//	   bucket table, and the entries are stored as one flat list sorted by
+//	   bucket (a counting sort per Build). Boxes inserted in rough spatial
+//	   order, like enemy formations, then touch memory almost linearly.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpatialGrid.h"
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpatialGrid () (Constructor)
+// Desc : CSpatialGrid Class Constructor
+//-----------------------------------------------------------------------------
+CSpatialGrid::CSpatialGrid()
+{
+	m_uBucketMask = 0;
+	Reset(128.0f);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpatialGrid () (Destructor)
+// Desc : CSpatialGrid Class Destructor
+//-----------------------------------------------------------------------------
+CSpatialGrid::~CSpatialGrid()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Sets the cell size. Cells a bit larger than the common box keep
+//		most boxes in one to four cells.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Reset( float fCellSize )
+{
+	if (fCellSize < 1.0f)
+		fCellSize = 1.0f;
+
+	m_fInvCellSize = 1.0f / fCellSize;
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Clear( )
+{
+	m_Boxes.clear();
+	m_nEntries = 0;
+	m_BucketStart.assign(2, 0);
+	m_uBucketMask = 0;
+	m_uRowPitch = 1;
+	m_iMinCellX = 0x7FFFFFFF;
+	m_iMaxCellX = -0x7FFFFFFF;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Insert ()
+// Desc : Queues a box; it becomes visible to queries after Build().
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Insert( unsigned int uId, float fMinX, float fMinY, float fMaxX, float fMaxY )
+{
+	Box box = { fMinX, fMinY, fMaxX, fMaxY, uId, Cell(fMinX), Cell(fMinY), Cell(fMaxX), Cell(fMaxY) };
+	m_Boxes.push_back(box);
+	m_nEntries += (size_t)(box.iCellX1 - box.iCellX0 + 1) * (box.iCellY1 - box.iCellY0 + 1);
+
+	if (box.iCellX0 < m_iMinCellX) m_iMinCellX = box.iCellX0;
+	if (box.iCellX1 > m_iMaxCellX) m_iMaxCellX = box.iCellX1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Counting sort of the boxes' cells into buckets. The table gets
+//		about two buckets per entry and rows as wide as the boxes spread,
+//		so most buckets hold one cell.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Build( )
+{
+	size_t nBuckets = 16;
+	while (nBuckets < m_nEntries * 2)
+		nBuckets <<= 1;
+	m_uBucketMask = (unsigned int)(nBuckets - 1);
+
+	m_uRowPitch = 1;
+	if (m_iMaxCellX >= m_iMinCellX)
+	{
+		unsigned int uColumns = (unsigned int)(m_iMaxCellX - m_iMinCellX) + 1;
+		while (m_uRowPitch < uColumns && m_uRowPitch < nBuckets)
+			m_uRowPitch <<= 1;
+	}
+
+	m_BucketStart.assign(nBuckets + 1, 0);
+	// Only ever grow these; everything past m_nEntries is stale
+	if (m_Entries.size() < m_nEntries)
+	{
+		m_Entries.resize(m_nEntries);
+		m_EntryBucket.resize(m_nEntries);
+	}
+
+	// Count, shifted by one so the prefix sum gives each bucket's start
+	size_t n = 0;
+	for (size_t b = 0; b < m_Boxes.size(); b++)
+	{
+		const Box& box = m_Boxes[b];
+		for (int y = box.iCellY0; y <= box.iCellY1; y++)
+		{
+			for (int x = box.iCellX0; x <= box.iCellX1; x++)
+			{
+				unsigned int uBucket = Bucket(x, y);
+				m_EntryBucket[n++] = uBucket;
+				m_BucketStart[uBucket + 1]++;
+			}
+		}
+	}
+
+	for (size_t i = 1; i <= nBuckets; i++)
+		m_BucketStart[i] += m_BucketStart[i - 1];
+
+	// Fill, using each bucket's start as a write cursor
+	n = 0;
+	for (size_t b = 0; b < m_Boxes.size(); b++)
+	{
+		const Box& box = m_Boxes[b];
+		for (int y = box.iCellY0; y <= box.iCellY1; y++)
+		{
+			for (int x = box.iCellX0; x <= box.iCellX1; x++)
+			{
+				Entry& entry = m_Entries[m_BucketStart[m_EntryBucket[n++]]++];
+				entry.uBox	 = (unsigned int)b;
+				entry.iCellX = x;
+				entry.iCellY = y;
+			}
+		}
+	}
+
+	// The cursors ended on the next bucket's start; shift back
+	for (size_t i = nBuckets; i > 0; i--)
+		m_BucketStart[i] = m_BucketStart[i - 1];
+	m_BucketStart[0] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Query ()
+// Desc : A box spanning several cells is met once per shared cell; it is
+//		only reported from the cell holding the top-left corner of the
+//		overlap, which is exactly one of them.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Query( float fMinX, float fMinY, float fMaxX, float fMaxY, std::vector<unsigned int>& ids ) const
+{
+	ids.clear();
+
+	int x0 = Cell(fMinX), x1 = Cell(fMaxX);
+	int y0 = Cell(fMinY), y1 = Cell(fMaxY);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			unsigned int uBucket = Bucket(x, y);
+			for (unsigned int i = m_BucketStart[uBucket]; i < m_BucketStart[uBucket + 1]; i++)
+			{
+				const Entry& entry = m_Entries[i];
+				if (entry.iCellX != x || entry.iCellY != y)
+					continue;
+
+				const Box& box = m_Boxes[entry.uBox];
+				if (box.fMinX >= fMaxX || box.fMaxX <= fMinX || box.fMinY >= fMaxY || box.fMaxY <= fMinY)
+					continue;
+
+				float cx = box.fMinX > fMinX ? box.fMinX : fMinX;
+				float cy = box.fMinY > fMinY ? box.fMinY : fMinY;
+				if (Cell(cx) == x && Cell(cy) == y)
+					ids.push_back(box.uId);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Cell () (Private)
+//-----------------------------------------------------------------------------
+int CSpatialGrid::Cell( float f ) const
+{
+	// floor() without the library call; the cast truncates toward zero
+	float fCell = f * m_fInvCellSize;
+	int iCell = (int)fCell;
+	return (fCell < (float)iCell) ? iCell - 1 : iCell;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Bucket () (Private)
+//-----------------------------------------------------------------------------
+unsigned int CSpatialGrid::Bucket( int x, int y ) const
+{
+	// Unsigned wrap keeps negative cells consistent
+	return ((unsigned int)y * m_uRowPitch + (unsigned int)x) & m_uBucketMask;
+}
@@ -1,7 +1,12 @@
 #include "Sprite.h"
+#include "SpritePyramid.h"
 
 extern HINSTANCE g_hInst;
 
+// drawScaled() uses a level as it is when the size asked for is within
+// 1/SNAP_FRACTION of it.
+const int SNAP_FRACTION = 16;
+
 Sprite::Sprite(int imageID, int maskID)
 {
 	// Load the bitmap resources.
@@ -19,6 +24,9 @@ Sprite::Sprite(int imageID, int maskID)
 	mcTransparentColor = 0;
 	mhSpriteDC = 0;
 	frameCounter = 0;
+	mpPyramid = NULL;
+	mpRotations = NULL;
+	miRotation = 0;
 }
 
 Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
@@ -37,6 +45,9 @@ Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
 	mcTransparentColor = 0;
 	mhSpriteDC = 0;
 	frameCounter = 0;
+	mpPyramid = NULL;
+	mpRotations = NULL;
+	miRotation = 0;
 }
 
 Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor)
@@ -52,6 +63,9 @@ Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor)
 
 	this->szImageFile = szImageFile;
 	frameCounter = 0;
+	mpPyramid = NULL;
+	mpRotations = NULL;
+	miRotation = 0;
 }
 
 Sprite::~Sprite()
@@ -61,6 +75,8 @@ Sprite::~Sprite()
 	DeleteObject(mhMask);
 
 	DeleteDC(mhSpriteDC);
+
+	delete mpPyramid;
 }
 
 void Sprite::update(float dt)
@@ -83,12 +99,144 @@ void Sprite::setBackBuffer(const BackBuffer *pBackBuffer)
 
 void Sprite::draw()
 {
-	if( mhMask != 0 )
+	if( mpRotations != NULL )
+	{
+		if( mpBackBuffer == NULL )
+			return;
+
+		const CMaskedImage *pImage = mpRotations->GetImage(miRotation);
+
+		// Upper-left corner.
+		int x = (int)mPosition.x - (pImage->Width() / 2);
+		int y = (int)mPosition.y - (pImage->Height() / 2);
+
+		pImage->Draw(mpBackBuffer->getDC(), mhSpriteDC, x, y);
+	}
+	else if( mhMask != 0 )
 		drawMask();
 	else
 		drawTransparent();
 }
 
+void Sprite::drawScaled(double dScale)
+{
+	if( mpBackBuffer == NULL )
+		return;
+
+	HDC hBackBufferDC = mpBackBuffer->getDC();
+
+	// Headings are only cached at their own size
+	const CMaskedImage *pLevel = NULL;
+	int iWidth, iHeight;
+	if( mpRotations != NULL )
+	{
+		pLevel = mpRotations->GetImage(miRotation);
+		iWidth = pLevel->Width();
+		iHeight = pLevel->Height();
+	}
+	else
+	{
+		if( mpPyramid == NULL )
+			mpPyramid = new CSpritePyramid(this);
+
+		pLevel = mpPyramid->GetLevel(hBackBufferDC, dScale);
+		iWidth = mImageBM.bmWidth;
+		iHeight = mImageBM.bmHeight;
+	}
+
+	if( pLevel == NULL )
+	{
+		draw();
+		return;
+	}
+
+	// The size asked for, whatever the level's own
+	iWidth = max(1, (int)(iWidth * dScale + 0.5));
+	iHeight = max(1, (int)(iHeight * dScale + 0.5));
+
+	// Within a few percent of the level's own size, like a view fitted a
+	// little under full size, the level is drawn as it is: a plain masked
+	// blit instead of two stretches.
+	if( abs(pLevel->Width() - iWidth) <= pLevel->Width() / SNAP_FRACTION &&
+		abs(pLevel->Height() - iHeight) <= pLevel->Height() / SNAP_FRACTION )
+	{
+		iWidth = pLevel->Width();
+		iHeight = pLevel->Height();
+	}
+
+	// Upper-left corner.
+	int x = (int)mPosition.x - (iWidth / 2);
+	int y = (int)mPosition.y - (iHeight / 2);
+
+	if( pLevel->Width() == iWidth && pLevel->Height() == iHeight )
+		pLevel->Draw(hBackBufferDC, mhSpriteDC, x, y);
+	else
+		pLevel->DrawScaled(hBackBufferDC, mhSpriteDC, x, y, iWidth, iHeight);
+}
+
+void Sprite::setRotation(const CRotationCache *pRotations, int iStep)
+{
+	mpRotations = (pRotations && pRotations->GetStepCount()) ? pRotations : NULL;
+	miRotation = mpRotations ? mpRotations->WrapStep(iStep) : 0;
+}
+
+bool Sprite::getPixels(std::vector<DWORD>& pixels)
+{
+	// Always the loaded image, whatever rotation is being drawn.
+	int w = mImageBM.bmWidth;
+	int h = mImageBM.bmHeight;
+
+	if( mhImage == 0 || w <= 0 || h <= 0 )
+		return false;
+
+	BITMAPINFO bi;
+	ZeroMemory(&bi, sizeof(BITMAPINFO));
+	bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bi.bmiHeader.biWidth = w;
+	bi.bmiHeader.biHeight = -h; // top-down
+	bi.bmiHeader.biPlanes = 1;
+	bi.bmiHeader.biBitCount = 32;
+	bi.bmiHeader.biCompression = BI_RGB;
+
+	pixels.resize(w * h);
+	std::vector<DWORD> mask;
+
+	HDC hdc = GetDC(NULL);
+	bool bRead = GetDIBits(hdc, mhImage, 0, h, &pixels[0], &bi, DIB_RGB_COLORS) == h;
+	if( bRead && mhMask != 0 )
+	{
+		mask.resize(w * h);
+		bRead = GetDIBits(hdc, mhMask, 0, h, &mask[0], &bi, DIB_RGB_COLORS) == h;
+	}
+	ReleaseDC(NULL, hdc);
+
+	if( !bRead )
+		return false;
+
+	// Transparent colour in the DIB's 0x00RRGGBB pixel order.
+	DWORD key = (GetRValue(mcTransparentColor) << 16) | (GetGValue(mcTransparentColor) << 8) | GetBValue(mcTransparentColor);
+
+	for( int i = 0; i < w * h; i++ )
+	{
+		DWORD c = pixels[i] & PIXEL_COLOR_MASK;
+
+		// White mask pixels, or pixels matching the colour key, are see-through.
+		bool bClear = mhMask != 0 ? (mask[i] & PIXEL_COLOR_MASK) != 0 : c == key;
+		pixels[i] = bClear ? 0 : c | PIXEL_ALPHA_MASK;
+	}
+
+	return true;
+}
+
+bool Sprite::getCollisionMask(CCollisionMask& mask)
+{
+	std::vector<DWORD> pixels;
+	if( !getPixels(pixels) )
+		return false;
+
+	return mask.Create((const uint32_t *)&pixels[0], mImageBM.bmWidth, mImageBM.bmHeight, PIXEL_ALPHA_MASK);
+}
+
 void Sprite::drawMask()
 {
 	if( mpBackBuffer == NULL )
@@ -181,80 +329,3 @@ void Sprite::drawTransparent()
 	SetBkColor(hBackBuffer, crOldBack);
 	SetTextColor(hBackBuffer, crOldText);
 }
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-AnimatedSprite::AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount) 
-			: Sprite (szImageFile, szMaskFile)
-{
-	mptFrameCrop.x = rcFirstFrame.left;
-	mptFrameCrop.y = rcFirstFrame.top;
-	mptFrameStartCrop = mptFrameCrop;
-	miFrameWidth = rcFirstFrame.right - rcFirstFrame.left;
-	miFrameHeight = rcFirstFrame.bottom - rcFirstFrame.top;
-	miFrameCount = iFrameCount;
-}
-
-void AnimatedSprite::SetFrame(int iIndex)
-{
-	// index must be in range
-	assert(iIndex >= 0 && iIndex < miFrameCount && "AnimatedSprite frame Index must be in range!");
-
-	if (iIndex >= 0 && iIndex <= 3) {
-		mptFrameCrop.x = mptFrameStartCrop.x + iIndex*miFrameWidth;
-		mptFrameCrop.y = mptFrameStartCrop.y + 0*miFrameHeight;
-	}
-	if (iIndex > 3 && iIndex <= 7) {
-		mptFrameCrop.x = mptFrameStartCrop.x + (iIndex - 4)*miFrameWidth;
-		mptFrameCrop.y = mptFrameStartCrop.y + 1 * miFrameHeight;
-	}
-	if (iIndex > 7 && iIndex <= 11) {
-		mptFrameCrop.x = mptFrameStartCrop.x + (iIndex - 8)*miFrameWidth;
-		mptFrameCrop.y = mptFrameStartCrop.y + 2 * miFrameHeight;
-	}
-	if (iIndex > 11 && iIndex <= 15) {
-		mptFrameCrop.x = mptFrameStartCrop.x + (iIndex - 12)*miFrameWidth;
-		mptFrameCrop.y = mptFrameStartCrop.y + 3 * miFrameHeight;
-	}
-}
-
-void AnimatedSprite::draw()
-{
-	if( mpBackBuffer == NULL )
-		return;
-
-	// The position BitBlt wants is not the sprite's center
-	// position; rather, it wants the upper-left position,
-	// so compute that.
-	int w = miFrameWidth;
-	int h = miFrameHeight;
-
-	HDC hBackBufferDC = mpBackBuffer->getDC();
-
-	// Upper-left corner.
-	int x = (int)mPosition.x - (w / 2);
-	int y = (int)mPosition.y - (h / 2);
-
-	// Note: For this masking technique to work, it is assumed
-	// the backbuffer bitmap has been cleared to some
-	// non-zero value.
-	// Select the mask bitmap.
-	HGDIOBJ oldObj = SelectObject(mhSpriteDC, mhMask);
-
-	// Draw the mask to the backbuffer with SRCAND. This
-	// only draws the black pixels in the mask to the backbuffer,
-	// thereby marking the pixels we want to draw the sprite
-	// image onto.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCAND);
-
-	// Now select the image bitmap.
-	SelectObject(mhSpriteDC, mhImage);
-
-	// Draw the image to the backbuffer with SRCPAINT. This
-	// will only draw the image onto the pixels that where previously
-	// marked black by the mask.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCPAINT);
-
-	// Restore the original bitmap object.
-	SelectObject(mhSpriteDC, oldObj);
-}
\ No newline at end of file
@@ -0,0 +1,240 @@
+//-----------------------------------------------------------------------------
+// File: SpritePyramid.cpp
+//
+// Desc: Lazily built set of pre-scaled copies of a sprite, made with the
+//	   resize engine. Drawing at a scale then costs a masked blit of the
+//	   nearest level instead of a resample. All pyramids share one memory
+//	   budget and the least recently drawn levels are evicted first.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpritePyramid Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpritePyramid.h"
+#include "Sprite.h"
+#include "ResizeEngine.h"
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+CSpritePyramid::LevelList	CSpritePyramid::s_Lru;
+size_t						CSpritePyramid::s_uMemoryUsed	= 0;
+size_t						CSpritePyramid::s_uMemoryBudget = 16 * 1024 * 1024;
+
+//-----------------------------------------------------------------------------
+// Name : ResampleCoverage () (Static)
+// Desc : Resamples colour and coverage separately. See-through pixels are
+//		black, so the colour is premultiplied by coverage and the key colour
+//		never bleeds into the edges; it is divided back out afterwards.
+//-----------------------------------------------------------------------------
+static void ResampleCoverage(const std::vector<DWORD>& src, int iSrcWidth, int iSrcHeight,
+							 std::vector<DWORD>& dst, int iDstWidth, int iDstHeight, CGenericFilter *pFilter)
+{
+	int n = iSrcWidth * iSrcHeight;
+	std::vector<RGBQUAD> color(n), cover(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		DWORD c = (src[i] & PIXEL_ALPHA_MASK) ? src[i] : 0;
+		BYTE a = (src[i] & PIXEL_ALPHA_MASK) ? 255 : 0;
+
+		color[i].rgbBlue		= (BYTE)(c & 0xFF);
+		color[i].rgbGreen		= (BYTE)((c >> 8) & 0xFF);
+		color[i].rgbRed			= (BYTE)((c >> 16) & 0xFF);
+		color[i].rgbReserved	= 0;
+
+		cover[i].rgbBlue		= a;
+		cover[i].rgbGreen		= a;
+		cover[i].rgbRed			= a;
+		cover[i].rgbReserved	= 0;
+	}
+
+	CResizableImage imgColor, imgCover;
+
+	imgColor.CreateFromPixels(&color[0], iSrcWidth, iSrcHeight);
+	imgColor.SetFilter(pFilter);
+	imgColor.Resample(iDstWidth, iDstHeight);
+
+	imgCover.CreateFromPixels(&cover[0], iSrcWidth, iSrcHeight);
+	imgCover.SetFilter(pFilter);
+	imgCover.Resample(iDstWidth, iDstHeight);
+
+	const RGBQUAD *pColor = imgColor.Pixels();
+	const RGBQUAD *pCover = imgCover.Pixels();
+
+	dst.resize(iDstWidth * iDstHeight);
+	for (int i = 0; i < iDstWidth * iDstHeight; i++)
+	{
+		int a = pCover[i].rgbRed;
+		if (a < 128)
+		{
+			dst[i] = 0;
+			continue;
+		}
+
+		DWORD r = min(255, pColor[i].rgbRed * 255 / a);
+		DWORD g = min(255, pColor[i].rgbGreen * 255 / a);
+		DWORD b = min(255, pColor[i].rgbBlue * 255 / a);
+		dst[i] = PIXEL_ALPHA_MASK | (r << 16) | (g << 8) | b;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CSpritePyramid () (Constructor)
+// Desc : CSpritePyramid Class Constructor. Only the native pixels are read
+//		here, levels are built when first drawn.
+//-----------------------------------------------------------------------------
+CSpritePyramid::CSpritePyramid(Sprite *pSprite)
+{
+	for (int i = 0; i < LEVEL_COUNT; i++)
+		m_pLevels[i] = NULL;
+
+	m_iWidth  = 0;
+	m_iHeight = 0;
+
+	if (pSprite && pSprite->getPixels(m_Source))
+	{
+		m_iWidth  = pSprite->mImageBM.bmWidth;
+		m_iHeight = pSprite->mImageBM.bmHeight;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpritePyramid () (Destructor)
+// Desc : CSpritePyramid Class Destructor
+//-----------------------------------------------------------------------------
+CSpritePyramid::~CSpritePyramid()
+{
+	for (int i = 0; i < LEVEL_COUNT; i++)
+		ReleaseLevel(i);
+}
+
+//-----------------------------------------------------------------------------
+// Name : LevelFromScale () (Static)
+// Desc : Nearest level to a scale factor, clamped to the pyramid.
+//-----------------------------------------------------------------------------
+int CSpritePyramid::LevelFromScale(double dScale)
+{
+	if (dScale <= 0.0)
+		return 0;
+
+	int iLevel = LEVEL_NATIVE + (int)floor(LEVELS_PER_OCTAVE * log(dScale) / log(2.0) + 0.5);
+	return max(0, min(LEVEL_COUNT - 1, iLevel));
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScaleFromLevel () (Static)
+// Desc : Scale factor a level was built at.
+//-----------------------------------------------------------------------------
+double CSpritePyramid::ScaleFromLevel(int iLevel)
+{
+	return pow(2.0, double(iLevel - LEVEL_NATIVE) / LEVELS_PER_OCTAVE);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetMemoryBudget () (Static)
+// Desc : Changes the shared budget, evicting levels if it shrank.
+//-----------------------------------------------------------------------------
+void CSpritePyramid::SetMemoryBudget(size_t uBytes)
+{
+	s_uMemoryBudget = uBytes;
+	Trim();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetLevel ()
+// Desc : Returns the level nearest to dScale, building it on first use.
+//-----------------------------------------------------------------------------
+const CMaskedImage* CSpritePyramid::GetLevel(HDC hdc, double dScale)
+{
+	if (m_Source.empty())
+		return NULL;
+
+	int iLevel = LevelFromScale(dScale);
+
+	if (!m_pLevels[iLevel] && !BuildLevel(hdc, iLevel))
+		return NULL;
+
+	// Most recently drawn levels are evicted last
+	s_Lru.splice(s_Lru.begin(), s_Lru, m_LruPos[iLevel]);
+
+	return m_pLevels[iLevel];
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildLevel () (Private)
+// Desc : Resamples the native pixels into a new level.
+//-----------------------------------------------------------------------------
+bool CSpritePyramid::BuildLevel(HDC hdc, int iLevel)
+{
+	double dScale = ScaleFromLevel(iLevel);
+	int iWidth = max(1, (int)floor(m_iWidth * dScale + 0.5));
+	int iHeight = max(1, (int)floor(m_iHeight * dScale + 0.5));
+
+	CMaskedImage *pImage = new CMaskedImage();
+	bool bCreated;
+
+	if (iLevel == LEVEL_NATIVE)
+	{
+		bCreated = pImage->Create(hdc, &m_Source[0], m_iWidth, m_iHeight);
+	}
+	else
+	{
+		CLanczos3Filter lanczos;
+		CBicubicFilter bicubic;
+		std::vector<DWORD> pixels;
+
+		ResampleCoverage(m_Source, m_iWidth, m_iHeight, pixels, iWidth, iHeight,
+						 iLevel < LEVEL_NATIVE ? (CGenericFilter*)&lanczos : (CGenericFilter*)&bicubic);
+		bCreated = pImage->Create(hdc, &pixels[0], iWidth, iHeight);
+	}
+
+	if (!bCreated)
+	{
+		delete pImage;
+		return false;
+	}
+
+	LevelRef ref;
+	ref.pPyramid = this;
+	ref.iLevel = iLevel;
+	s_Lru.push_front(ref);
+
+	m_pLevels[iLevel] = pImage;
+	m_LruPos[iLevel] = s_Lru.begin();
+	s_uMemoryUsed += pImage->GetMemorySize();
+
+	Trim();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseLevel () (Private)
+// Desc : Frees a level and removes it from the shared LRU list.
+//-----------------------------------------------------------------------------
+void CSpritePyramid::ReleaseLevel(int iLevel)
+{
+	if (!m_pLevels[iLevel])
+		return;
+
+	s_uMemoryUsed -= m_pLevels[iLevel]->GetMemorySize();
+	s_Lru.erase(m_LruPos[iLevel]);
+
+	delete m_pLevels[iLevel];
+	m_pLevels[iLevel] = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Trim () (Static, Private)
+// Desc : Evicts least recently drawn levels until the budget is met. The most
+//		recent level is always kept, even if it alone is over budget.
+//-----------------------------------------------------------------------------
+void CSpritePyramid::Trim()
+{
+	while (s_uMemoryUsed > s_uMemoryBudget && s_Lru.size() > 1)
+	{
+		LevelRef ref = s_Lru.back();
+		ref.pPyramid->ReleaseLevel(ref.iLevel);
+	}
+}
@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// File: SpriteSheet.cpp
+//
+// Desc: Sprite sheet metadata, frame timing only.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpriteSheet Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpriteSheet.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// CSpriteSheet Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpriteSheet () (Constructor)
+// Desc : CSpriteSheet Class Constructor
+//-----------------------------------------------------------------------------
+CSpriteSheet::CSpriteSheet()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpriteSheet () (Destructor)
+// Desc : CSpriteSheet Class Destructor
+//-----------------------------------------------------------------------------
+CSpriteSheet::~CSpriteSheet()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Load ()
+// Desc : The frame rectangles are checked to be there, not kept.
+//-----------------------------------------------------------------------------
+bool CSpriteSheet::Load( const char *szFileName )
+{
+	m_Durations.clear();
+
+	std::ifstream file(szFileName);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream in(line);
+		std::string tag;
+		int iLeft, iTop, iWidth, iHeight, iDuration;
+
+		if (!(in >> tag) || tag != "frame")
+			continue;
+		if (!(in >> iLeft >> iTop >> iWidth >> iHeight >> iDuration) || iDuration < 0)
+			continue;
+
+		m_Durations.push_back(iDuration);
+	}
+
+	return !m_Durations.empty();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetDuration ()
+//-----------------------------------------------------------------------------
+int CSpriteSheet::GetDuration( ) const
+{
+	int iDuration = 0;
+	for (size_t i = 0; i < m_Durations.size(); i++)
+		iDuration += m_Durations[i];
+
+	return iDuration;
+}
@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------------
+// File: SystemScheduler.cpp
+//
+// Desc: Runs a frame as a list of systems with declared data access. On a
+//	   job system every system is a job; the one that finishes last among
+//	   a system's dependencies hands it to the job system.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSystemScheduler Specific Includes
+//-----------------------------------------------------------------------------
+#include "SystemScheduler.h"
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+// CSystemScheduler Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSystemScheduler () (Constructor)
+// Desc : CSystemScheduler Class Constructor
+//-----------------------------------------------------------------------------
+CSystemScheduler::CSystemScheduler()
+{
+	m_pWaiting		= NULL;
+	m_nWaiting		= 0;
+	m_bTiming		= false;
+	m_pJobs			= NULL;
+	m_pRunCounter	= NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSystemScheduler () (Destructor)
+// Desc : CSystemScheduler Class Destructor
+//-----------------------------------------------------------------------------
+CSystemScheduler::~CSystemScheduler()
+{
+	delete [] m_pWaiting;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddSystem ()
+// Desc : The new system waits for every earlier one it conflicts with.
+//		Reading the same data is not a conflict.
+//-----------------------------------------------------------------------------
+int CSystemScheduler::AddSystem( const char *szName, SYSTEM_FUNC pFunc, void *pContext,
+								 uint32_t uReads, uint32_t uWrites )
+{
+	System system;
+	system.szName			= szName;
+	system.pFunc			= pFunc;
+	system.pContext			= pContext;
+	system.uReads			= uReads;
+	system.uWrites			= uWrites;
+	system.nDependencies	= 0;
+	system.dSeconds			= 0;
+	system.ulRuns			= 0;
+
+	int iSystem = (int)m_Systems.size();
+	for (int i = 0; i < iSystem; i++)
+	{
+		System& earlier = m_Systems[i];
+		if ((earlier.uWrites & (uReads | uWrites)) || (earlier.uReads & uWrites))
+		{
+			earlier.Dependents.push_back(iSystem);
+			system.nDependencies++;
+		}
+	}
+
+	m_Systems.push_back(system);
+
+	delete [] m_pWaiting;
+	m_nWaiting = m_Systems.size();
+	m_pWaiting = new std::atomic<int>[m_nWaiting];
+
+	return iSystem;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+//-----------------------------------------------------------------------------
+void CSystemScheduler::Clear( )
+{
+	m_Systems.clear();
+
+	delete [] m_pWaiting;
+	m_pWaiting = NULL;
+	m_nWaiting = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Run ()
+//-----------------------------------------------------------------------------
+void CSystemScheduler::Run( CJobSystem *pJobs )
+{
+	if (!pJobs)
+	{
+		for (int i = 0; i < (int)m_Systems.size(); i++)
+			Execute(i);
+		return;
+	}
+
+	for (size_t i = 0; i < m_Systems.size(); i++)
+		m_pWaiting[i].store(m_Systems[i].nDependencies, std::memory_order_relaxed);
+
+	CJobCounter counter;
+	m_pJobs			= pJobs;
+	m_pRunCounter	= &counter;
+
+	for (size_t i = 0; i < m_Systems.size(); i++)
+	{
+		if (m_Systems[i].nDependencies == 0)
+			pJobs->Run(SystemJob, this, i, i + 1, &counter);
+	}
+
+	pJobs->Wait(counter);
+	m_pJobs			= NULL;
+	m_pRunCounter	= NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResetTimings ()
+//-----------------------------------------------------------------------------
+void CSystemScheduler::ResetTimings( )
+{
+	for (size_t i = 0; i < m_Systems.size(); i++)
+	{
+		m_Systems[i].dSeconds	= 0;
+		m_Systems[i].ulRuns		= 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute () (Private)
+// Desc : Only one thread runs a given system at a time, so its timing
+//		needs no lock.
+//-----------------------------------------------------------------------------
+void CSystemScheduler::Execute( int iSystem )
+{
+	System& system = m_Systems[iSystem];
+
+	if (!m_bTiming)
+	{
+		system.pFunc(system.pContext);
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	system.pFunc(system.pContext);
+	system.dSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	system.ulRuns++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SystemJob () (Private, Static)
+// Desc : Runs system iBegin, then releases the dependents it was the last
+//		dependency of. They join the run's counter before this job leaves
+//		it, so the count cannot touch zero early.
+//-----------------------------------------------------------------------------
+void CSystemScheduler::SystemJob( void *pData, size_t iBegin, size_t /*iEnd*/ )
+{
+	CSystemScheduler *pThis = (CSystemScheduler*)pData;
+	const System& system = pThis->m_Systems[iBegin];
+
+	pThis->Execute((int)iBegin);
+
+	for (size_t i = 0; i < system.Dependents.size(); i++)
+	{
+		int iDependent = system.Dependents[i];
+		if (pThis->m_pWaiting[iDependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			pThis->m_pJobs->Run(SystemJob, pThis, iDependent, iDependent + 1, pThis->m_pRunCounter);
+	}
+}
@@ -0,0 +1,288 @@
+//-----------------------------------------------------------------------------
+// File: TimerWheel.cpp
+//
+// Desc: Hierarchical timing wheel. Timers are pooled and linked into their
+//	   slot by index, so setting and cancelling never allocate once the
+//	   pool has grown to the busiest moment.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTimerWheel Specific Includes
+//-----------------------------------------------------------------------------
+#include "TimerWheel.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int		SLOT_MASK	= (1 << TIMER_WHEEL_BITS) - 1;
+	const int		DUE_LIST	= TIMER_WHEEL_LEVELS << TIMER_WHEEL_BITS;	// Timers expiring this tick
+	const uint64_t	WHEEL_SPAN	= (uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+}
+
+//-----------------------------------------------------------------------------
+// CTimerWheel Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTimerWheel () (Constructor)
+// Desc : CTimerWheel Class Constructor
+//-----------------------------------------------------------------------------
+CTimerWheel::CTimerWheel()
+{
+	m_iFree = -1;
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTimerWheel () (Destructor)
+// Desc : CTimerWheel Class Destructor
+//-----------------------------------------------------------------------------
+CTimerWheel::~CTimerWheel()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Schedule ()
+// Desc : Calls pFunc(pContext, uData) ulDelay ticks from now, one at least.
+//-----------------------------------------------------------------------------
+TimerHandle CTimerWheel::Schedule( uint64_t ulDelay, TIMER_FUNC pFunc, void *pContext, uint64_t uData )
+{
+	return ScheduleAt(m_ulNow + (ulDelay > 0 ? ulDelay : 1), pFunc, pContext, uData);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScheduleAt ()
+// Desc : Ticks already reached count as the next one.
+//-----------------------------------------------------------------------------
+TimerHandle CTimerWheel::ScheduleAt( uint64_t ulTick, TIMER_FUNC pFunc, void *pContext, uint64_t uData )
+{
+	int iTimer = m_iFree;
+	if (iTimer >= 0)
+	{
+		m_iFree = m_Timers[iTimer].iNext;
+	}
+	else
+	{
+		iTimer = (int)m_Timers.size();
+		m_Timers.push_back(Timer());
+		m_Timers[iTimer].uGeneration = 0;
+	}
+
+	Timer& timer	= m_Timers[iTimer];
+	timer.ulDue		= ulTick > m_ulNow ? ulTick : m_ulNow + 1;
+	timer.pFunc		= pFunc;
+	timer.pContext	= pContext;
+	timer.uData		= uData;
+
+	Insert(iTimer);
+	m_nPending++;
+
+	TimerHandle handle = { (unsigned int)iTimer, timer.uGeneration };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Cancel ()
+// Desc : False if the timer already ran or was cancelled.
+//-----------------------------------------------------------------------------
+bool CTimerWheel::Cancel( TimerHandle handle )
+{
+	if (!IsPending(handle))
+		return false;
+
+	Unlink((int)handle.uIndex);
+	Release((int)handle.uIndex);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsPending ()
+//-----------------------------------------------------------------------------
+bool CTimerWheel::IsPending( TimerHandle handle ) const
+{
+	return handle.uIndex < m_Timers.size() && m_Timers[handle.uIndex].uGeneration == handle.uGeneration &&
+		   m_Timers[handle.uIndex].iSlot >= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AdvanceTo ()
+// Desc : Runs every tick up to and including ulTick. With nothing pending
+//		the clock just moves, the slots being empty either way.
+//-----------------------------------------------------------------------------
+void CTimerWheel::AdvanceTo( uint64_t ulTick )
+{
+	while (m_ulNow < ulTick)
+	{
+		if (m_nPending == 0)
+		{
+			m_ulNow = ulTick;
+			break;
+		}
+
+		Tick();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Pending timers are released rather than forgotten, so handles to
+//		them go stale instead of matching timers set later.
+//-----------------------------------------------------------------------------
+void CTimerWheel::Clear( uint64_t ulTick )
+{
+	for (size_t i = 0; i < m_Timers.size(); i++)
+	{
+		if (m_Timers[i].iSlot >= 0)
+			Release((int)i);
+	}
+
+	for (int i = 0; i <= DUE_LIST; i++)
+		m_Head[i] = m_Tail[i] = -1;
+
+	m_ulNow		= ulTick;
+	m_nPending	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Insert () (Private)
+// Desc : Level L holds timers due within 64^(L+1) ticks of the next tick,
+//		in the slot of their due tick's L-th digit. Timers further out than
+//		the wheel reaches wait at its far end and are placed again from
+//		there.
+//-----------------------------------------------------------------------------
+void CTimerWheel::Insert( int iTimer )
+{
+	uint64_t ulBase	= m_ulNow + 1;
+	uint64_t ulDue	= m_Timers[iTimer].ulDue > ulBase ? m_Timers[iTimer].ulDue : ulBase;
+
+	if (ulDue - ulBase >= WHEEL_SPAN)
+		ulDue = ulBase + WHEEL_SPAN - 1;
+
+	uint64_t ulDelta = ulDue - ulBase;
+	int iLevel = 0;
+	while (iLevel < TIMER_WHEEL_LEVELS - 1 && ulDelta >= ((uint64_t)1 << (TIMER_WHEEL_BITS * (iLevel + 1))))
+		iLevel++;
+
+	Append(iTimer, (iLevel << TIMER_WHEEL_BITS) | (int)((ulDue >> (TIMER_WHEEL_BITS * iLevel)) & SLOT_MASK));
+}
+
+//-----------------------------------------------------------------------------
+// Name : Append () (Private)
+//-----------------------------------------------------------------------------
+void CTimerWheel::Append( int iTimer, int iSlot )
+{
+	Timer& timer = m_Timers[iTimer];
+	timer.iSlot	= iSlot;
+	timer.iNext	= -1;
+	timer.iPrev	= m_Tail[iSlot];
+
+	if (m_Tail[iSlot] >= 0)
+		m_Timers[m_Tail[iSlot]].iNext = iTimer;
+	else
+		m_Head[iSlot] = iTimer;
+	m_Tail[iSlot] = iTimer;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Unlink () (Private)
+//-----------------------------------------------------------------------------
+void CTimerWheel::Unlink( int iTimer )
+{
+	Timer& timer = m_Timers[iTimer];
+
+	if (timer.iPrev >= 0)
+		m_Timers[timer.iPrev].iNext = timer.iNext;
+	else
+		m_Head[timer.iSlot] = timer.iNext;
+
+	if (timer.iNext >= 0)
+		m_Timers[timer.iNext].iPrev = timer.iPrev;
+	else
+		m_Tail[timer.iSlot] = timer.iPrev;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release () (Private)
+// Desc : Back to the free list, with handles to it made stale.
+//-----------------------------------------------------------------------------
+void CTimerWheel::Release( int iTimer )
+{
+	Timer& timer = m_Timers[iTimer];
+	timer.iSlot	= -1;
+	timer.uGeneration++;
+	timer.iNext	= m_iFree;
+	m_iFree		= iTimer;
+	m_nPending--;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Cascade () (Private)
+// Desc : Spreads one higher slot over the levels below.
+//-----------------------------------------------------------------------------
+void CTimerWheel::Cascade( int iLevel, int iIndex )
+{
+	int iSlot = (iLevel << TIMER_WHEEL_BITS) | iIndex;
+	int iTimer = m_Head[iSlot];
+
+	m_Head[iSlot] = m_Tail[iSlot] = -1;
+	while (iTimer >= 0)
+	{
+		int iNext = m_Timers[iTimer].iNext;
+		Insert(iTimer);
+		iTimer = iNext;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Tick () (Private)
+// Desc : Refills the first level whenever it wraps, then runs its slot.
+//		The slot is moved to the due list first, so callbacks can cancel
+//		any timer and set new ones, even in the slot being run.
+//-----------------------------------------------------------------------------
+void CTimerWheel::Tick( )
+{
+	uint64_t ulTick = m_ulNow + 1;
+
+	if ((ulTick & SLOT_MASK) == 0)
+	{
+		for (int iLevel = 1; iLevel < TIMER_WHEEL_LEVELS; iLevel++)
+		{
+			int iIndex = (int)((ulTick >> (TIMER_WHEEL_BITS * iLevel)) & SLOT_MASK);
+			Cascade(iLevel, iIndex);
+			if (iIndex != 0)
+				break;
+		}
+	}
+
+	m_ulNow = ulTick;
+
+	int iSlot = (int)(ulTick & SLOT_MASK);
+	while (m_Head[iSlot] >= 0)
+	{
+		int iTimer = m_Head[iSlot];
+		Unlink(iTimer);
+		Append(iTimer, DUE_LIST);
+	}
+
+	while (m_Head[DUE_LIST] >= 0)
+	{
+		int iTimer = m_Head[DUE_LIST];
+		Unlink(iTimer);
+
+		// Timers from beyond the wheel's reach go round again
+		if (m_Timers[iTimer].ulDue > ulTick)
+		{
+			Insert(iTimer);
+			continue;
+		}
+
+		TIMER_FUNC	pFunc		= m_Timers[iTimer].pFunc;
+		void*		pContext	= m_Timers[iTimer].pContext;
+		uint64_t	uData		= m_Timers[iTimer].uData;
+
+		Release(iTimer);
+		pFunc(pContext, uData);
+	}
+}
@@ -0,0 +1,307 @@
+//-----------------------------------------------------------------------------
+// File: WaveSpawner.cpp
+//
+// Desc: Wave file parsing, formation layout and the built in stress
+//	   scenarios.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CWaveSpawner Specific Includes
+//-----------------------------------------------------------------------------
+#include "WaveSpawner.h"
+#include "MathDefs.h"
+#include <fstream>
+#include <sstream>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const char *SHAPE_NAMES[] = { "line", "column", "grid", "vee", "ring" };
+
+	//-------------------------------------------------------------------------
+	// Stress scenarios. Their enemies mostly come down the right of the
+	// screen, clear of where the players start, and hold their fire, so
+	// what they load is the enemy code rather than the bullets.
+	//-------------------------------------------------------------------------
+	struct WavePreset
+	{
+		const char*	szName;
+		const char*	szText;
+	};
+
+	const WavePreset PRESETS[] =
+	{
+		// Two blocks a second, each 24 bigger, thousands in within seconds
+		{ "ramp",
+		  "archetype drone drift none 90\n"
+		  "formation block grid 30 48\n"
+		  "wave 0 block drone 64 1200 -60 0.5 48 24\n" },
+
+		// Everything at once, then a steady stream
+		{ "swarm",
+		  "archetype drone drift none 60\n"
+		  "formation block grid 24 56\n"
+		  "formation file column 20\n"
+		  "wave 0 block drone 4000 1200 600\n"
+		  "wave 1 file drone 50 1200 -40 0.5 400 0\n" },
+
+		// Every shape and both scripts, some firing, as a game might look
+		{ "mixed",
+		  "archetype drone drift none 80\n"
+		  "archetype gunner drift single 40\n"
+		  "archetype striker strafe aimed 0\n"
+		  "formation block grid 40 32\n"
+		  "formation wing vee 60\n"
+		  "formation circle ring 40\n"
+		  "formation row line 80\n"
+		  "wave 0 row gunner 12 1200 40\n"
+		  "wave 1 block drone 128 1200 -60 3 40 32\n"
+		  "wave 4 wing striker 7 1200 -80 10 20\n"
+		  "wave 6 circle drone 64 1200 -300 8 30 16\n" },
+
+		// Thousands homing in at once, steered by one shared flow field
+		{ "chase",
+		  "archetype hunter chase none 70\n"
+		  "formation block grid 24 64\n"
+		  "wave 0 block hunter 3000 1200 -40\n" },
+	};
+
+	const int PRESET_COUNT = sizeof(PRESETS) / sizeof(PRESETS[0]);
+}
+
+//-----------------------------------------------------------------------------
+// CWaveSpawner Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CWaveSpawner () (Constructor)
+// Desc : CWaveSpawner Class Constructor
+//-----------------------------------------------------------------------------
+CWaveSpawner::CWaveSpawner()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CWaveSpawner () (Destructor)
+// Desc : CWaveSpawner Class Destructor
+//-----------------------------------------------------------------------------
+CWaveSpawner::~CWaveSpawner()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Parse ()
+// Desc : Replaces whatever was parsed before.
+//-----------------------------------------------------------------------------
+bool CWaveSpawner::Parse( const std::string& text )
+{
+	Clear();
+
+	std::istringstream file(text);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream in(line);
+		std::string tag;
+
+		if (!(in >> tag) || tag[0] == '#')
+			continue;
+
+		if (tag == "archetype")
+		{
+			EnemyArchetype archetype;
+			if (!(in >> archetype.Name >> archetype.Script >> archetype.Pattern >> archetype.fSpeed))
+				continue;
+
+			m_Archetypes.push_back(archetype);
+		}
+		else if (tag == "formation")
+		{
+			WaveFormation formation;
+			std::string shape;
+			if (!(in >> formation.Name >> shape >> formation.fSpacing))
+				continue;
+
+			int iShape = 0;
+			while (iShape < (int)(sizeof(SHAPE_NAMES) / sizeof(SHAPE_NAMES[0])) && shape != SHAPE_NAMES[iShape])
+				iShape++;
+			if (iShape == (int)(sizeof(SHAPE_NAMES) / sizeof(SHAPE_NAMES[0])))
+				continue;
+
+			formation.Shape = (WAVE_FORMATION_SHAPE)iShape;
+			if (!(in >> formation.iColumns) || formation.iColumns < 1)
+				formation.iColumns = 8;
+
+			m_Formations.push_back(formation);
+		}
+		else if (tag == "wave")
+		{
+			Wave wave;
+			std::string formation, archetype;
+			if (!(in >> wave.dTime >> formation >> archetype >> wave.nCount >> wave.x >> wave.y))
+				continue;
+
+			wave.iFormation = FindFormation(formation);
+			wave.iArchetype = FindArchetype(archetype);
+			if (wave.iFormation < 0 || wave.iArchetype < 0 || wave.nCount < 0)
+				continue;
+
+			if (!(in >> wave.dEvery >> wave.nTimes))
+			{
+				wave.dEvery	= 0;
+				wave.nTimes	= 1;
+			}
+			if (!(in >> wave.nMore))
+				wave.nMore = 0;
+			if (wave.nTimes < 1)
+				continue;
+
+			m_Waves.push_back(wave);
+		}
+	}
+
+	return !m_Waves.empty();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+//-----------------------------------------------------------------------------
+void CWaveSpawner::Clear( )
+{
+	m_Archetypes.clear();
+	m_Formations.clear();
+	m_Waves.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetCount ()
+//-----------------------------------------------------------------------------
+int CWaveSpawner::GetCount( const Wave& wave, int iTime ) const
+{
+	int nCount = wave.nCount + iTime * wave.nMore;
+	return nCount > 0 ? nCount : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Place ()
+// Desc : Formations open at the wave's point and trail upwards, the way
+//		they come down onto the screen.
+//-----------------------------------------------------------------------------
+void CWaveSpawner::Place( const Wave& wave, int nCount, std::vector<float>& x, std::vector<float>& y ) const
+{
+	const WaveFormation& formation = m_Formations[wave.iFormation];
+	float fSpacing = formation.fSpacing;
+
+	for (int i = 0; i < nCount; i++)
+	{
+		float fX = wave.x, fY = wave.y;
+
+		switch (formation.Shape)
+		{
+		case FORMATION_LINE:
+			fX += (i - (nCount - 1) * 0.5f) * fSpacing;
+			break;
+
+		case FORMATION_COLUMN:
+			fY -= i * fSpacing;
+			break;
+
+		case FORMATION_GRID:
+		{
+			int iColumns = formation.iColumns < nCount ? formation.iColumns : nCount;
+			fX += (i % iColumns - (iColumns - 1) * 0.5f) * fSpacing;
+			fY -= (i / iColumns) * fSpacing;
+			break;
+		}
+
+		case FORMATION_VEE:
+		{
+			int iRank = (i + 1) / 2;
+			fX += ((i & 1) ? -iRank : iRank) * fSpacing;
+			fY -= iRank * fSpacing;
+			break;
+		}
+
+		case FORMATION_RING:
+		{
+			// Round enough that neighbours are spacing apart
+			float fRadius = nCount > 1 ? nCount * fSpacing / (2 * (float)PI) : 0;
+			float fAngle = 2 * (float)PI * i / nCount;
+			fX += fRadius * sinf(fAngle);
+			fY -= fRadius * cosf(fAngle);
+			break;
+		}
+		}
+
+		x.push_back(fX);
+		y.push_back(fY);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadFile () (Static)
+//-----------------------------------------------------------------------------
+bool CWaveSpawner::ReadFile( const char *szFileName, std::string& text )
+{
+	std::ifstream file(szFileName);
+	if (!file)
+		return false;
+
+	std::ostringstream out;
+	out << file.rdbuf();
+	text = out.str();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPreset () (Static)
+//-----------------------------------------------------------------------------
+const char* CWaveSpawner::GetPreset( const char *szName )
+{
+	for (int i = 0; i < PRESET_COUNT; i++)
+	{
+		if (strcmp(PRESETS[i].szName, szName) == 0)
+			return PRESETS[i].szText;
+	}
+
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPresetName () (Static)
+//-----------------------------------------------------------------------------
+const char* CWaveSpawner::GetPresetName( int iIndex )
+{
+	return iIndex >= 0 && iIndex < PRESET_COUNT ? PRESETS[iIndex].szName : NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindArchetype () (Private)
+//-----------------------------------------------------------------------------
+int CWaveSpawner::FindArchetype( const std::string& name ) const
+{
+	for (size_t i = 0; i < m_Archetypes.size(); i++)
+	{
+		if (m_Archetypes[i].Name == name)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindFormation () (Private)
+//-----------------------------------------------------------------------------
+int CWaveSpawner::FindFormation( const std::string& name ) const
+{
+	for (size_t i = 0; i < m_Formations.size(); i++)
+	{
+		if (m_Formations[i].Name == name)
+			return (int)i;
+	}
+
+	return -1;
+}
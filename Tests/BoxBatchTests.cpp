@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------------
+// File: BoxBatchTests.cpp
+//
+// Desc: Checks every BoxBatch path the CPU has against the plain overlap
+//	   rule and against each other, bit for bit: every count up to two
+//	   mask words (so every tail length after zero, one and two whole
+//	   words), boxes that only touch, boxes with no area or inside out,
+//	   and NaN and infinite edges.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BoxBatchTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "BoxBatch.h"
+#include "Random.h"
+#include <limits>
+#include <string.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const BoxBatchPath	PATHS[]		= { BOXBATCH_SCALAR, BOXBATCH_SSE2, BOXBATCH_AVX2 };
+	const int			PATH_COUNT	= sizeof(PATHS) / sizeof(PATHS[0]);
+	const size_t		MAX_COUNT	= 64;
+	const size_t		EXTRA_COUNTS[] = { 95, 96, 97, 1000 };
+	const int			TRIALS		= 200;			// Random sets per count
+	const uint32_t		GUARD		= 0xDEADBEEF;	// Past the last mask word
+
+	const float			QNAN		= std::numeric_limits<float>::quiet_NaN();
+	const float			INF			= std::numeric_limits<float>::infinity();
+
+	//-------------------------------------------------------------------------
+	// Boxes on a coarse grid, so edges often touch exactly, with some that
+	// have no area, are inside out, or have a NaN or infinite edge.
+	//-------------------------------------------------------------------------
+	float RandomEdge( CRandom& random )
+	{
+		switch (random.Below(40))
+		{
+		case 0:		return QNAN;
+		case 1:		return INF;
+		case 2:		return -INF;
+		case 3:		return -0.0f;
+		default:	return (float)random.Below(9);
+		}
+	}
+
+	BoxF RandomBox( CRandom& random )
+	{
+		BoxF box;
+		box.fMinX = RandomEdge(random);
+		box.fMinY = RandomEdge(random);
+		box.fMaxX = RandomEdge(random);
+		box.fMaxY = RandomEdge(random);
+
+		switch (random.Below(4))
+		{
+		case 0:		box.fMaxX = box.fMinX; break;					// No width
+		case 1:		box.fMaxX = box.fMinX + 1; box.fMaxY = box.fMinY + 1; break;
+		default:	break;
+		}
+		return box;
+	}
+
+	struct BoxArrays
+	{
+		std::vector<float>	MinX, MinY, MaxX, MaxY;
+	};
+
+	void RandomBoxes( CRandom& random, size_t n, BoxArrays& boxes )
+	{
+		boxes.MinX.resize(n + 1);	boxes.MinY.resize(n + 1);
+		boxes.MaxX.resize(n + 1);	boxes.MaxY.resize(n + 1);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			BoxF box = RandomBox(random);
+			boxes.MinX[i] = box.fMinX;	boxes.MinY[i] = box.fMinY;
+			boxes.MaxX[i] = box.fMaxX;	boxes.MaxY[i] = box.fMaxY;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// The rule every path has to follow, one box at a time
+	//-------------------------------------------------------------------------
+	bool Overlaps( const BoxF& box, float fMinX, float fMinY, float fMaxX, float fMaxY )
+	{
+		return fMinX < box.fMaxX && fMaxX > box.fMinX && fMinY < box.fMaxY && fMaxY > box.fMinY;
+	}
+
+	bool MaskBit( const std::vector<uint32_t>& mask, size_t i )
+	{
+		return ((mask[i >> 5] >> (i & 31)) & 1) != 0;
+	}
+
+	//-------------------------------------------------------------------------
+	// Runs f(mask) on a mask of garbage with a guard word past its end and
+	// checks the result against the reference bit for bit.
+	//-------------------------------------------------------------------------
+	template <typename FUNC>
+	void CheckMask( const char *szWhat, BoxBatchPath path, size_t n, const std::vector<bool>& expected,
+					std::vector<uint32_t>& mask, FUNC f )
+	{
+		size_t nWords = BOXBATCH_MASK_WORDS(n);
+		mask.assign(nWords + 1, 0xA5A5A5A5);
+		mask[nWords] = GUARD;
+
+		size_t nHits = f(&mask[0]);
+
+		size_t nExpected = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			nExpected += expected[i];
+			if (!TEST_CHECK(MaskBit(mask, i) == expected[i], "%s %s n %lu box %lu", szWhat, BoxBatchPathName(path), (unsigned long)n, (unsigned long)i))
+				return;
+		}
+
+		TEST_CHECK(nHits == nExpected, "%s %s n %lu: %lu hits, expected %lu", szWhat, BoxBatchPathName(path),
+				   (unsigned long)n, (unsigned long)nHits, (unsigned long)nExpected);
+		for (size_t i = n; i < nWords * 32; i++)
+			TEST_CHECK(!MaskBit(mask, i), "%s %s n %lu: bit %lu past the end set", szWhat, BoxBatchPathName(path), (unsigned long)n, (unsigned long)i);
+		TEST_CHECK(mask[nWords] == GUARD, "%s %s n %lu: wrote past the mask", szWhat, BoxBatchPathName(path), (unsigned long)n);
+	}
+
+	//-------------------------------------------------------------------------
+	// One set of boxes and one query on every path
+	//-------------------------------------------------------------------------
+	void CheckSet( CRandom& random, size_t n, const BoxBatchPath *pPaths, int nPaths )
+	{
+		BoxArrays boxes;
+		RandomBoxes(random, n, boxes);
+		BoxF query = RandomBox(random);
+
+		std::vector<bool> expected(n), expectedCentred(n);
+		for (size_t i = 0; i < n; i++)
+			expected[i] = Overlaps(query, boxes.MinX[i], boxes.MinY[i], boxes.MaxX[i], boxes.MaxY[i]);
+
+		// Centred boxes share one size, sometimes none or NaN
+		float fWidth	= random.Below(10) == 0 ? (random.Below(2) ? 0.0f : QNAN) : (float)random.Below(4);
+		float fHeight	= (float)random.Below(4);
+		BoxF grown = { query.fMinX - fWidth / 2, query.fMinY - fHeight / 2, query.fMaxX + fWidth / 2, query.fMaxY + fHeight / 2 };
+		for (size_t i = 0; i < n; i++)
+			expectedCentred[i] = Overlaps(grown, boxes.MinX[i], boxes.MinY[i], boxes.MinX[i], boxes.MinY[i]);
+
+		std::vector<uint32_t> mask, firstMask, firstCentred;
+		for (int p = 0; p < nPaths; p++)
+		{
+			BoxBatchSetPath(pPaths[p]);
+
+			CheckMask("overlap", pPaths[p], n, expected, mask, [&](uint32_t *pMask)
+			{
+				return BoxBatchOverlap(query, &boxes.MinX[0], &boxes.MinY[0], &boxes.MaxX[0], &boxes.MaxY[0], n, pMask);
+			});
+			if (p == 0)
+				firstMask = mask;
+			else
+				TEST_CHECK(mask == firstMask, "overlap %s n %lu differs from %s", BoxBatchPathName(pPaths[p]), (unsigned long)n, BoxBatchPathName(pPaths[0]));
+
+			// Compact the overlap mask while it is here
+			std::vector<unsigned int> indices(n + 1, 0xFFFFFFFF);
+			size_t nIndices = BoxBatchCompact(&mask[0], n, &indices[0]);
+			size_t j = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				if (expected[i] && TEST_CHECK(j < nIndices && indices[j] == i, "compact n %lu index %lu", (unsigned long)n, (unsigned long)i))
+					j++;
+			}
+			TEST_CHECK(j == nIndices && indices[nIndices] == 0xFFFFFFFF, "compact n %lu wrote %lu indices", (unsigned long)n, (unsigned long)nIndices);
+
+			CheckMask("centred", pPaths[p], n, expectedCentred, mask, [&](uint32_t *pMask)
+			{
+				return BoxBatchOverlapCentred(query, &boxes.MinX[0], &boxes.MinY[0], fWidth, fHeight, n, pMask);
+			});
+			if (p == 0)
+				firstCentred = mask;
+			else
+				TEST_CHECK(mask == firstCentred, "centred %s n %lu differs from %s", BoxBatchPathName(pPaths[p]), (unsigned long)n, BoxBatchPathName(pPaths[0]));
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	// Only the paths this CPU can run; the others fall back and say so
+	BoxBatchPath	paths[PATH_COUNT];
+	int				nPaths = 0;
+	for (int p = 0; p < PATH_COUNT; p++)
+	{
+		if (BoxBatchSetPath(PATHS[p]) == PATHS[p])
+			paths[nPaths++] = PATHS[p];
+		else
+			printf("%s not supported, skipped\n", BoxBatchPathName(PATHS[p]));
+	}
+
+	CRandom random(36);
+	for (size_t n = 0; n <= MAX_COUNT; n++)
+	{
+		for (int t = 0; t < TRIALS; t++)
+			CheckSet(random, n, paths, nPaths);
+	}
+	for (size_t i = 0; i < sizeof(EXTRA_COUNTS) / sizeof(EXTRA_COUNTS[0]); i++)
+		CheckSet(random, EXTRA_COUNTS[i], paths, nPaths);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,285 @@
+//-----------------------------------------------------------------------------
+// File: BulletPoolTests.cpp
+//
+// Desc: Checks CBulletPool's Cull() and Despawn() against a plain vector of
+//	   bullets, on every BoxBatch path the CPU has: the live bullets in the
+//	   same dense order after the last one moved into each hole, counts
+//	   either side of each 32 bit mask word edge, bullets just inside and
+//	   just touching the bounds, a full pool, and handles that have to
+//	   stay stale once their slot is spawned into again.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BulletPoolTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "BulletPool.h"
+#include "BoxBatch.h"
+#include "Random.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const BoxBatchPath	PATHS[]			= { BOXBATCH_SCALAR, BOXBATCH_SSE2, BOXBATCH_AVX2 };
+	const int			PATH_COUNT		= sizeof(PATHS) / sizeof(PATHS[0]);
+	const size_t		CAPACITIES[]	= { 1, 2, 31, 32, 33, 63, 64, 65, 96, 97, 200 };
+	const int			CAPACITY_COUNT	= sizeof(CAPACITIES) / sizeof(CAPACITIES[0]);
+	const int			ROUNDS			= 400;			// Random steps per pool
+	const float			BOUNDS			= 100;			// Square, from 0
+	const float			BULLET_SIZE		= 4;
+
+	// Bullets along one axis, against a bullet box of BULLET_SIZE: in, just
+	// in past either edge, and touching or past them, which is out
+	const float			INSIDE[]		= { 0, 37, 50, 100, -1.5f, 101.5f };
+	const float			OUTSIDE[]		= { -2, 102, -50, 1000 };
+
+	//-------------------------------------------------------------------------
+	// The reference: live bullets in dense order, and every handle that has
+	// gone stale
+	//-------------------------------------------------------------------------
+	struct Bullet
+	{
+		EntityHandle	Handle;
+		float			x, y, vx, vy, ax, ay;
+		int				iOwner;
+	};
+
+	struct Model
+	{
+		CBulletPool					Pool;
+		std::vector<Bullet>			Live;
+		std::vector<EntityHandle>	Stale;
+		CRandom						Random;
+	};
+
+	bool IsOutside( const Bullet& bullet )
+	{
+		float fHalf = BULLET_SIZE / 2;
+		return !(bullet.x > -fHalf && bullet.x < BOUNDS + fHalf && bullet.y > -fHalf && bullet.y < BOUNDS + fHalf);
+	}
+
+	float Pick( CRandom& random, const float *pValues, size_t nValues )
+	{
+		return pValues[random.Below((uint32_t)nValues)];
+	}
+
+	//-------------------------------------------------------------------------
+	// Spawns a bullet, out on one axis or both if asked; a full pool has to
+	// turn it down
+	//-------------------------------------------------------------------------
+	void Spawn( Model& model, bool bOutside )
+	{
+		CRandom& random = model.Random;
+
+		Bullet bullet;
+		bullet.x	= Pick(random, INSIDE, sizeof(INSIDE) / sizeof(INSIDE[0]));
+		bullet.y	= Pick(random, INSIDE, sizeof(INSIDE) / sizeof(INSIDE[0]));
+		if (bOutside)
+		{
+			switch (random.Below(3))
+			{
+			case 0:		bullet.x = Pick(random, OUTSIDE, sizeof(OUTSIDE) / sizeof(OUTSIDE[0])); break;
+			case 1:		bullet.y = Pick(random, OUTSIDE, sizeof(OUTSIDE) / sizeof(OUTSIDE[0])); break;
+			default:	bullet.x = Pick(random, OUTSIDE, sizeof(OUTSIDE) / sizeof(OUTSIDE[0]));
+						bullet.y = Pick(random, OUTSIDE, sizeof(OUTSIDE) / sizeof(OUTSIDE[0])); break;
+			}
+		}
+		bullet.vx		= (float)random.Below(100);
+		bullet.vy		= -(float)random.Below(100);
+		bullet.ax		= (float)random.Below(10);
+		bullet.ay		= (float)random.Below(10);
+		bullet.iOwner	= (int)random.Below(3) - 1;
+		bullet.Handle	= model.Pool.Spawn(bullet.x, bullet.y, bullet.vx, bullet.vy, bullet.iOwner, bullet.ax, bullet.ay);
+
+		if (model.Live.size() == model.Pool.Capacity())
+		{
+			TEST_CHECK(bullet.Handle == INVALID_ENTITY, "spawn into a full pool of %lu", (unsigned long)model.Live.size());
+			return;
+		}
+
+		TEST_CHECK(bullet.Handle != INVALID_ENTITY, "spawn with %lu of %lu live", (unsigned long)model.Live.size(),
+				   (unsigned long)model.Pool.Capacity());
+		model.Live.push_back(bullet);
+	}
+
+	// The last live bullet moves into the hole
+	void DespawnAt( Model& model, size_t iIndex )
+	{
+		model.Stale.push_back(model.Live[iIndex].Handle);
+		model.Live[iIndex] = model.Live.back();
+		model.Live.pop_back();
+	}
+
+	//-------------------------------------------------------------------------
+	// Cull() gives the same bullets, in the same order, as despawning each
+	// one out of bounds from the back
+	//-------------------------------------------------------------------------
+	void Cull( Model& model )
+	{
+		size_t nExpected = 0;
+		for (size_t i = model.Live.size(); i-- > 0; )
+		{
+			if (IsOutside(model.Live[i]))
+			{
+				DespawnAt(model, i);
+				nExpected++;
+			}
+		}
+
+		size_t nCulled = model.Pool.Cull(BULLET_SIZE, BULLET_SIZE);
+		TEST_CHECK(nCulled == nExpected, "culled %lu, expected %lu", (unsigned long)nCulled, (unsigned long)nExpected);
+	}
+
+	//-------------------------------------------------------------------------
+	// Every live bullet where the reference has it, and every stale handle
+	// dead, even now its slot holds another bullet
+	//-------------------------------------------------------------------------
+	void CheckPool( Model& model, const char *szAfter )
+	{
+		const CBulletPool& pool = model.Pool;
+
+		if (!TEST_CHECK(pool.Count() == model.Live.size(), "after %s: %lu live, expected %lu", szAfter,
+						(unsigned long)pool.Count(), (unsigned long)model.Live.size()))
+			return;
+
+		for (size_t i = 0; i < model.Live.size(); i++)
+		{
+			const Bullet& bullet = model.Live[i];
+			bool bSame = pool.X()[i] == bullet.x && pool.Y()[i] == bullet.y && pool.PrevX()[i] == bullet.x &&
+						 pool.PrevY()[i] == bullet.y && pool.VelX()[i] == bullet.vx && pool.VelY()[i] == bullet.vy &&
+						 pool.AccX()[i] == bullet.ax && pool.AccY()[i] == bullet.ay && pool.Owner()[i] == bullet.iOwner;
+
+			if (!TEST_CHECK(bSame, "after %s: bullet %lu of %lu differs", szAfter, (unsigned long)i, (unsigned long)model.Live.size()) ||
+				!TEST_CHECK(pool.IndexOf(bullet.Handle) == (int)i && pool.IsAlive(bullet.Handle), "after %s: handle %u/%u at %d, expected %lu",
+							szAfter, bullet.Handle.uSlot, bullet.Handle.uGeneration, pool.IndexOf(bullet.Handle), (unsigned long)i))
+				return;
+		}
+
+		for (size_t i = 0; i < model.Stale.size(); i++)
+		{
+			EntityHandle handle = model.Stale[i];
+			if (!TEST_CHECK(!model.Pool.IsAlive(handle) && model.Pool.IndexOf(handle) == -1 && !model.Pool.Despawn(handle),
+							"after %s: stale handle %u/%u live", szAfter, handle.uSlot, handle.uGeneration))
+				return;
+		}
+		TEST_CHECK(pool.Count() == model.Live.size(), "after %s: a stale handle despawned a bullet", szAfter);
+
+		// Plenty of stale handles are kept, but not all
+		if (model.Stale.size() > 1000)
+			model.Stale.erase(model.Stale.begin(), model.Stale.begin() + 500);
+	}
+
+	//-------------------------------------------------------------------------
+	// Refills the pool with n bullets, those from iFirstOut to iLastOut out
+	// of bounds, and culls them
+	//-------------------------------------------------------------------------
+	void CullRange( Model& model, size_t n, size_t iFirstOut, size_t iLastOut )
+	{
+		model.Pool.Clear();
+		for (size_t i = 0; i < model.Live.size(); i++)
+			model.Stale.push_back(model.Live[i].Handle);
+		model.Live.clear();
+
+		for (size_t i = 0; i < n; i++)
+			Spawn(model, i >= iFirstOut && i <= iLastOut);
+
+		Cull(model);
+		CheckPool(model, "cull at a word edge");
+	}
+
+	void CheckCullEdges( Model& model, size_t n )
+	{
+		static const size_t EDGES[] = { 0, 1, 30, 31, 32, 33, 62, 63, 64, 65, 95, 96 };
+
+		// One out, at each index near a word edge
+		for (size_t e = 0; e < sizeof(EDGES) / sizeof(EDGES[0]) && EDGES[e] < n; e++)
+			CullRange(model, n, EDGES[e], EDGES[e]);
+
+		CullRange(model, n, n / 2, n - 1);		// The back half
+		CullRange(model, n, 0, n - 1);			// All
+		if (n > 1)
+			CullRange(model, n, 0, n - 2);		// All but the last
+	}
+
+	//-------------------------------------------------------------------------
+	// Random spawns, despawns by handle, by index and by culling
+	//-------------------------------------------------------------------------
+	void CheckRandom( Model& model )
+	{
+		CRandom& random = model.Random;
+
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			// How many are spawned out of bounds changes from round to round
+			static const uint32_t OUTSIDE_CHANCE[] = { 0, 1, 8, 16, 32 };	// Out of 32
+			uint32_t uChance = OUTSIDE_CHANCE[random.Below(sizeof(OUTSIDE_CHANCE) / sizeof(OUTSIDE_CHANCE[0]))];
+
+			for (uint32_t i = random.Below((uint32_t)model.Pool.Capacity() + 2); i > 0; i--)
+				Spawn(model, random.Below(32) < uChance);
+			CheckPool(model, "spawn");
+
+			for (uint32_t i = random.Below(4); i > 0 && !model.Live.empty(); i--)
+			{
+				size_t iIndex = random.Below((uint32_t)model.Live.size());
+				TEST_CHECK(model.Pool.Despawn(model.Live[iIndex].Handle), "despawn bullet %lu", (unsigned long)iIndex);
+				DespawnAt(model, iIndex);
+			}
+			CheckPool(model, "despawn");
+
+			if (random.Below(4) == 0 && !model.Live.empty())
+			{
+				size_t iIndex = random.Below((uint32_t)model.Live.size());
+				model.Pool.DespawnAt(iIndex);
+				DespawnAt(model, iIndex);
+				CheckPool(model, "despawn at");
+			}
+
+			Cull(model);
+			CheckPool(model, "cull");
+		}
+
+		model.Pool.Clear();
+		for (size_t i = 0; i < model.Live.size(); i++)
+			model.Stale.push_back(model.Live[i].Handle);
+		model.Live.clear();
+		CheckPool(model, "clear");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	// Culling an empty pool, and a pool with no room
+	CBulletPool empty;
+	TEST_CHECK(empty.Cull(BULLET_SIZE, BULLET_SIZE) == 0 && empty.Spawn(0, 0, 0, 0, 0) == INVALID_ENTITY, "pool never created");
+
+	for (int p = 0; p < PATH_COUNT; p++)
+	{
+		// Only the paths this CPU can run
+		if (BoxBatchSetPath(PATHS[p]) != PATHS[p])
+		{
+			printf("%s not supported, skipped\n", BoxBatchPathName(PATHS[p]));
+			continue;
+		}
+
+		for (int c = 0; c < CAPACITY_COUNT; c++)
+		{
+			Model model;
+			model.Random.Seed(34, (uint64_t)(p * CAPACITY_COUNT + c));
+			model.Pool.Create(CAPACITIES[c]);
+			model.Pool.SetBounds(0, 0, BOUNDS, BOUNDS);
+
+			for (size_t n = 1; n <= CAPACITIES[c]; n += n < 70 ? 1 : 31)
+				CheckCullEdges(model, n);
+			CheckRandom(model);
+		}
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMaskTests.cpp
+//
+// Desc: Checks CCollisionMask against the pixels it was built from: the
+//	   packed bits, and Overlap() against a pixel by pixel search, for
+//	   widths either side of each 64 bit word edge and offsets that put
+//	   the masks apart, touching and over each other.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CollisionMaskTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "CollisionMask.h"
+#include "Random.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int			WIDTHS[]	= { 1, 2, 31, 63, 64, 65, 100, 127, 128, 129, 191, 192, 193, 300 };
+	const int			WIDTH_COUNT	= sizeof(WIDTHS) / sizeof(WIDTHS[0]);
+	const int			TRIALS		= 40;			// Random pairs per pair of widths
+	const uint32_t		SOLID		= 0xFF000000;	// Alpha, as the sprites use
+
+	//-------------------------------------------------------------------------
+	// A mask's source pixels. Mostly sparse, so that overlaps depend on the
+	// exact pixels rather than almost always being found.
+	//-------------------------------------------------------------------------
+	struct Pixels
+	{
+		int						iWidth, iHeight;
+		std::vector<uint32_t>	Data;
+
+		bool IsSolid( int x, int y ) const
+		{
+			if (x < 0 || y < 0 || x >= iWidth || y >= iHeight)
+				return false;
+			return (Data[(size_t)y * iWidth + x] & SOLID) != 0;
+		}
+	};
+
+	void RandomPixels( CRandom& random, int iWidth, int iHeight, Pixels& pixels )
+	{
+		static const uint32_t DENSITY[] = { 0, 1, 4, 32, 128, 256 };	// Out of 256
+		uint32_t uDensity = DENSITY[random.Below(sizeof(DENSITY) / sizeof(DENSITY[0]))];
+
+		pixels.iWidth	= iWidth;
+		pixels.iHeight	= iHeight;
+		pixels.Data.resize((size_t)iWidth * iHeight);
+		for (size_t i = 0; i < pixels.Data.size(); i++)
+		{
+			// Colour bits alone are not solid
+			uint32_t uColour = random.NextU32() & 0x00FFFFFF;
+			pixels.Data[i] = random.Below(256) < uDensity ? uColour | (random.Below(255) + 1) << 24 : uColour;
+		}
+
+		// Sometimes a lone pixel on an edge or a word boundary
+		if (uDensity == 0 && random.Below(2))
+		{
+			static const int EDGES[] = { 0, 63, 64, 127, 128 };
+			int x = random.Below(3) ? EDGES[random.Below(5)] : iWidth - 1;
+			if (x >= iWidth)
+				x = iWidth - 1;
+			pixels.Data[(size_t)random.Below(iHeight) * iWidth + x] |= SOLID;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// The rule Overlap() has to follow, one screen pixel at a time
+	//-------------------------------------------------------------------------
+	bool Overlaps( const Pixels& a, int ax, int ay, const Pixels& b, int bx, int by )
+	{
+		for (int y = 0; y < a.iHeight; y++)
+		{
+			for (int x = 0; x < a.iWidth; x++)
+			{
+				if (a.IsSolid(x, y) && b.IsSolid(ax + x - bx, ay + y - by))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	//-------------------------------------------------------------------------
+	// Every bit of the mask is the pixel's, and nothing outside it is solid
+	//-------------------------------------------------------------------------
+	void CheckCreate( const Pixels& pixels, CCollisionMask& mask )
+	{
+		if (!TEST_CHECK(mask.Create(&pixels.Data[0], pixels.iWidth, pixels.iHeight, SOLID), "create %dx%d", pixels.iWidth, pixels.iHeight))
+			return;
+
+		size_t nSolid = 0;
+		for (int y = -1; y <= pixels.iHeight; y++)
+		{
+			for (int x = -1; x <= pixels.iWidth + 64; x++)
+			{
+				nSolid += pixels.IsSolid(x, y);
+				if (!TEST_CHECK(mask.IsSolid(x, y) == pixels.IsSolid(x, y), "%dx%d pixel %d, %d", pixels.iWidth, pixels.iHeight, x, y))
+					return;
+			}
+		}
+
+		TEST_CHECK(mask.GetSolidCount() == nSolid, "%dx%d: %lu solid, expected %lu", pixels.iWidth, pixels.iHeight,
+				   (unsigned long)mask.GetSolidCount(), (unsigned long)nSolid);
+	}
+
+	//-------------------------------------------------------------------------
+	// One pair of masks at offsets from well apart to fully over each other
+	//-------------------------------------------------------------------------
+	void CheckPair( CRandom& random, int iWidthA, int iWidthB )
+	{
+		Pixels a, b;
+		RandomPixels(random, iWidthA, 1 + random.Below(6), a);
+		RandomPixels(random, iWidthB, 1 + random.Below(6), b);
+
+		CCollisionMask maskA, maskB;
+		CheckCreate(a, maskA);
+		CheckCreate(b, maskB);
+
+		int ax = (int)random.Below(200) - 100, ay = (int)random.Below(20) - 10;
+		for (int i = 0; i < 16; i++)
+		{
+			// Near every edge of a, one past and one short of touching
+			int bx = ax - iWidthB - 1 + (int)random.Below(iWidthA + iWidthB + 3);
+			int by = ay - b.iHeight - 1 + (int)random.Below(a.iHeight + b.iHeight + 3);
+
+			bool bExpected = Overlaps(a, ax, ay, b, bx, by);
+			TEST_CHECK(CCollisionMask::Overlap(maskA, ax, ay, maskB, bx, by) == bExpected,
+					   "%dx%d at %d, %d with %dx%d at %d, %d", a.iWidth, a.iHeight, ax, ay, b.iWidth, b.iHeight, bx, by);
+			TEST_CHECK(CCollisionMask::Overlap(maskB, bx, by, maskA, ax, ay) == bExpected,
+					   "%dx%d at %d, %d with %dx%d at %d, %d, swapped", a.iWidth, a.iHeight, ax, ay, b.iWidth, b.iHeight, bx, by);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	// Nothing to build from, and empty masks never overlap
+	CCollisionMask empty, solid;
+	uint32_t uPixel = SOLID;
+	TEST_CHECK(!empty.Create(NULL, 1, 1, SOLID), "create from no pixels");
+	TEST_CHECK(!empty.Create(&uPixel, 0, 1, SOLID) && empty.IsEmpty(), "create 0 wide");
+	TEST_CHECK(solid.Create(&uPixel, 1, 1, SOLID) && solid.GetSolidCount() == 1, "create 1x1");
+	TEST_CHECK(!CCollisionMask::Overlap(empty, 0, 0, solid, 0, 0), "empty overlaps");
+	TEST_CHECK(CCollisionMask::Overlap(solid, 5, 5, solid, 5, 5), "1x1 misses itself");
+	TEST_CHECK(!CCollisionMask::Overlap(solid, 5, 5, solid, 6, 5), "1x1 overlaps its neighbour");
+
+	CRandom random(37);
+	for (int i = 0; i < WIDTH_COUNT; i++)
+	{
+		for (int j = 0; j < WIDTH_COUNT; j++)
+		{
+			for (int t = 0; t < TRIALS; t++)
+				CheckPair(random, WIDTHS[i], WIDTHS[j]);
+		}
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,324 @@
+//-----------------------------------------------------------------------------
+// File: JobSystemTests.cpp
+//
+// Desc: Checks CJobSystem against doing the same work serially, with no
+//	   workers and with several: every item of a ParallelFor() runs exactly
+//	   once in the chunks asked for, dependent jobs only start after what
+//	   they wait on, jobs may wait on jobs of their own, Release() runs
+//	   what was left behind, and deterministic mode runs in order.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// JobSystemTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int			WORKERS[]		= { 0, 1, 3, 7 };
+	const int			WORKER_COUNTS	= sizeof(WORKERS) / sizeof(WORKERS[0]);
+	const int			ROUNDS			= 20;		// Repeats, to give races a chance
+	const size_t		CHAIN_JOBS		= 64;		// Jobs per stage of a dependency chain
+	const int			CHAIN_STAGES	= 4;
+
+	//-------------------------------------------------------------------------
+	// Counts every item it is given, and the chunks it is given them in
+	//-------------------------------------------------------------------------
+	struct CountItems
+	{
+		std::vector<std::atomic<int> >*	pRuns;
+		std::atomic<int>*				pBadChunks;
+		size_t							nGrain;
+		size_t							n;
+
+		void operator()( size_t iBegin, size_t iEnd )
+		{
+			size_t iExpectedEnd = iBegin + nGrain < n ? iBegin + nGrain : n;
+			if (iBegin % nGrain != 0 || iEnd != iExpectedEnd)
+				pBadChunks->fetch_add(1);
+
+			for (size_t i = iBegin; i < iEnd; i++)
+				(*pRuns)[i].fetch_add(1);
+		}
+	};
+
+	void CheckParallelFor( CJobSystem& jobs, size_t n, size_t nGrain )
+	{
+		std::vector<std::atomic<int> > runs(n);
+		for (size_t i = 0; i < n; i++)
+			runs[i] = 0;
+		std::atomic<int> nBadChunks(0);
+
+		// ParallelFor() treats a grain of 0 as 1
+		CountItems count = { &runs, &nBadChunks, nGrain ? nGrain : 1, n };
+		jobs.ParallelFor(n, nGrain, count);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			if (!TEST_CHECK(runs[i] == 1, "%d workers, n %lu grain %lu: item %lu ran %d times",
+							jobs.GetWorkerCount(), (unsigned long)n, (unsigned long)nGrain, (unsigned long)i, (int)runs[i]))
+				break;
+		}
+		TEST_CHECK(nBadChunks == 0, "%d workers, n %lu grain %lu: %d chunks off the grain",
+				   jobs.GetWorkerCount(), (unsigned long)n, (unsigned long)nGrain, (int)nBadChunks);
+	}
+
+	//-------------------------------------------------------------------------
+	// A sum worked out in chunks, each chunk keeping its own partial sum,
+	// is the serial sum
+	//-------------------------------------------------------------------------
+	struct SumSquares
+	{
+		std::vector<unsigned long long>*	pPartials;
+		size_t								nGrain;
+
+		void operator()( size_t iBegin, size_t iEnd )
+		{
+			unsigned long long ullSum = 0;
+			for (size_t i = iBegin; i < iEnd; i++)
+				ullSum += (unsigned long long)i * i;
+			(*pPartials)[iBegin / nGrain] = ullSum;
+		}
+	};
+
+	void CheckSum( CJobSystem& jobs, size_t n, size_t nGrain )
+	{
+		unsigned long long ullSerial = 0;
+		for (size_t i = 0; i < n; i++)
+			ullSerial += (unsigned long long)i * i;
+
+		std::vector<unsigned long long> partials((n + nGrain - 1) / nGrain, 0);
+		SumSquares sum = { &partials, nGrain };
+		jobs.ParallelFor(n, nGrain, sum);
+
+		unsigned long long ullParallel = 0;
+		for (size_t i = 0; i < partials.size(); i++)
+			ullParallel += partials[i];
+
+		TEST_CHECK(ullParallel == ullSerial, "%d workers, n %lu grain %lu: sum %llu, expected %llu",
+				   jobs.GetWorkerCount(), (unsigned long)n, (unsigned long)nGrain, ullParallel, ullSerial);
+	}
+
+	//-------------------------------------------------------------------------
+	// Stages of jobs, each stage depending on the one before. A job checks
+	// that the whole previous stage finished before it started.
+	//-------------------------------------------------------------------------
+	struct Chain
+	{
+		std::atomic<int>	Done[CHAIN_STAGES][CHAIN_JOBS];
+		std::atomic<int>	nEarly;
+	};
+
+	struct ChainJob
+	{
+		Chain*	pChain;
+		int		iStage;
+	};
+
+	void RunChainJob( void *pData, size_t iBegin, size_t iEnd )
+	{
+		ChainJob& job = *(ChainJob*)pData;
+		Chain& chain = *job.pChain;
+
+		if (job.iStage > 0)
+		{
+			for (size_t i = 0; i < CHAIN_JOBS; i++)
+			{
+				if (!chain.Done[job.iStage - 1][i])
+					chain.nEarly.fetch_add(1);
+			}
+		}
+
+		for (size_t i = iBegin; i < iEnd; i++)
+			chain.Done[job.iStage][i].fetch_add(1);
+	}
+
+	void CheckChain( CJobSystem& jobs )
+	{
+		Chain chain;
+		for (int s = 0; s < CHAIN_STAGES; s++)
+		{
+			for (size_t i = 0; i < CHAIN_JOBS; i++)
+				chain.Done[s][i] = 0;
+		}
+		chain.nEarly = 0;
+
+		ChainJob stages[CHAIN_STAGES];
+		CJobCounter counters[CHAIN_STAGES];
+		for (int s = 0; s < CHAIN_STAGES; s++)
+		{
+			stages[s].pChain = &chain;
+			stages[s].iStage = s;
+			for (size_t i = 0; i < CHAIN_JOBS; i++)
+				jobs.Run(RunChainJob, &stages[s], i, i + 1, &counters[s], s > 0 ? &counters[s - 1] : NULL);
+		}
+
+		jobs.Wait(counters[CHAIN_STAGES - 1]);
+		for (int s = 0; s < CHAIN_STAGES; s++)
+			TEST_CHECK(counters[s].IsDone(), "%d workers: stage %d not done", jobs.GetWorkerCount(), s);
+
+		int nMissed = 0;
+		for (int s = 0; s < CHAIN_STAGES; s++)
+		{
+			for (size_t i = 0; i < CHAIN_JOBS; i++)
+				nMissed += chain.Done[s][i] != 1;
+		}
+		TEST_CHECK(nMissed == 0, "%d workers: %d chain jobs did not run once", jobs.GetWorkerCount(), nMissed);
+		TEST_CHECK(chain.nEarly == 0, "%d workers: %d jobs ran before their dependency", jobs.GetWorkerCount(), (int)chain.nEarly);
+	}
+
+	//-------------------------------------------------------------------------
+	// Jobs that split their own work and wait on it
+	//-------------------------------------------------------------------------
+	struct Nested
+	{
+		CJobSystem*						pJobs;
+		std::vector<std::atomic<int> >*	pRuns;
+		size_t							nInner;
+
+		void operator()( size_t iBegin, size_t iEnd )
+		{
+			for (size_t i = iBegin; i < iEnd; i++)
+			{
+				std::atomic<int>* pRow = &(*pRuns)[i * nInner];
+				auto inner = [pRow]( size_t iInnerBegin, size_t iInnerEnd )
+				{
+					for (size_t j = iInnerBegin; j < iInnerEnd; j++)
+						pRow[j].fetch_add(1);
+				};
+				pJobs->ParallelFor(nInner, 7, inner);
+			}
+		}
+	};
+
+	void CheckNested( CJobSystem& jobs )
+	{
+		const size_t nOuter = 32, nInner = 100;
+		std::vector<std::atomic<int> > runs(nOuter * nInner);
+		for (size_t i = 0; i < runs.size(); i++)
+			runs[i] = 0;
+
+		Nested nested = { &jobs, &runs, nInner };
+		jobs.ParallelFor(nOuter, 1, nested);
+
+		int nMissed = 0;
+		for (size_t i = 0; i < runs.size(); i++)
+			nMissed += runs[i] != 1;
+		TEST_CHECK(nMissed == 0, "%d workers: %d nested items did not run once", jobs.GetWorkerCount(), nMissed);
+	}
+
+	//-------------------------------------------------------------------------
+	// Jobs never waited on still run, by the time Release() returns
+	//-------------------------------------------------------------------------
+	void CountJob( void *pData, size_t iBegin, size_t iEnd )
+	{
+		((std::atomic<int>*)pData)->fetch_add((int)(iEnd - iBegin));
+	}
+
+	void CheckRelease( int iWorkers )
+	{
+		CJobSystem jobs;
+		jobs.Create(iWorkers);
+
+		std::atomic<int> nItems(0);
+		for (size_t i = 0; i < 1000; i++)
+			jobs.Run(CountJob, &nItems, 0, 3, NULL);
+		jobs.Release();
+
+		TEST_CHECK(nItems == 3000, "%d workers: %d of 3000 items ran before Release() returned", iWorkers, (int)nItems);
+		TEST_CHECK(jobs.GetWorkerCount() == 0, "%d workers left after Release()", jobs.GetWorkerCount());
+	}
+
+	//-------------------------------------------------------------------------
+	// Deterministic mode runs every job at once, in order, on this thread
+	//-------------------------------------------------------------------------
+	struct Ordered
+	{
+		std::vector<size_t>	Begins;
+		std::thread::id		Thread;
+		int					nOtherThread;
+
+		void operator()( size_t iBegin, size_t )
+		{
+			Begins.push_back(iBegin);
+			if (std::this_thread::get_id() != Thread)
+				nOtherThread++;
+		}
+	};
+
+	void CheckDeterministic( CJobSystem& jobs )
+	{
+		jobs.SetDeterministic(true);
+
+		Ordered ordered;
+		ordered.Thread = std::this_thread::get_id();
+		ordered.nOtherThread = 0;
+		jobs.ParallelFor(1000, 9, ordered);
+
+		bool bInOrder = ordered.Begins.size() == (1000 + 8) / 9;
+		for (size_t i = 0; bInOrder && i < ordered.Begins.size(); i++)
+			bInOrder = ordered.Begins[i] == i * 9;
+		TEST_CHECK(bInOrder, "%d workers: deterministic chunks out of order", jobs.GetWorkerCount());
+		TEST_CHECK(ordered.nOtherThread == 0, "%d workers: %d deterministic chunks ran on another thread",
+				   jobs.GetWorkerCount(), ordered.nOtherThread);
+
+		// The chain's jobs run as they are handed in, or as what they wait on ends
+		CheckChain(jobs);
+
+		jobs.SetDeterministic(false);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	static const size_t COUNTS[] = { 0, 1, 2, 63, 64, 65, 1000, 100003 };
+	static const size_t GRAINS[] = { 0, 1, 3, 64, 4096 };
+
+	for (int w = 0; w < WORKER_COUNTS; w++)
+	{
+		CJobSystem jobs;
+		TEST_CHECK(jobs.Create(WORKERS[w]) && jobs.GetWorkerCount() == WORKERS[w], "create %d workers", WORKERS[w]);
+
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++)
+			{
+				for (size_t g = 0; g < sizeof(GRAINS) / sizeof(GRAINS[0]); g++)
+				{
+					if (GRAINS[g] < 2 && COUNTS[c] > 1000)
+						continue;
+
+					CheckParallelFor(jobs, COUNTS[c], GRAINS[g]);
+					if (GRAINS[g])
+						CheckSum(jobs, COUNTS[c], GRAINS[g]);
+				}
+			}
+
+			CheckChain(jobs);
+			CheckNested(jobs);
+		}
+
+		CheckDeterministic(jobs);
+
+		// An empty counter is already done
+		CJobCounter none;
+		jobs.Wait(none);
+
+		// Without workers jobs only run when waited on, there is nothing to release
+		if (WORKERS[w] > 0)
+			CheckRelease(WORKERS[w]);
+	}
+
+	return TEST_RESULT();
+}
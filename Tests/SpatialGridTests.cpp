@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGridTests.cpp
+//
+// Desc: Checks CSpatialGrid::Query() against testing every inserted box:
+//	   the same ids, each reported once. Boxes span up to several cells
+//	   and their edges mostly fall on cell edges, so the rule that reports
+//	   a box only from the cell holding the top-left corner of the overlap
+//	   is tried on both sides of every edge. Some boxes are far apart or
+//	   at negative cells, so different cells share a bucket, and the grid
+//	   is cleared and rebuilt with more and fewer boxes in between.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SpatialGridTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "SpatialGrid.h"
+#include "Random.h"
+#include <algorithm>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const float			CELL_SIZES[]	= { 1.0f, 7.5f, 32.0f, 128.0f };
+	const int			CELL_SIZE_COUNT	= sizeof(CELL_SIZES) / sizeof(CELL_SIZES[0]);
+	const size_t		BOX_COUNTS[]	= { 0, 1, 2, 5, 40, 300, 17, 1000, 3 };	// Rebuilt in this order
+	const int			BOX_COUNT_COUNT	= sizeof(BOX_COUNTS) / sizeof(BOX_COUNTS[0]);
+	const int			QUERIES			= 200;		// Random queries per build
+
+	struct Box
+	{
+		float	fMinX, fMinY, fMaxX, fMaxY;
+	};
+
+	//-------------------------------------------------------------------------
+	// Edges on quarters of a cell, so a quarter of them sit on a cell edge
+	// (give or take the rounding of the grid's inverse cell size). Mostly
+	// near the origin, some far off on either side; sizes from none to a
+	// few cells.
+	//-------------------------------------------------------------------------
+	float RandomEdge( CRandom& random, float fCellSize )
+	{
+		int iQuarter = (int)random.Below(64) - 32;
+		if (random.Below(8) == 0)
+			iQuarter += ((int)random.Below(2001) - 1000) * 64;
+		return iQuarter * fCellSize / 4;
+	}
+
+	float RandomSize( CRandom& random, float fCellSize )
+	{
+		switch (random.Below(8))
+		{
+		case 0:		return 0;
+		case 1:		return (float)random.Below(20) * fCellSize / 4;
+		default:	return (float)(1 + random.Below(6)) * fCellSize / 4;
+		}
+	}
+
+	Box RandomBox( CRandom& random, float fCellSize )
+	{
+		Box box;
+		box.fMinX = RandomEdge(random, fCellSize);
+		box.fMinY = RandomEdge(random, fCellSize);
+		box.fMaxX = box.fMinX + RandomSize(random, fCellSize);
+		box.fMaxY = box.fMinY + RandomSize(random, fCellSize);
+		return box;
+	}
+
+	//-------------------------------------------------------------------------
+	// The rule Query() has to follow, one box at a time. Boxes that only
+	// touch do not overlap.
+	//-------------------------------------------------------------------------
+	bool Overlaps( const Box& a, const Box& b )
+	{
+		return a.fMinX < b.fMaxX && a.fMaxX > b.fMinX && a.fMinY < b.fMaxY && a.fMaxY > b.fMinY;
+	}
+
+	void CheckQuery( const CSpatialGrid& grid, const std::vector<Box>& boxes, const Box& query, std::vector<unsigned int>& ids )
+	{
+		// Left over ids have to go
+		ids.assign(3, 0xFFFFFFFF);
+		grid.Query(query.fMinX, query.fMinY, query.fMaxX, query.fMaxY, ids);
+		std::sort(ids.begin(), ids.end());
+
+		std::vector<unsigned int> expected;
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			if (Overlaps(boxes[i], query))
+				expected.push_back((unsigned int)i);
+		}
+
+		if (ids == expected)
+			return;
+
+		// Say which box went wrong first, and how
+		size_t i = 0;
+		while (i < ids.size() && i < expected.size() && ids[i] == expected[i])
+			i++;
+
+		if (i < ids.size() && (i == expected.size() || ids[i] < expected[i]))
+		{
+			TEST_CHECK(false, "cell %g, %lu boxes: query %g, %g - %g, %g %s box %u", grid.GetCellSize(), (unsigned long)boxes.size(),
+					   query.fMinX, query.fMinY, query.fMaxX, query.fMaxY, i > 0 && ids[i] == ids[i - 1] ? "repeated" : "found stray", ids[i]);
+		}
+		else
+		{
+			const Box& box = boxes[expected[i]];
+			TEST_CHECK(false, "cell %g, %lu boxes: query %g, %g - %g, %g missed box %u at %g, %g - %g, %g", grid.GetCellSize(),
+					   (unsigned long)boxes.size(), query.fMinX, query.fMinY, query.fMaxX, query.fMaxY, expected[i],
+					   box.fMinX, box.fMinY, box.fMaxX, box.fMaxY);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// One build: every box queried with itself, which it overlaps unless it
+	// has no area, and random queries
+	//-------------------------------------------------------------------------
+	void CheckBuild( CRandom& random, CSpatialGrid& grid, float fCellSize, size_t n )
+	{
+		std::vector<Box> boxes(n);
+		grid.Clear();
+		for (size_t i = 0; i < n; i++)
+		{
+			boxes[i] = RandomBox(random, fCellSize);
+			grid.Insert((unsigned int)i, boxes[i].fMinX, boxes[i].fMinY, boxes[i].fMaxX, boxes[i].fMaxY);
+		}
+		grid.Build();
+
+		TEST_CHECK(grid.GetCount() == n, "cell %g: %lu boxes, expected %lu", fCellSize, (unsigned long)grid.GetCount(), (unsigned long)n);
+
+		std::vector<unsigned int> ids;
+		for (size_t i = 0; i < n; i++)
+			CheckQuery(grid, boxes, boxes[i], ids);
+		for (int q = 0; q < QUERIES; q++)
+			CheckQuery(grid, boxes, RandomBox(random, fCellSize), ids);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	// Nothing built yet, and cells below a unit are a unit
+	CSpatialGrid grid;
+	std::vector<unsigned int> ids(1, 7);
+	grid.Query(-100, -100, 100, 100, ids);
+	TEST_CHECK(ids.empty() && grid.GetCount() == 0, "query of an empty grid");
+
+	grid.Reset(0.25f);
+	TEST_CHECK(grid.GetCellSize() == 1.0f, "cell %g, expected 1", grid.GetCellSize());
+
+	CRandom random(35);
+	for (int c = 0; c < CELL_SIZE_COUNT; c++)
+	{
+		grid.Reset(CELL_SIZES[c]);
+		for (int r = 0; r < 3; r++)
+		{
+			for (int b = 0; b < BOX_COUNT_COUNT; b++)
+				CheckBuild(random, grid, CELL_SIZES[c], BOX_COUNTS[b]);
+		}
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------------------
+// File: TestCheck.h
+//
+// Desc: Minimal checks for the test programs. A failed check prints where
+//	   and what, and the program's exit code tells ctest how many failed.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TESTCHECK_H_
+#define _TESTCHECK_H_
+
+//-----------------------------------------------------------------------------
+// TestCheck Specific Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Failures so far; main() returns TEST_RESULT().
+inline int& TestFailures( )
+{
+	static int nFailures = 0;
+	return nFailures;
+}
+
+// Checks cond, printing the expression and the printf style message if it
+// fails. Evaluates to cond so a test can stop early.
+#define TEST_CHECK(cond, ...)												\
+	((cond) ? true : (TestFailures()++,										\
+		fprintf(stderr, "%s:%d: failed: %s: ", __FILE__, __LINE__, #cond),	\
+		fprintf(stderr, __VA_ARGS__), fputc('\n', stderr), false))
+
+#define TEST_RESULT()														\
+	(TestFailures() ? (fprintf(stderr, "%d checks failed\n", TestFailures()), 1) : (printf("passed\n"), 0))
+
+#endif // _TESTCHECK_H_
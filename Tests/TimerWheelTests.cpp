@@ -0,0 +1,251 @@
+//-----------------------------------------------------------------------------
+// File: TimerWheelTests.cpp
+//
+// Desc: Checks CTimerWheel against a plain sorted list of due ticks. Timers
+//	   are set on every level and on each side of the level edges, some are
+//	   cancelled, and callbacks set and cancel timers of their own. Every
+//	   timer has to run exactly once, on its due tick, unless it was
+//	   cancelled first. Firing a timer beyond the wheel's reach takes 2^30
+//	   ticks, so those are only checked to wait and to cancel.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TimerWheelTests Specific Includes
+//-----------------------------------------------------------------------------
+#include "TestCheck.h"
+#include "TimerWheel.h"
+#include "Random.h"
+#include <map>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const int			ROUNDS		= 3000;
+	const uint64_t		LEVEL_SPAN	= (uint64_t)1 << TIMER_WHEEL_BITS;	// Ticks per first level turn
+	const uint64_t		WHEEL_SPAN	= (uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+
+	//-------------------------------------------------------------------------
+	// The wheel and the reference it is held to. Each timer's data is its
+	// id in the reference.
+	//-------------------------------------------------------------------------
+	struct PendingTimer
+	{
+		TimerHandle		Handle;
+		uint64_t		ulDue;
+	};
+
+	struct Model
+	{
+		CTimerWheel							Wheel;
+		std::multimap<uint64_t, uint64_t>	Due;		// Due tick to id
+		std::map<uint64_t, PendingTimer>	Pending;	// Id to handle and due tick
+		std::vector<TimerHandle>			Stale;		// Timers that ran or were cancelled
+		CRandom								Random;
+		uint64_t							uNextId;
+		uint64_t							ulLastFired;
+		size_t								nFired;
+	};
+
+	void OnTimer( void *pContext, uint64_t uData );
+
+	//-------------------------------------------------------------------------
+	// Mostly short delays, and some on each side of every level's edge up to
+	// the top level. Nothing here is past the wheel's reach.
+	//-------------------------------------------------------------------------
+	uint64_t RandomDelay( CRandom& random )
+	{
+		int iLevel = random.Below(16) == 0 ? 1 + random.Below(TIMER_WHEEL_LEVELS - 1) : 0;
+		uint64_t ulSpan = (uint64_t)1 << (TIMER_WHEEL_BITS * iLevel);
+
+		// The top level only up to a few of its slots, to keep the run short
+		if (iLevel == TIMER_WHEEL_LEVELS - 1)
+			return ulSpan * (1 + random.Below(3)) + random.Below(3) - 1;
+
+		switch (random.Below(4))
+		{
+		case 0:		return ulSpan * LEVEL_SPAN + random.Below(3) - 1;	// Either side of the edge
+		case 1:		return random.Below(3);								// 0 runs next tick
+		default:	return random.Below((uint32_t)(ulSpan * LEVEL_SPAN));
+		}
+	}
+
+	void Set( Model& model, uint64_t ulDelay )
+	{
+		uint64_t uId = model.uNextId++;
+
+		PendingTimer timer;
+		timer.Handle	= model.Wheel.Schedule(ulDelay, OnTimer, &model, uId);
+		timer.ulDue		= model.Wheel.GetTime() + (ulDelay > 0 ? ulDelay : 1);
+
+		model.Pending[uId] = timer;
+		model.Due.insert(std::make_pair(timer.ulDue, uId));
+	}
+
+	void Forget( Model& model, uint64_t uId )
+	{
+		std::map<uint64_t, PendingTimer>::iterator it = model.Pending.find(uId);
+
+		std::multimap<uint64_t, uint64_t>::iterator due = model.Due.lower_bound(it->second.ulDue);
+		while (due->second != uId)
+			++due;
+		model.Due.erase(due);
+
+		model.Stale.push_back(it->second.Handle);
+		model.Pending.erase(it);
+	}
+
+	void CancelOne( Model& model )
+	{
+		if (model.Pending.empty())
+			return;
+
+		// The newest timer, whatever its delay, or the next due, often on the
+		// tick being run. Long timers are mostly left to run out.
+		std::map<uint64_t, PendingTimer>::iterator it = --model.Pending.end();
+		if (model.Random.Below(2))
+			it = model.Pending.find(model.Due.begin()->second);
+
+		uint64_t uId = it->first;
+		TEST_CHECK(model.Wheel.Cancel(it->second.Handle), "cancel timer %llu due %llu at %llu",
+				   (unsigned long long)uId, (unsigned long long)it->second.ulDue, (unsigned long long)model.Wheel.GetTime());
+		Forget(model, uId);
+	}
+
+	//-------------------------------------------------------------------------
+	// A timer runs once, on its due tick, and never after a cancel. Some set
+	// or cancel others.
+	//-------------------------------------------------------------------------
+	void OnTimer( void *pContext, uint64_t uData )
+	{
+		Model& model = *(Model*)pContext;
+		uint64_t ulNow = model.Wheel.GetTime();
+
+		std::map<uint64_t, PendingTimer>::iterator it = model.Pending.find(uData);
+		if (!TEST_CHECK(it != model.Pending.end(), "timer %llu ran at %llu, cancelled or already run",
+						(unsigned long long)uData, (unsigned long long)ulNow))
+			return;
+
+		TEST_CHECK(it->second.ulDue == ulNow, "timer %llu due %llu ran at %llu", (unsigned long long)uData,
+				   (unsigned long long)it->second.ulDue, (unsigned long long)ulNow);
+		TEST_CHECK(ulNow >= model.ulLastFired, "timer %llu ran at %llu after one at %llu", (unsigned long long)uData,
+				   (unsigned long long)ulNow, (unsigned long long)model.ulLastFired);
+		TEST_CHECK(!model.Wheel.IsPending(it->second.Handle), "timer %llu still pending while it runs", (unsigned long long)uData);
+
+		model.ulLastFired = ulNow;
+		model.nFired++;
+		Forget(model, uData);
+
+		if (model.Random.Below(4) == 0)
+			Set(model, RandomDelay(model.Random));
+		if (model.Random.Below(8) == 0)
+			CancelOne(model);
+	}
+
+	//-------------------------------------------------------------------------
+	// Nothing due is left, and the wheel agrees on what is still waiting
+	//-------------------------------------------------------------------------
+	void CheckPending( Model& model )
+	{
+		uint64_t ulNow = model.Wheel.GetTime();
+
+		TEST_CHECK(model.Due.empty() || model.Due.begin()->first > ulNow, "timer due %llu missed at %llu",
+				   (unsigned long long)model.Due.begin()->first, (unsigned long long)ulNow);
+		TEST_CHECK(model.Wheel.GetPendingCount() == model.Pending.size(), "%lu pending, expected %lu at %llu",
+				   (unsigned long)model.Wheel.GetPendingCount(), (unsigned long)model.Pending.size(), (unsigned long long)ulNow);
+
+		std::map<uint64_t, PendingTimer>::iterator it;
+		for (it = model.Pending.begin(); it != model.Pending.end(); ++it)
+			TEST_CHECK(model.Wheel.IsPending(it->second.Handle), "timer %llu not pending at %llu", (unsigned long long)it->first, (unsigned long long)ulNow);
+
+		// Handles outlive their timers harmlessly, even once the slot is reused
+		for (size_t i = 0; i < model.Stale.size(); i++)
+		{
+			TEST_CHECK(!model.Wheel.IsPending(model.Stale[i]) && !model.Wheel.Cancel(model.Stale[i]),
+					   "stale handle %u/%u still live", model.Stale[i].uIndex, model.Stale[i].uGeneration);
+		}
+		model.Stale.clear();
+	}
+
+	//-------------------------------------------------------------------------
+	// Timers past the wheel's reach wait, and cancel and clear like others
+	//-------------------------------------------------------------------------
+	void CountRun( void *pContext, uint64_t uData )
+	{
+		((uint64_t*)pContext)[uData]++;
+	}
+
+	void CheckBeyondReach( )
+	{
+		CTimerWheel wheel;
+		wheel.Clear(12345);
+
+		uint64_t runs[4] = { 0, 0, 0, 0 };
+		TimerHandle far		= wheel.Schedule(WHEEL_SPAN * 4, CountRun, runs, 0);
+		TimerHandle edge	= wheel.Schedule(WHEEL_SPAN, CountRun, runs, 1);
+		TimerHandle past	= wheel.ScheduleAt(5, CountRun, runs, 2);		// Already reached, so the next tick
+		TimerHandle near	= wheel.ScheduleAt(12345 + 3 * LEVEL_SPAN * LEVEL_SPAN, CountRun, runs, 3);
+
+		wheel.Advance(1);
+		TEST_CHECK(runs[2] == 1 && !wheel.IsPending(past), "timer set in the past ran %llu times", (unsigned long long)runs[2]);
+
+		wheel.Advance(4 * LEVEL_SPAN * LEVEL_SPAN * LEVEL_SPAN);
+		TEST_CHECK(runs[3] == 1 && !wheel.IsPending(near), "timer within reach ran %llu times", (unsigned long long)runs[3]);
+		TEST_CHECK(runs[0] == 0 && runs[1] == 0, "timers beyond reach ran early");
+		TEST_CHECK(wheel.IsPending(far) && wheel.IsPending(edge) && wheel.GetPendingCount() == 2, "timers beyond reach lost");
+		TEST_CHECK(wheel.Cancel(far) && !wheel.IsPending(far) && wheel.GetPendingCount() == 1, "cancel beyond reach");
+
+		wheel.Clear();
+		TEST_CHECK(!wheel.IsPending(edge) && wheel.GetPendingCount() == 0 && wheel.GetTime() == 0, "clear");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+//-----------------------------------------------------------------------------
+int main( )
+{
+	Model model;
+	model.Random.Seed(44);
+	model.uNextId		= 0;
+	model.ulLastFired	= 0;
+	model.nFired		= 0;
+
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		for (uint32_t i = model.Random.Below(8); i > 0; i--)
+			Set(model, RandomDelay(model.Random));
+		if (model.Random.Below(3) == 0)
+			CancelOne(model);
+
+		// Mostly a tick or a few, sometimes whole turns of the levels
+		uint64_t ulTicks;
+		switch (model.Random.Below(16))
+		{
+		case 0:		ulTicks = model.Random.Below((uint32_t)(LEVEL_SPAN * LEVEL_SPAN * LEVEL_SPAN)); break;
+		case 1:		ulTicks = 0; break;
+		default:	ulTicks = 1 + model.Random.Below(100); break;
+		}
+
+		model.Wheel.Advance(ulTicks);
+		CheckPending(model);
+	}
+
+	// Everything left runs out, callbacks setting more as they go. A pass
+	// that runs nothing has missed what is left, which CheckPending() says.
+	for (size_t nFired = (size_t)-1; !model.Due.empty() && model.nFired != nFired; )
+	{
+		nFired = model.nFired;
+		model.Wheel.AdvanceTo(model.Due.rbegin()->first);
+		CheckPending(model);
+	}
+
+	TEST_CHECK(model.nFired > (size_t)ROUNDS, "only %lu timers ran", (unsigned long)model.nFired);
+
+	CheckBeyondReach();
+
+	return TEST_RESULT();
+}